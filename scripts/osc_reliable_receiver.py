@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+# Récepteur de référence pour la livraison fiable OSC d'esp32server
+# Usage: python3 scripts/osc_reliable_receiver.py [--port 8000] [--quiet]
+#
+# Activer côté ESP32 : POST /api/osc reliable=true (échéance reliable_ms, 250 par défaut).
+# Chaque événement discret (bouton, note) arrive dans un #bundle immédiat :
+#   /esp32/seq ,ii session seq   puis l'événement lui-même
+# Le récepteur :
+#   - accuse chaque numéro reçu (/esp32/ack ,ii session seq) vers l'adresse source
+#     (port 8001 de l'ESP32), doublons compris : l'accusé précédent a pu se perdre
+#   - signale les trous (/esp32/nack ,i session seq...) pour une retransmission immédiate
+#   - déduplique par (émetteur, session, seq) : les retransmissions ne sont livrées qu'une fois
+# Les valeurs continues (potentiomètres) arrivent sans numéro et sont affichées telles quelles.
+# Dépendances : bibliothèque standard uniquement.
+
+import argparse
+import socket
+import struct
+import time
+
+SEQ_ADDRESS = "/esp32/seq"
+ACK_ADDRESS = "/esp32/ack"
+NACK_ADDRESS = "/esp32/nack"
+MAX_NACK = 16        # Trous signalés par datagramme
+HISTORY = 256        # Numéros mémorisés pour la déduplication
+
+
+def pad(n):
+    return (n + 4) & ~3
+
+
+def read_string(data, pos):
+    end = data.index(b"\0", pos)
+    return data[pos:end].decode("utf-8", "replace"), pos + pad(end - pos)
+
+
+def parse_message(data):
+    address, pos = read_string(data, 0)
+    tags = ""
+    if pos < len(data) and data[pos:pos + 1] == b",":
+        tags, pos = read_string(data, pos)
+        tags = tags[1:]
+    args = []
+    for t in tags:
+        if t == "i":
+            args.append(struct.unpack(">i", data[pos:pos + 4])[0])
+            pos += 4
+        elif t == "f":
+            args.append(struct.unpack(">f", data[pos:pos + 4])[0])
+            pos += 4
+        elif t == "m":
+            args.append(tuple(data[pos:pos + 4]))
+            pos += 4
+        elif t == "s":
+            value, pos = read_string(data, pos)
+            args.append(value)
+        elif t == "T":
+            args.append(True)
+        elif t == "F":
+            args.append(False)
+        else:
+            break  # Type non géré : arguments suivants ignorés
+    return address, args
+
+
+def parse_packet(data):
+    """Liste des messages (adresse, arguments), bundles aplatis dans l'ordre."""
+    if data.startswith(b"#bundle\0"):
+        messages = []
+        pos = 16
+        while pos + 4 <= len(data):
+            size = struct.unpack(">i", data[pos:pos + 4])[0]
+            pos += 4
+            messages.extend(parse_packet(data[pos:pos + size]))
+            pos += size
+        return messages
+    if data[:1] == b"/":
+        return [parse_message(data)]
+    return []
+
+
+def encode_message(address, ints):
+    addr = address.encode()
+    tags = ("," + "i" * len(ints)).encode()
+    out = addr + b"\0" * (pad(len(addr)) - len(addr))
+    out += tags + b"\0" * (pad(len(tags)) - len(tags))
+    for value in ints:
+        out += struct.pack(">I", value & 0xFFFFFFFF)
+    return out
+
+
+class Session:
+    def __init__(self, seq):
+        self.highest = seq - 1  # Arrivée en cours de session : pas de NACK rétroactif
+        self.seen = set()
+
+    def accept(self, seq):
+        """(nouveau, trous à signaler) pour le numéro seq."""
+        if seq in self.seen or seq <= self.highest - HISTORY:
+            return False, []
+        gaps = []
+        if seq > self.highest:
+            gaps = [s for s in range(self.highest + 1, seq) if s not in self.seen][-MAX_NACK:]
+            self.highest = seq
+        self.seen.add(seq)
+        if len(self.seen) > HISTORY:
+            floor = self.highest - HISTORY
+            self.seen = {s for s in self.seen if s > floor}
+        return True, gaps
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Récepteur OSC fiable de référence (esp32server)")
+    parser.add_argument("--port", type=int, default=8000, help="port UDP d'écoute (défaut 8000)")
+    parser.add_argument("--quiet", action="store_true", help="n'afficher que les statistiques")
+    options = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(("", options.port))
+    print(f"📡 Écoute OSC sur UDP {options.port} (Ctrl+C pour quitter)")
+
+    sessions = {}
+    stats = {"events": 0, "duplicates": 0, "nacks": 0, "continuous": 0}
+    last_report = time.monotonic()
+
+    try:
+        while True:
+            sock.settimeout(1.0)
+            try:
+                data, sender = sock.recvfrom(2048)
+            except socket.timeout:
+                data = None
+            if data:
+                messages = parse_packet(data)
+                if messages and messages[0][0] == SEQ_ADDRESS and len(messages[0][1]) >= 2:
+                    session_id = messages[0][1][0] & 0xFFFFFFFF
+                    seq = messages[0][1][1] & 0xFFFFFFFF
+                    key = (sender[0], session_id)
+                    if key not in sessions:
+                        sessions[key] = Session(seq)
+                        print(f"🔗 Session {session_id:08x} depuis {sender[0]}")
+                    fresh, gaps = sessions[key].accept(seq)
+                    sock.sendto(encode_message(ACK_ADDRESS, [session_id, seq]), sender)
+                    if gaps:
+                        sock.sendto(encode_message(NACK_ADDRESS, [session_id] + gaps), sender)
+                        stats["nacks"] += len(gaps)
+                    if fresh:
+                        stats["events"] += 1
+                        if not options.quiet:
+                            for address, args in messages[1:]:
+                                print(f"✅ #{seq} {address} {args}")
+                    else:
+                        stats["duplicates"] += 1
+                else:
+                    stats["continuous"] += len(messages)
+                    if not options.quiet:
+                        for address, args in messages:
+                            print(f"   {address} {args}")
+
+            now = time.monotonic()
+            if now - last_report >= 10.0:
+                last_report = now
+                print(f"📊 événements {stats['events']}, doublons écartés {stats['duplicates']}, "
+                      f"NACK {stats['nacks']}, continus {stats['continuous']}")
+    except KeyboardInterrupt:
+        pass
+    finally:
+        sock.close()
+
+
+if __name__ == "__main__":
+    main()
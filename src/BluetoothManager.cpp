@@ -1,46 +1,66 @@
 #include "BluetoothManager.h"
+#include "midi/MidiEventBus.h"
 
 #ifdef ESP32SERVER_ENABLE_BLE_MIDI
-// UUIDs pour BLE MIDI (plus simples)
-#define SERVICE_UUID        "4fafc201-1fb5-459e-8fcc-c5c9c331914b"
-#define CHARACTERISTIC_UUID "beb5483e-36e1-4688-b7f5-ea07361b26a8"
 
 // Callback pour les événements de connexion BLE
 class MyServerCallbacks: public BLEServerCallbacks {
+public:
+    explicit MyServerCallbacks(BluetoothManager* manager) : manager(manager) {}
+
     void onConnect(BLEServer* pServer) {
         Serial.println("[BLE] Client connecté");
+        manager->connected = true;
+        manager->decoder.reset();
     };
 
     void onDisconnect(BLEServer* pServer) {
         Serial.println("[BLE] Client déconnecté");
+        manager->connected = false;
+        manager->mtu = BLE_MIDI_DEFAULT_MTU;
         // Redémarrer la publicité pour permettre une nouvelle connexion
         pServer->startAdvertising();
     }
+
+    // Notifications jusqu'au MTU négocié (20 octets utiles par défaut)
+    void onMtuChanged(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) {
+        manager->mtu = param->mtu.mtu;
+    }
+
+private:
+    BluetoothManager* manager;
 };
 
-// Callback pour les données reçues
+// Callback pour les données reçues (tâche BLE) : décodage puis publication
+// sur g_midiBus (file MPSC sans verrou), drainée par MidiRouter::update()
 class MyCharacteristicCallbacks: public BLECharacteristicCallbacks {
+public:
+    explicit MyCharacteristicCallbacks(BluetoothManager* manager) : manager(manager) {}
+
     void onWrite(BLECharacteristic *pCharacteristic) {
         std::string value = pCharacteristic->getValue();
-        
-        if (value.length() > 0) {
-            Serial.println("[BLE] Données reçues:");
-            for (int i = 0; i < value.length(); i++) {
-                Serial.printf("%02X ", (uint8_t)value[i]);
-            }
-            Serial.println();
+        if (value.empty()) {
+            return;
         }
+        
+        manager->bytesReceived += value.length();
+        manager->decoder.decode((const uint8_t*)value.data(), value.length(), micros(), MIDI_SOURCE_BLE,
+            [](const MidiEvent& event) { g_midiBus.publish(event); });
     }
+
+private:
+    BluetoothManager* manager;
 };
 
 BluetoothManager::BluetoothManager() 
 #ifdef ESP32SERVER_ENABLE_BLE_MIDI
-    : pServer(nullptr), pCharacteristic(nullptr), deviceName("ESP32-MIDI"), 
-      isStarted(false), connected(false), lastConnectionCheck(0), 
-      bytesSent(0), bytesReceived(0) {
+    : pServer(nullptr), pCharacteristic(nullptr), lock(nullptr), deviceName("ESP32-MIDI"), 
+      isStarted(false), connected(false), lastConnectionCheck(0), lastFlush(0),
+      mtu(BLE_MIDI_DEFAULT_MTU), bytesSent(0), bytesReceived(0), notifications(0), messagesSent(0) {
 #else
     : deviceName("ESP32-MIDI"), isStarted(false), connected(false), 
-      lastConnectionCheck(0), bytesSent(0), bytesReceived(0) {
+      lastConnectionCheck(0), lastFlush(0), mtu(BLE_MIDI_DEFAULT_MTU),
+      bytesSent(0), bytesReceived(0), notifications(0), messagesSent(0) {
 #endif
 }
 
@@ -55,26 +75,36 @@ bool BluetoothManager::begin(const String& name) {
     
     deviceName = name;
     
-    // Initialiser BLE
+    // Créé une fois : jamais détruit, la tâche de la clock peut l'attendre
+    if (!lock) {
+        lock = xSemaphoreCreateMutex();
+        if (!lock) {
+            Serial.println("[BLE] Échec de création du verrou");
+            return false;
+        }
+    }
+    
+    // Initialiser BLE (MTU demandé : un paquet BLE-MIDI complet par notification)
     BLEDevice::init(deviceName.c_str());
+    BLEDevice::setMTU(BLE_MIDI_MAX_PACKET + 3);
     
     // Créer le serveur BLE
     pServer = BLEDevice::createServer();
-    pServer->setCallbacks(new MyServerCallbacks());
+    pServer->setCallbacks(new MyServerCallbacks(this));
     
-    // Créer le service BLE MIDI
-    BLEService *pService = pServer->createService(SERVICE_UUID);
+    // Créer le service BLE MIDI standard
+    BLEService *pService = pServer->createService(BLE_MIDI_SERVICE_UUID);
     
-    // Créer la caractéristique MIDI
+    // Caractéristique MIDI I/O : lecture (vide), écriture sans réponse, notification
     pCharacteristic = pService->createCharacteristic(
-        CHARACTERISTIC_UUID,
+        BLE_MIDI_CHARACTERISTIC_UUID,
         BLECharacteristic::PROPERTY_READ |
-        BLECharacteristic::PROPERTY_WRITE |
+        BLECharacteristic::PROPERTY_WRITE_NR |
         BLECharacteristic::PROPERTY_NOTIFY
     );
     
     // Ajouter les callbacks
-    pCharacteristic->setCallbacks(new MyCharacteristicCallbacks());
+    pCharacteristic->setCallbacks(new MyCharacteristicCallbacks(this));
     
     // Ajouter le descripteur pour les notifications
     pCharacteristic->addDescriptor(new BLE2902());
@@ -82,8 +112,10 @@ bool BluetoothManager::begin(const String& name) {
     // Démarrer le service
     pService->start();
     
-    // Configurer la publicité (approche simplifiée)
+    // Publicité avec l'UUID du service : les hôtes MIDI filtrent les appareils dessus
     BLEAdvertising *pAdvertising = pServer->getAdvertising();
+    pAdvertising->addServiceUUID(BLE_MIDI_SERVICE_UUID);
+    pAdvertising->setScanResponse(true);
     pAdvertising->start();
     
     isStarted = true;
@@ -95,11 +127,14 @@ bool BluetoothManager::begin(const String& name) {
 
 void BluetoothManager::stop() {
     if (isStarted) {
+        xSemaphoreTake(lock, portMAX_DELAY);
         BLEDevice::deinit(true);
         pServer = nullptr;
         pCharacteristic = nullptr;
         isStarted = false;
         connected = false;
+        encoder.reset();
+        xSemaphoreGive(lock);
         Serial.println("[BLE] Arrêté");
     }
 }
@@ -112,52 +147,72 @@ void BluetoothManager::update() {
     // Vérifier la connexion périodiquement
     checkConnection();
     
-    // Traiter les données reçues (optionnel pour le futur)
-    // BLE MIDI reçoit généralement des notifications
+    // Paquet en cours : une notification par intervalle de connexion ;
+    // tenu par la tâche de la clock, on réessaie au cycle suivant
+    if (xSemaphoreTake(lock, 0) != pdTRUE) {
+        return;
+    }
+    if (!encoder.empty() && (uint32_t)(micros() - lastFlush) >= BLE_MIDI_FLUSH_US) {
+        flush();
+    }
+    xSemaphoreGive(lock);
 }
 
 void BluetoothManager::sendNoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
-    if (!connected || !pCharacteristic) {
-        return;
-    }
-    
-    sendMidiMessage(0x90 | (channel - 1), note, velocity);
+    send(MidiEvent::noteOn(channel, note, velocity));
 }
 
 void BluetoothManager::sendNoteOff(uint8_t channel, uint8_t note, uint8_t velocity) {
-    if (!connected || !pCharacteristic) {
-        return;
-    }
-    
-    sendMidiMessage(0x80 | (channel - 1), note, velocity);
+    send(MidiEvent::noteOff(channel, note, velocity));
 }
 
 void BluetoothManager::sendControlChange(uint8_t channel, uint8_t control, uint8_t value) {
-    if (!connected || !pCharacteristic) {
-        return;
-    }
-    
-    sendMidiMessage(0xB0 | (channel - 1), control, value);
+    send(MidiEvent::controlChange(channel, control, value));
 }
 
 void BluetoothManager::sendProgramChange(uint8_t channel, uint8_t program) {
+    send(MidiEvent::programChange(channel, program));
+}
+
+void BluetoothManager::sendPitchBend(uint8_t channel, int bend) {
+    // Signé (-8192 à +8191) vers 14 bits (LSB, MSB) dans MidiEvent
+    send(MidiEvent::pitchBend(channel, bend));
+}
+
+void BluetoothManager::sendAftertouch(uint8_t channel, uint8_t pressure) {
+    send(MidiEvent::aftertouch(channel, pressure));
+}
+
+void BluetoothManager::send(const MidiEvent& event) {
     if (!connected || !pCharacteristic) {
         return;
     }
-    
-    sendMidiMessage(0xC0 | (channel - 1), program, 0);
+    xSemaphoreTake(lock, portMAX_DELAY);
+    add(event);
+    xSemaphoreGive(lock);
 }
 
-void BluetoothManager::sendPitchBend(uint8_t channel, int bend) {
+void BluetoothManager::sendNow(const MidiEvent& event) {
     if (!connected || !pCharacteristic) {
         return;
     }
-    
-    // Convertir de signé (-8192 à +8191) vers non-signé (0-16383)
-    uint16_t bendValue = (uint16_t)(bend + 8192);
-    uint8_t lsb = bendValue & 0x7F;
-    uint8_t msb = (bendValue >> 7) & 0x7F;
-    sendMidiMessage(0xE0 | (channel - 1), lsb, msb);
+    // Le paquet en cours part avec l'événement, sans attendre BLE_MIDI_FLUSH_US
+    xSemaphoreTake(lock, portMAX_DELAY);
+    add(event);
+    flush();
+    xSemaphoreGive(lock);
+}
+
+void BluetoothManager::add(const MidiEvent& event) {
+    // Horodatage BLE-MIDI : millisecondes de l'événement (13 bits)
+    const uint16_t timeMs = (uint16_t)(event.timestamp / 1000);
+    encoder.setCapacity(mtu - 3);
+    if (!encoder.add(event, timeMs)) {
+        // Paquet plein (ou écart d'horodatage trop grand) : notifié tout de suite
+        flush();
+        encoder.add(event, timeMs);
+    }
+    messagesSent++;
 }
 
 bool BluetoothManager::isConnected() const {
@@ -190,23 +245,23 @@ uint32_t BluetoothManager::getBytesReceived() const {
 void BluetoothManager::resetStats() {
     bytesSent = 0;
     bytesReceived = 0;
+    notifications = 0;
+    messagesSent = 0;
+    decoder.resetStats();
 }
 
-void BluetoothManager::sendMidiMessage(uint8_t status, uint8_t data1, uint8_t data2) {
-    if (!connected || !pCharacteristic) {
+void BluetoothManager::flush() {
+    if (encoder.empty()) {
         return;
     }
-    
-    // Format BLE simple : MIDI data direct
-    uint8_t midiData[3];
-    midiData[0] = status;
-    midiData[1] = data1;
-    midiData[2] = data2;
-    
-    pCharacteristic->setValue(midiData, 3);
-    pCharacteristic->notify();
-    
-    bytesSent += 3;
+    if (connected && pCharacteristic) {
+        pCharacteristic->setValue((uint8_t*)encoder.data(), encoder.size());
+        pCharacteristic->notify();
+        bytesSent += encoder.size();
+        notifications++;
+    }
+    encoder.reset();
+    lastFlush = micros();
 }
 
 void BluetoothManager::checkConnection() {
@@ -231,7 +286,8 @@ void BluetoothManager::checkConnection() {
 // Stubs pour quand BLE MIDI n'est pas activé
 BluetoothManager::BluetoothManager() 
     : deviceName("ESP32-MIDI"), isStarted(false), connected(false), 
-      lastConnectionCheck(0), bytesSent(0), bytesReceived(0) {
+      lastConnectionCheck(0), lastFlush(0), mtu(BLE_MIDI_DEFAULT_MTU),
+      bytesSent(0), bytesReceived(0), notifications(0), messagesSent(0) {
 }
 
 BluetoothManager::~BluetoothManager() {
@@ -273,6 +329,22 @@ void BluetoothManager::sendPitchBend(uint8_t channel, int bend) {
     // Rien à faire
 }
 
+void BluetoothManager::sendAftertouch(uint8_t channel, uint8_t pressure) {
+    // Rien à faire
+}
+
+void BluetoothManager::send(const MidiEvent& event) {
+    // Rien à faire
+}
+
+void BluetoothManager::sendNow(const MidiEvent& event) {
+    // Rien à faire
+}
+
+void BluetoothManager::add(const MidiEvent& event) {
+    // Rien à faire
+}
+
 bool BluetoothManager::isConnected() const {
     return false;
 }
@@ -296,9 +368,11 @@ uint32_t BluetoothManager::getBytesReceived() const {
 void BluetoothManager::resetStats() {
     bytesSent = 0;
     bytesReceived = 0;
+    notifications = 0;
+    messagesSent = 0;
 }
 
-void BluetoothManager::sendMidiMessage(uint8_t status, uint8_t data1, uint8_t data2) {
+void BluetoothManager::flush() {
     // Rien à faire
 }
 
@@ -9,6 +9,14 @@
 #include <BLEServer.h>
 #include <BLEUtils.h>
 #include <BLE2902.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+#include "midi/BleMidi.h"
+
+// Regroupement : une notification par intervalle de connexion (7,5 ms minimum en BLE)
+#ifndef BLE_MIDI_FLUSH_US
+#define BLE_MIDI_FLUSH_US 7500
 #endif
 
 /**
@@ -16,17 +24,31 @@
  * 
  * Cette classe gère la communication MIDI via Bluetooth Low Energy (BLE).
  * Compatible avec les appareils iOS/Android et les contrôleurs MIDI BLE.
+ *
+ * Service et caractéristique BLE-MIDI standard ; les messages sont encodés
+ * (BleMidiEncoder : horodatage 13 bits, running status) et regroupés en une
+ * notification par intervalle de connexion, jusqu'au MTU négocié.
+ * sendNow() (tâche de la clock) notifie sans attendre l'intervalle ; le paquet en
+ * cours est protégé par un mutex, update() passe son tour s'il est pris.
  */
 class BluetoothManager {
 private:
 #ifdef ESP32SERVER_ENABLE_BLE_MIDI
     BLEServer* pServer;
     BLECharacteristic* pCharacteristic;
+    SemaphoreHandle_t lock;  // Paquet en cours : loop() et tâche de la clock
 #endif
     String deviceName;
     bool isStarted;
     bool connected;
     uint32_t lastConnectionCheck;
+    BleMidiEncoder encoder;
+    uint32_t lastFlush;      // micros() de la dernière notification
+    uint16_t mtu;            // MTU négocié (BLE_MIDI_DEFAULT_MTU avant négociation)
+    BleMidiDecoder decoder;  // Paquets reçus (tâche BLE) vers g_midiBus
+    
+    friend class MyServerCallbacks;
+    friend class MyCharacteristicCallbacks;
     
 public:
     BluetoothManager();
@@ -43,6 +65,11 @@ public:
     void sendControlChange(uint8_t channel, uint8_t control, uint8_t value);
     void sendProgramChange(uint8_t channel, uint8_t program);
     void sendPitchBend(uint8_t channel, int bend);
+    void sendAftertouch(uint8_t channel, uint8_t pressure);
+    // Événement du bus (horodatage conservé) : chemin utilisé par MidiRouter
+    void send(const MidiEvent& event);
+    // Ajouté puis notifié immédiatement, depuis une autre tâche que loop() (clock)
+    void sendNow(const MidiEvent& event);
     
     // État de connexion
     bool isConnected() const;
@@ -56,15 +83,24 @@ public:
     // Statistiques
     uint32_t getBytesSent() const;
     uint32_t getBytesReceived() const;
+    uint32_t getNotificationCount() const { return notifications; }
+    uint32_t getMessagesSent() const { return messagesSent; }
+    uint16_t getMtu() const { return mtu; }
+    uint32_t getMessagesReceived() const { return decoder.getMessageCount(); }
+    uint32_t getSysExReceived() const { return decoder.getSysExCount(); }
+    uint32_t getMalformedPackets() const { return decoder.getMalformedCount(); }
     void resetStats();
     
 private:
-    void sendMidiMessage(uint8_t status, uint8_t data1, uint8_t data2);
+    void flush(); // Notifie le paquet en cours (verrou tenu)
+    void add(const MidiEvent& event); // Ajoute au paquet en cours (verrou tenu)
     void checkConnection();
     
     // Statistiques
     uint32_t bytesSent;
-    uint32_t bytesReceived;
+    volatile uint32_t bytesReceived; // Incrémenté par la tâche BLE
+    uint32_t notifications;
+    uint32_t messagesSent;
 };
 
 #endif // BLUETOOTHMANAGER_H
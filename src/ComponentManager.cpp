@@ -4,11 +4,15 @@
 #include "ServerCore.h"
 #include "OSCQueue.h"
 #include "midi/MidiMessageType.h"
+#include "midi/MidiEventBus.h"
+#include "midi/MidiClock.h"
 
 extern ServerCore serverCore;
 
 ComponentManager::ComponentManager() 
-    : component_count(0), midi_sender(nullptr) {
+    : component_count(0), midi_sender(nullptr),
+      config_watcher((1 << CONFIG_DOMAIN_PINS) | (1 << CONFIG_DOMAIN_OSC)),
+      osc_namespace_dirty(true) {
     // Initialiser les filtres
     for (int i = 0; i < MAX_COMPONENTS; i++) {
         filters[i].alpha = 0.1f;
@@ -24,29 +28,29 @@ void ComponentManager::begin(MidiSender* sender) {
     midi_sender = sender;
     loadConfigFromNVS();
     
-    // Charger la configuration OSC depuis NVS
-    Preferences prefs;
-    prefs.begin("esp32server", true);
-    String osc_target = prefs.getString("osc_target", "sta");
-    int osc_port = prefs.getInt("osc_port", 8001);
-    String osc_ip = prefs.getString("osc_ip", "255.255.255.255");
-    bool osc_broadcast = prefs.getBool("osc_broadcast", true);
-    prefs.end();
-
-    // Initialiser osc_manager avec la config NVS
-    osc_manager.begin(osc_ip, osc_port, 8001);
-    osc_manager.setBroadcast(osc_broadcast);
-    osc_manager.setInterface(1);
+    // Transport OSC unique : un socket (port 8001) et une table de destinations
+    // partagés par la réception (osc_manager) et la tâche d'envoi (osc_queue)
+    osc_transport.begin(8001);
+    loadOSCConfig();
+    
+    osc_manager.begin(osc_transport);
     osc_manager.setEnabled(true);
+    // Dispatch par adresse (table compilée depuis les adresses des composants)
+    osc_manager.setMessageHandler([](const OSCMessageView& message) {
+        extern ComponentManager g_componentManager;
+        g_componentManager.handleOscMessage(message);
+    });
+    // Retour LED : arguments MIDI OSC ('m') reçus sur le port 8001, routés par MidiRouter ;
+    // les relais déjà traversés ("/midi ,mi") suivent l'événement (limite du pont)
+    osc_manager.setMidiCallback([](const char* address, uint8_t status, uint8_t data1, uint8_t data2, uint8_t hops) {
+        if (status >= 0x80 && status < 0xF0) {
+            g_midiBus.publish(MidiEvent::make(status, data1, data2,
+                                              (uint8_t)(MIDI_SOURCE_OSC | (hops << MIDI_HOPS_SHIFT))));
+        }
+    });
     
-    // Initialiser osc_queue avec la même config
-    osc_queue.begin();
-    osc_queue.setTarget(osc_ip, osc_port);
-    osc_queue.setBroadcast(osc_broadcast);
-    osc_queue.setInterface(1);
-
-    Serial.printf("[ComponentManager] OSC Config: %s:%d (broadcast=%d)\n", 
-                 osc_ip.c_str(), osc_port, osc_broadcast);
+    // File d'envoi sur le même transport (plus de cible dupliquée à synchroniser)
+    osc_queue.begin(osc_transport);
     
     // Configuration OSC optimisée (système direct)
     
@@ -55,17 +59,6 @@ void ComponentManager::begin(MidiSender* sender) {
     printStats();
 }
 
-void ComponentManager::syncOSCConfig() {
-    // Récupérer la config de osc_manager
-    String target = osc_manager.getTargetIP();
-    int port = osc_manager.getTargetPort();
-    bool broadcast = osc_manager.isBroadcastEnabled();
-    
-    // Appliquer à osc_queue
-    osc_queue.setTarget(target, port);
-    osc_queue.setBroadcast(broadcast);
-}
-
 void ComponentManager::update() {
     if (!midi_sender) {
         static unsigned long lastLog = 0;
@@ -103,8 +96,15 @@ void ComponentManager::update() {
     //     lastComponentLog = millis();
     // }
 
-    syncOSCConfig();
-    // Traiter OSC en priorité (avec queue FreeRTOS)
+    // Arbre OSCQuery : reconstruit une seule fois après un changement de configuration
+    if (osc_namespace_dirty) {
+        osc_namespace_dirty = false;
+        publishOscNamespace();
+    }
+    
+    // Réception OSC : tous les datagrammes en attente, dans le budget de temps
+    osc_manager.update();
+    // Envoi OSC : tâche dédiée (update() ne sert qu'en repli sans tâche)
     osc_queue.update();
     
     for (uint8_t i = 0; i < component_count; i++) {
@@ -132,6 +132,57 @@ void ComponentManager::update() {
     }
 }
 
+void ComponentManager::loadOSCConfig() {
+    // Charger la configuration OSC depuis NVS
+    Preferences prefs;
+    prefs.begin("esp32server", true);
+    int osc_port = prefs.getInt("osc_port", 8001);
+    String osc_ip = prefs.getString("osc_ip", "255.255.255.255");
+    bool osc_broadcast = prefs.getBool("osc_broadcast", true);
+    bool osc_bundle = prefs.getBool("osc_bundle", false);
+    int osc_mtu = prefs.getInt("osc_mtu", OSC_MAX_PACKET_SIZE);
+    int osc_drop = prefs.getInt("osc_drop", OSC_DROP_NEWEST);
+    bool osc_coalesce = prefs.getBool("osc_coalesce", false);
+    int osc_budget = prefs.getInt("osc_budget_us", OSCQueue::DEFAULT_DRAIN_BUDGET_US);
+    // Liste de destinations "hôte:port[:float|midi][@débit]" (vide : cible/broadcast ci-dessus)
+    String osc_dests = prefs.getString("osc_dests", "");
+    int osc_baud = prefs.getInt("osc_baud", OSC_SERIAL_BAUD);
+    // Livraison fiable des événements discrets (accusés, retransmission jusqu'à l'échéance)
+    bool osc_reliable = prefs.getBool("osc_reliable", false);
+    int osc_reliable_ms = prefs.getInt("osc_rel_ms", 250);
+    prefs.end();
+    OSCDestinationConfig dests[OSCDestinationTable::MAX_DESTINATIONS];
+    uint8_t dest_count = OSCDestinationTable::parseList(osc_dests.c_str(), dests, OSCDestinationTable::MAX_DESTINATIONS);
+    
+    // Setters idempotents : seuls les changements invalident la table des destinations
+    osc_transport.setTarget(osc_ip.c_str(), osc_port);
+    osc_transport.setBroadcast(osc_broadcast);
+    osc_transport.setInterface(1);
+    osc_transport.setDestinations(dests, dest_count);
+    osc_transport.setSerialBaud(osc_baud);
+    osc_queue.setBundleMaxSize(osc_mtu);
+    osc_queue.setBundleMode(osc_bundle);
+    osc_queue.setDropPolicy((OSCDropPolicy)osc_drop);
+    osc_queue.setCoalescing(osc_coalesce);
+    osc_queue.setDrainBudget(osc_budget);
+    osc_queue.setReliableDeadline(osc_reliable_ms);
+    osc_queue.setReliable(osc_reliable);
+
+    Serial.printf("[ComponentManager] OSC Config: %s:%d (broadcast=%d, bundle=%d, drop=%d, coalesce=%d, reliable=%d, destinations=%d)\n", 
+                 osc_ip.c_str(), osc_port, osc_broadcast, osc_bundle, osc_drop, osc_coalesce, osc_reliable, dest_count);
+}
+
+void ComponentManager::pollConfig() {
+    // Une comparaison d'entier par cycle ; relecture NVS seulement si l'époque a avancé
+    const uint8_t changed = config_watcher.poll();
+    if (changed & (1 << CONFIG_DOMAIN_PINS)) {
+        reloadConfigs();
+    }
+    if (changed & (1 << CONFIG_DOMAIN_OSC)) {
+        loadOSCConfig();
+    }
+}
+
 void ComponentManager::reloadConfigs() {
     // Serial.println("[ComponentManager] Reloading configs...");
     clearAll();
@@ -234,11 +285,12 @@ void ComponentManager::processPotentiometer(uint8_t index) {
         
         // 9. OSC si activé
         if (config.flags & 0x02) {
-            String oscAddress = (config.osc_address[0] != '\0') ? String(config.osc_address) : "/note";
             if (config.flags & 0x04) {
-                osc_queue.enqueueMidi(oscAddress, stable_midi_value, config.midi_param, config.midi_channel);
+                osc_queue.enqueueMidi(osc_templates[index], stable_midi_value, config.midi_param, config.midi_channel, index, true);
+                g_oscQuery.notifyMidi(index, osc_templates[index], stable_midi_value, config.midi_param, config.midi_channel);
             } else {
-                osc_queue.enqueueFloat(oscAddress, stable_midi_value / 127.0f);
+                osc_queue.enqueueFloat(osc_templates[index], stable_midi_value / 127.0f, index, true);
+                g_oscQuery.notifyFloat(index, osc_templates[index], stable_midi_value / 127.0f);
             }
         }
         
@@ -283,13 +335,13 @@ void ComponentManager::processPotentiometer(uint8_t index) {
         
         // Envoyer OSC si activé (via queue prioritaire)
         if (config.flags & 0x02) { // Bit OSC enabled
-            // Utiliser l'adresse OSC configurée (ou défaut si vide)
-            String oscAddress = (config.osc_address[0] != '\0') ? String(config.osc_address) : "/ctl";
-            
+            // En-tête pré-encodé au chargement (adresse configurée ou défaut)
             if (config.flags & 0x04) { // Format MIDI
-                osc_queue.enqueueMidi(oscAddress, midi_value, config.midi_param, config.midi_channel);
+                osc_queue.enqueueMidi(osc_templates[index], midi_value, config.midi_param, config.midi_channel, index, true);
+                g_oscQuery.notifyMidi(index, osc_templates[index], midi_value, config.midi_param, config.midi_channel);
             } else { // Format float
-                osc_queue.enqueueFloat(oscAddress, midi_value / 127.0f);
+                osc_queue.enqueueFloat(osc_templates[index], midi_value / 127.0f, index, true);
+                g_oscQuery.notifyFloat(index, osc_templates[index], midi_value / 127.0f);
             }
         }
         
@@ -355,10 +407,11 @@ void ComponentManager::processButton(uint8_t index) {
                 midi_sender->sendProgramChange(config.midi_channel, config.midi_param);
                 break;
             case MidiMessageType::CLOCK:
-                midi_sender->sendClock();
+                // Active/désactive la clock 24 PPQN (ticks émis par le timer de MidiClock)
+                g_midiClock.toggle();
                 break;
             case MidiMessageType::TAP_TEMPO:
-                midi_sender->sendClock();
+                g_midiClock.tap(millis());
                 break;
             default:
                 midi_sender->sendNoteOn(config.midi_channel, config.midi_param, 127);
@@ -391,11 +444,12 @@ void ComponentManager::processButton(uint8_t index) {
     // Fonction helper pour envoyer OSC
     auto sendOSC = [&](uint8_t value) {
         if (config.flags & 0x02) {
-            String oscAddress = (config.osc_address[0] != '\0') ? String(config.osc_address) : "/note";
             if (config.flags & 0x04) {
-                osc_queue.enqueueMidi(oscAddress, config.midi_param, value, config.midi_channel);
+                osc_queue.enqueueMidi(osc_templates[index], config.midi_param, value, config.midi_channel, index, false);
+                g_oscQuery.notifyMidi(index, osc_templates[index], config.midi_param, value, config.midi_channel);
             } else {
-                osc_queue.enqueueFloat(oscAddress, value / 127.0f);
+                osc_queue.enqueueFloat(osc_templates[index], value / 127.0f, index, false);
+                g_oscQuery.notifyFloat(index, osc_templates[index], value / 127.0f);
             }
         }
     };
@@ -475,6 +529,93 @@ void ComponentManager::processLed(uint8_t index) {
     // Le pilotage se fait via handleMidiNoteOn/Off
 }
 
+void ComponentManager::buildOscTemplate(uint8_t index) {
+    const ComponentConfig& config = configs[index];
+    
+    // Adresse configurée, sinon défaut selon le type (/note pour boutons et balayage)
+    const char* address = config.osc_address;
+    if (address[0] == '\0') {
+        bool isNote = config.type == ComponentType::BUTTON || config.msg_type == MidiMessageType::NOTE_SWEEP;
+        address = isNote ? "/note" : "/ctl";
+    }
+    
+    // Encodage unique de l'adresse et des type tags (float ou MIDI)
+    osc_templates[index].build(address, (config.flags & 0x04) ? 1 : 0);
+}
+
+void ComponentManager::rebuildOscDispatch() {
+    // L'en-tête pré-encodé commence par l'adresse effective, terminée par '\0'
+    osc_dispatch.clear();
+    for (uint8_t i = 0; i < component_count; i++) {
+        if (!osc_dispatch.add((const char*)osc_templates[i].header, i)) {
+            Serial.printf("[ComponentManager] OSC dispatch: adresse ignorée pour GPIO%d\n", configs[i].gpio);
+        }
+    }
+    osc_namespace_dirty = true;
+}
+
+void ComponentManager::publishOscNamespace() {
+    static const char* typeNames[] = {"potentiometer", "button", "led"};
+    OSCQueryEntry entries[MAX_COMPONENTS];
+    char descriptions[MAX_COMPONENTS][24];
+    uint8_t count = 0;
+    
+    // Sorties : composants avec OSC activé ; LEDs : pilotées par l'OSC entrant
+    for (uint8_t i = 0; i < component_count; i++) {
+        const ComponentConfig& config = configs[i];
+        const bool isLed = config.type == ComponentType::LED;
+        if (!isLed && !(config.flags & 0x02)) {
+            continue;
+        }
+        snprintf(descriptions[count], sizeof(descriptions[count]), "GPIO%d %s",
+                 config.gpio, typeNames[(uint8_t)config.type]);
+        entries[count].address = (const char*)osc_templates[i].header;
+        entries[count].description = descriptions[count];
+        entries[count].index = i;
+        entries[count].messageType = osc_templates[i].messageType;
+        entries[count].access = isLed ? OSCQUERY_ACCESS_WRITE : OSCQUERY_ACCESS_READ;
+        count++;
+    }
+    g_oscQuery.publish(entries, count);
+}
+
+void ComponentManager::handleOscMessage(const OSCMessageView& message) {
+    // Accusés de livraison fiable : destinés à la tâche d'envoi, pas aux composants
+    if (osc_queue.handleReliableControl(message)) {
+        return;
+    }
+    
+    uint32_t targets = osc_dispatch.match(message.address());
+    if (targets == 0) {
+        return;
+    }
+    
+    // Première valeur numérique : float 0.0-1.0 (seuil 0.5), sinon entier/booléen non nul
+    OSCArgument arg;
+    OSCMessageView view = message;
+    view.rewind();
+    bool on = false;
+    bool hasValue = false;
+    while (view.next(arg)) {
+        if (arg.isNumber()) {
+            on = (arg.type == 'f' || arg.type == 'd') ? arg.asFloat() >= 0.5f : arg.asInt32() != 0;
+            hasValue = true;
+            break;
+        }
+    }
+    if (!hasValue) {
+        return;
+    }
+    
+    while (targets) {
+        uint8_t i = (uint8_t)__builtin_ctz(targets);
+        targets &= targets - 1;
+        if (i < component_count && configs[i].type == ComponentType::LED) {
+            digitalWrite(configs[i].gpio, on ? HIGH : LOW);
+        }
+    }
+}
+
 bool ComponentManager::addComponent(uint8_t gpio, ComponentType type, uint8_t midi_param, uint8_t channel, MidiMessageType msg_type) {
     if (component_count >= MAX_COMPONENTS) {
         Serial.printf("[ComponentManager] ERROR: Max components reached (%d)\n", MAX_COMPONENTS);
@@ -518,6 +659,8 @@ bool ComponentManager::addComponent(uint8_t gpio, ComponentType type, uint8_t mi
     config.btnMode[sizeof(config.btnMode)-1] = '\0';
     strncpy(config.btnPulseTiming, "release", sizeof(config.btnPulseTiming)); // Défaut: release
     config.btnPulseTiming[sizeof(config.btnPulseTiming)-1] = '\0';
+    // En-tête OSC par défaut (reconstruit si la config NVS change adresse/format)
+    buildOscTemplate(component_count);
     
     // Serial.printf("[ComponentManager] Added component: GPIO%d, type=%d, param=%d, channel=%d, msg_type=%d\n",
     //               gpio, (int)type, midi_param, channel, (int)msg_type);
@@ -553,6 +696,7 @@ bool ComponentManager::addComponent(uint8_t gpio, ComponentType type, uint8_t mi
     }
     
     component_count++;
+    rebuildOscDispatch();
     return true;
 }
 
@@ -571,10 +715,12 @@ bool ComponentManager::removeComponent(uint8_t gpio) {
     for (uint8_t i = index; i < component_count - 1; i++) {
         configs[i] = configs[i + 1];
         states[i] = states[i + 1];
+        osc_templates[i] = osc_templates[i + 1];
         filters[i] = filters[i + 1];
     }
     
     component_count--;
+    rebuildOscDispatch(); // Les index des composants suivants ont changé
     return true;
 }
 
@@ -588,6 +734,7 @@ void ComponentManager::clearAll() {
         }
     }
     component_count = 0;
+    rebuildOscDispatch();
     // Réinitialiser les filtres
     for (uint8_t i = 0; i < MAX_COMPONENTS; i++) {
         filters[i].initialized = false;
@@ -767,6 +914,9 @@ void ComponentManager::loadConfigFromNVS() {
                     }
                 }
                 
+                // Pré-encoder l'en-tête OSC (adresse + format définitifs)
+                buildOscTemplate(index);
+                
                 Serial.printf("[ComponentManager] Final OSC config: %s addr:%s for GPIO%d\n", 
                              oscEnabled ? "enabled" : "disabled", configs[index].osc_address, gpio);
             }
@@ -776,6 +926,8 @@ void ComponentManager::loadConfigFromNVS() {
     }
     
     preferences.end();
+    // Adresses OSC définitives : recompiler la table de dispatch
+    rebuildOscDispatch();
     // Serial.printf("[ComponentManager] Loaded %d components from NVS\n", component_count);
 }
 
@@ -7,6 +7,9 @@
 #include "midi/MidiMessageType.h"
 #include "OSCManager.h"
 #include "OSCQueue.h"
+#include "osc/OSCAddressTrie.h"
+#include "osc/OSCQuery.h"
+#include "ConfigEpoch.h"
 
 // Types de composants supportés
 enum class ComponentType : uint8_t {
@@ -101,10 +104,16 @@ private:
     
     ComponentConfig configs[MAX_COMPONENTS];
     ComponentState states[MAX_COMPONENTS];
+    OSCPacketTemplate osc_templates[MAX_COMPONENTS]; // En-têtes OSC pré-encodés par composant
+    // Dispatch OSC entrant : adresse (ou motif) -> masque des composants
+    OSCAddressTrie<MAX_COMPONENTS * 4, MAX_COMPONENTS * OSC_TEMPLATE_ADDRESS_SIZE> osc_dispatch;
     uint8_t component_count;
     MidiSender* midi_sender;
+    OSCTransport osc_transport; // Socket unique (port 8001) et destinations : doit précéder manager et file
     OSCManager osc_manager;
     OSCQueue osc_queue;
+    ConfigWatcher config_watcher; // Domaines pins + OSC
+    bool osc_namespace_dirty; // Arbre OSCQuery à republier (une fois par rechargement)
     
     // Filtre analogique optimisé (selon ARCHITECTURE_MIDI.md)
     struct AnalogFilter {
@@ -197,7 +206,8 @@ public:
     void begin(MidiSender* sender);
     void update();
     void reloadConfigs();
-    void syncOSCConfig();
+    // Applique les changements publiés (ConfigEpoch) : pins et OSC
+    void pollConfig();
     // Gestion des composants
     bool addComponent(uint8_t gpio, ComponentType type, uint8_t midi_param, uint8_t channel, MidiMessageType msg_type = MidiMessageType::NOTE);
     bool removeComponent(uint8_t gpio);
@@ -208,10 +218,15 @@ public:
     void handleMidiNoteOff(uint8_t channel, uint8_t note, uint8_t velocity);
     void handleMidiControlChange(uint8_t channel, uint8_t control, uint8_t value);
     
+    // Réception OSC : pilote les LEDs dont l'adresse correspond au message
+    void handleOscMessage(const OSCMessageView& message);
+    
     // Getters
     uint8_t getComponentCount() const { return component_count; }
     const ComponentConfig* getConfig(uint8_t index) const;
     const ComponentState* getState(uint8_t index) const;
+    OSCQueue& getOSCQueue() { return osc_queue; }
+    OSCTransport& getOSCTransport() { return osc_transport; }
     
     // Debug
     void printStats();
@@ -220,10 +235,14 @@ private:
     void processPotentiometer(uint8_t index);
     void processButton(uint8_t index);
     void processLed(uint8_t index);
+    void buildOscTemplate(uint8_t index);
+    void rebuildOscDispatch();
+    void publishOscNamespace();
     
     // Utilitaires
     uint8_t findComponentByGpio(uint8_t gpio) const;
     void loadConfigFromNVS();
+    void loadOSCConfig();
     void saveConfigToNVS();
     
     // Parsing JSON optimisé
@@ -0,0 +1,13 @@
+#include "ConfigEpoch.h"
+
+std::atomic<uint32_t> ConfigEpoch::global(0);
+std::atomic<uint32_t> ConfigEpoch::domains[CONFIG_DOMAIN_COUNT] = {};
+
+void ConfigEpoch::publish(ConfigDomain domain) {
+    if (domain >= CONFIG_DOMAIN_COUNT) {
+        return;
+    }
+    // Domaine d'abord : un observateur qui voit la nouvelle époque voit aussi le domaine
+    domains[domain].fetch_add(1, std::memory_order_release);
+    global.fetch_add(1, std::memory_order_release);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * @brief Époque de configuration : propagation des changements sans sondage coûteux
+ *
+ * Les écrivains (handlers web, API, ConfigCache) publient un changement de domaine
+ * après l'écriture NVS ; chaque sous-système garde un ConfigWatcher et ne relit
+ * sa configuration que lorsque l'époque a avancé.
+ *
+ * Coût par cycle côté loop() : une comparaison d'entier (époque globale).
+ */
+enum ConfigDomain : uint8_t {
+    CONFIG_DOMAIN_PINS = 0, // Composants (pins, adresses OSC par pin)
+    CONFIG_DOMAIN_OSC = 1,  // Transport et file OSC (cible, destinations, bundle...)
+    CONFIG_DOMAIN_MIDI = 2, // Routeur MIDI (RTP activé...)
+    CONFIG_DOMAIN_COUNT = 3
+};
+
+class ConfigEpoch {
+public:
+    // Toute tâche : signale que la configuration persistante du domaine a changé
+    static void publish(ConfigDomain domain);
+    
+    static uint32_t current() { return global.load(std::memory_order_acquire); }
+    static uint32_t of(ConfigDomain domain) {
+        return domain < CONFIG_DOMAIN_COUNT ? domains[domain].load(std::memory_order_acquire) : 0;
+    }
+
+private:
+    static std::atomic<uint32_t> global;
+    static std::atomic<uint32_t> domains[CONFIG_DOMAIN_COUNT];
+};
+
+// Observateur d'un ensemble de domaines (bits 1 << ConfigDomain), côté consommateur
+class ConfigWatcher {
+public:
+    explicit ConfigWatcher(uint8_t domainMask) : mask(domainMask), seenEpoch(0) {
+        for (uint8_t d = 0; d < CONFIG_DOMAIN_COUNT; d++) {
+            seen[d] = 0;
+        }
+    }
+    
+    // Domaines modifiés depuis le dernier appel (0 : rien, une seule comparaison)
+    uint8_t poll() {
+        const uint32_t epoch = ConfigEpoch::current();
+        if (epoch == seenEpoch) {
+            return 0;
+        }
+        seenEpoch = epoch;
+        uint8_t changed = 0;
+        for (uint8_t d = 0; d < CONFIG_DOMAIN_COUNT; d++) {
+            if (!(mask & (1 << d))) {
+                continue;
+            }
+            const uint32_t value = ConfigEpoch::of((ConfigDomain)d);
+            if (value != seen[d]) {
+                seen[d] = value;
+                changed |= 1 << d;
+            }
+        }
+        return changed;
+    }
+
+private:
+    uint8_t mask;
+    uint32_t seenEpoch;
+    uint32_t seen[CONFIG_DOMAIN_COUNT];
+};
@@ -4,15 +4,18 @@
 #include "ComponentManager.h"
 #include "PinMapper.h"
 #include "midi/MidiRouter.h"
+#include "midi/MidiClock.h"
+#include "ConfigEpoch.h"
 #include <Preferences.h>
 
 // Variables globales pour la gestion des composants
 MidiRouter g_midiRouter;
 ComponentManager g_componentManager;
 
-// Demande de rechargement des configs pins depuis l'API
-static bool g_requestReloadPins = false;
-extern "C" void esp32server_requestReloadPins(){ g_requestReloadPins = true; }
+// Demandes de rechargement depuis l'API : avancent l'époque du domaine (cf. ConfigEpoch)
+extern "C" void esp32server_requestReloadPins(){ ConfigEpoch::publish(CONFIG_DOMAIN_PINS); }
+extern "C" void esp32server_requestReloadOsc(){ ConfigEpoch::publish(CONFIG_DOMAIN_OSC); }
+extern "C" void esp32server_requestReloadMidi(){ ConfigEpoch::publish(CONFIG_DOMAIN_MIDI); }
 
 // Le mapping GPIO est maintenant géré par PinMapper
 
@@ -110,6 +113,9 @@ void esp32server_begin() {
     // Initialiser Bluetooth MIDI
     serverCore.bluetooth().begin(serverName.c_str());
     
+    // Clock MIDI (timer matériel ; ticks envoyés aux transports par la tâche midi_clock)
+    g_midiClock.begin(&g_midiRouter);
+    
     // Initialiser ComponentManager
     g_componentManager.begin(&g_midiRouter);
     
@@ -127,14 +133,16 @@ void esp32server_loop() {
     // Mise à jour du serveur
     serverCore.update();
     
-    // Recharger pins si demandé
-    if (g_requestReloadPins) {
-        g_requestReloadPins = false;
-        g_componentManager.reloadConfigs();
-    }
+    // Configuration modifiée (API web) : une comparaison d'époque par sous-système
+    g_midiRouter.pollConfig();
+    g_componentManager.pollConfig();
     
     // Traitement des composants
     processComponents();
+    
+    // Événements MIDI du cycle (composants, RTP-MIDI, OSC, BLE) : routés en un lot ;
+    // les ticks de clock n'y passent pas (MidiRouter::sendRealtimeNow(), tâche midi_clock)
+    g_midiRouter.update();
 }
 
 // Instance globale
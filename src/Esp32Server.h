@@ -37,4 +37,11 @@ extern Esp32Server esp32server;
 // Fonction legacy (optionnelle): init unique
 void esp32server_begin();
 
+// Rechargement de configuration après écriture NVS (appelable depuis toute tâche)
+extern "C" {
+    void esp32server_requestReloadPins();
+    void esp32server_requestReloadOsc();
+    void esp32server_requestReloadMidi();
+}
+
 #endif // ESP32SERVER_H
\ No newline at end of file
@@ -5,67 +5,52 @@
 #include <WiFi.h>
 
 OSCManager::OSCManager() : 
-    targetIP(""),
-    targetPort(8000),
-    localPort(4000),
+    transport(nullptr),
     initialized(false),
     enabled(false),
-    broadcastEnabled(false),
-    broadcastIP(""),
-    networkInterface(OSC_INTERFACE_AP),
-    messageCallback(nullptr) {
+    messageCallback(nullptr),
+    midiCallback(nullptr),
+    messageHandler(nullptr),
+    rxBudgetUs(OSC_RX_BUDGET_US),
+    scheduledCount(0),
+    rxPackets(0),
+    rxMessages(0),
+    rxErrors(0),
+    rxScheduled(0) {
+    for (uint8_t i = 0; i < SCHEDULE_SLOTS; i++) {
+        scheduled[i].length = 0;
+    }
 }
 
 OSCManager::~OSCManager() {
     end();
 }
 
-bool OSCManager::begin(const String& target_ip, uint16_t target_port, uint16_t local_port) {
+bool OSCManager::begin(OSCTransport& shared) {
     if (initialized) {
         end();
     }
 
-    targetIP = target_ip;
-    targetPort = target_port;
-    localPort = local_port;
-
-    // Démarrer UDP pour l'envoi
-    if (!udp.begin(localPort)) {
-        debug_network( "[OSC] Erreur: Impossible de démarrer UDP\n");
+    // Socket et destinations partagés avec OSCQueue (démarré par le propriétaire)
+    if (!shared.isInitialized()) {
+        debug_network( "[OSC] Erreur: transport OSC non démarré\n");
         return false;
     }
+    transport = &shared;
 
     initialized = true;
     enabled = true;
 
-    // Calculer l'adresse broadcast selon le réseau actuel
-    if (WiFi.status() == WL_CONNECTED) {
-        // Mode STA : broadcast du réseau WiFi
-        IPAddress ip = WiFi.localIP();
-        IPAddress subnet = WiFi.subnetMask();
-        IPAddress broadcast = IPAddress(ip[0] | (~subnet[0]), 
-                                       ip[1] | (~subnet[1]), 
-                                       ip[2] | (~subnet[2]), 
-                                       ip[3] | (~subnet[3]));
-        broadcastIP = broadcast.toString();
-    } else {
-        // Mode AP : broadcast du réseau AP (192.168.4.255)
-        broadcastIP = "192.168.4.255";
-    }
-
     debug_network( "[OSC] Démarré - Local:%d -> %s:%d\n", 
-                  localPort, targetIP.c_str(), targetPort);
-    debug_network( "[OSC] Broadcast disponible: %s:%d\n", 
-                  broadcastIP.c_str(), targetPort);
-    debug_network( "[OSC] Interface réseau: %d (0=AP, 1=STA, 2=BOTH)\n", networkInterface);
-    debug_network( "[OSC] Broadcast activé: %s\n", broadcastEnabled ? "OUI" : "NON\n");
+                  transport->getLocalPort(), transport->getTargetIP(), transport->getTargetPort());
+    debug_network( "[OSC] Interface réseau: %d (0=AP, 1=STA, 2=BOTH)\n", transport->getInterface());
+    debug_network( "[OSC] Broadcast activé: %s\n", transport->isBroadcastEnabled() ? "OUI" : "NON\n");
     
     return true;
 }
 
 void OSCManager::end() {
     if (initialized) {
-        udp.stop();
         initialized = false;
         enabled = false;
         debug_network( "[OSC] Arrêté\n");
@@ -82,14 +67,16 @@ bool OSCManager::isEnabled() const {
 }
 
 bool OSCManager::sendFloat(const String& address, float value) {
-    OSCMessage msg(address.c_str());
-    msg.add(value);
+    OSCWriter writer(txBuffer, sizeof(txBuffer));
+    writer.address(address.c_str());
+    writer.typeTags(",f");
+    writer.float32(value);
     
     #ifdef ESP32SERVER_debug_osc
     debug_network( "[OSC] Préparation %s %.3f\n", address.c_str(), value);
     #endif
     
-    return sendOSCMessage(msg);
+    return writer.ok() && sendPacket(writer.data(), writer.length(), OSC_FORMAT_FLOAT);
 }
 
 bool OSCManager::sendInt(const String& address, int value) {
@@ -97,10 +84,12 @@ bool OSCManager::sendInt(const String& address, int value) {
         return false;
     }
 
-    OSCMessage msg(address.c_str());
-    msg.add((int32_t)value);
+    OSCWriter writer(txBuffer, sizeof(txBuffer));
+    writer.address(address.c_str());
+    writer.typeTags(",i");
+    writer.int32(value);
 
-    return sendOSCMessage(msg);
+    return writer.ok() && sendPacket(writer.data(), writer.length(), OSC_FORMAT_FLOAT);
 }
 
 bool OSCManager::sendNote(const String& address, uint8_t note, uint8_t velocity) {
@@ -108,11 +97,13 @@ bool OSCManager::sendNote(const String& address, uint8_t note, uint8_t velocity)
         return false;
     }
 
-    OSCMessage msg(address.c_str());
-    msg.add((int32_t)note);
-    msg.add((int32_t)velocity);
+    OSCWriter writer(txBuffer, sizeof(txBuffer));
+    writer.address(address.c_str());
+    writer.typeTags(",ii");
+    writer.int32(note);
+    writer.int32(velocity);
 
-    return sendOSCMessage(msg);
+    return writer.ok() && sendPacket(writer.data(), writer.length(), OSC_FORMAT_MIDI);
 }
 
 bool OSCManager::sendMidiMessage(const String& address, uint8_t data1, uint8_t data2, uint8_t channel) {
@@ -120,12 +111,14 @@ bool OSCManager::sendMidiMessage(const String& address, uint8_t data1, uint8_t d
         return false;
     }
 
-    OSCMessage msg(address.c_str());
-    msg.add((int32_t)data1);    // Note/Control
-    msg.add((int32_t)data2);    // Velocity/Value  
-    msg.add((int32_t)channel);  // Canal MIDI
+    OSCWriter writer(txBuffer, sizeof(txBuffer));
+    writer.address(address.c_str());
+    writer.typeTags(",iii");
+    writer.int32(data1);    // Note/Control
+    writer.int32(data2);    // Velocity/Value  
+    writer.int32(channel);  // Canal MIDI
 
-    return sendOSCMessage(msg);
+    return writer.ok() && sendPacket(writer.data(), writer.length(), OSC_FORMAT_MIDI);
 }
 
 bool OSCManager::sendMultiFloat(const String& address, float* values, int count) {
@@ -133,28 +126,41 @@ bool OSCManager::sendMultiFloat(const String& address, float* values, int count)
         return false;
     }
 
-    OSCMessage msg(address.c_str());
+    // Type tags ",fff..." construits directement dans le buffer (pas de String)
+    char tags[64];
+    if (count > (int)sizeof(tags) - 2) {
+        return false;
+    }
+    tags[0] = ',';
+    memset(tags + 1, 'f', count);
+    tags[count + 1] = '\0';
+
+    OSCWriter writer(txBuffer, sizeof(txBuffer));
+    writer.address(address.c_str());
+    writer.typeTags(tags);
     for (int i = 0; i < count; i++) {
-        msg.add(values[i]);
+        writer.float32(values[i]);
     }
 
-    return sendOSCMessage(msg);
+    return writer.ok() && sendPacket(writer.data(), writer.length(), OSC_FORMAT_FLOAT);
 }
 
 void OSCManager::setTarget(const String& target_ip, uint16_t target_port) {
-    targetIP = target_ip;
-    targetPort = target_port;
+    if (!transport) {
+        return;
+    }
+    transport->setTarget(target_ip.c_str(), target_port);
     
     debug_network( "[OSC] Nouvelle destination: %s:%d\n", 
-                  targetIP.c_str(), targetPort);
+                  target_ip.c_str(), target_port);
 }
 
 String OSCManager::getTargetIP() const {
-    return targetIP;
+    return transport ? String(transport->getTargetIP()) : String();
 }
 
 uint16_t OSCManager::getTargetPort() const {
-    return targetPort;
+    return transport ? transport->getTargetPort() : 0;
 }
 
 bool OSCManager::isInitialized() const {
@@ -162,150 +168,207 @@ bool OSCManager::isInitialized() const {
 }
 
 void OSCManager::setBroadcast(bool enable) {
-    broadcastEnabled = enable;
-    debug_network( "[OSC] Broadcast %s\n", enable ? "activé" : "désactivé\n");
-    if (enable && !broadcastIP.isEmpty()) {
-        debug_network( "[OSC] Broadcast vers: %s:%d\n", broadcastIP.c_str(), targetPort);
+    if (!transport) {
+        return;
     }
+    transport->setBroadcast(enable);
+    debug_network( "[OSC] Broadcast %s\n", enable ? "activé" : "désactivé\n");
 }
 
 void OSCManager::setInterface(uint8_t interface) {
-    networkInterface = interface;
+    if (!transport) {
+        return;
+    }
+    transport->setInterface(interface);
     const char* interfaceNames[] = {"AP", "STA", "BOTH"};
     debug_network( "[OSC] Interface réseau configurée: %s\n", 
                  interface < 3 ? interfaceNames[interface] : "INVALID\n");
 }
 
+void OSCManager::setDestinations(const OSCDestinationConfig* list, uint8_t count) {
+    if (!transport) {
+        return;
+    }
+    transport->setDestinations(list, count);
+    debug_network( "[OSC] %d destination(s) configurée(s)\n", count);
+}
+
 uint8_t OSCManager::getInterface() const {
-    return networkInterface;
+    return transport ? transport->getInterface() : OSC_INTERFACE_AP;
 }
 
 bool OSCManager::isBroadcastEnabled() const {
-    return broadcastEnabled;
+    return transport && transport->isBroadcastEnabled();
 }
 
-bool OSCManager::sendOSCMessage(OSCMessage& msg) {
+bool OSCManager::sendPacket(const uint8_t* data, size_t length, uint8_t format) {
     if (!isEnabled()) {
         debug_network( "[OSC] OSC désactivé\n");
         return false;
     }
 
-    bool success = false;
-    int retryCount = 0;
+    // Chaque destination (broadcast AP/STA, unicast, multicast) reçoit le datagramme,
+    // via le socket partagé ; depuis loop() on retente sans céder le cœur et sans
+    // attendre le socket s'il est tenu par la tâche d'envoi (OSC_SEND_BUSY)
     const int maxRetries = 2;
-    
-    // Mode broadcast OU IP spécifique selon l'interface configurée
-    if (broadcastEnabled) {
-        // Mode broadcast selon l'interface réseau
-        if (networkInterface == OSC_INTERFACE_AP || networkInterface == OSC_INTERFACE_BOTH) {
-            // Broadcast sur AP (192.168.4.255)
-            while (retryCount <= maxRetries && !success) {
-                if (udp.beginPacket("192.168.4.255", targetPort)) {
-                    msg.send(udp);
-                    if (udp.endPacket()) {
-                        success = true;
-                        debug_network( "[OSC] Broadcast AP réussi (tentative %d)\n", retryCount + 1);
-                    } else {
-                        debug_network( "[OSC] Échec endPacket AP (tentative %d)\n", retryCount + 1);
-                    }
-                } else {
-                    debug_network( "[OSC] Échec beginPacket AP (tentative %d)\n", retryCount + 1);
-                }
-                retryCount++;
-            }
-        }
-        
-        if ((networkInterface == OSC_INTERFACE_STA || networkInterface == OSC_INTERFACE_BOTH) && 
-            WiFi.status() == WL_CONNECTED) {
-            // Broadcast sur STA (calculé selon le réseau)
-            IPAddress ip = WiFi.localIP();
-            IPAddress subnet = WiFi.subnetMask();
-            IPAddress broadcast = IPAddress(ip[0] | (~subnet[0]), 
-                                           ip[1] | (~subnet[1]), 
-                                           ip[2] | (~subnet[2]), 
-                                           ip[3] | (~subnet[3]));
-            
-            retryCount = 0;
-            while (retryCount <= maxRetries && !success) {
-                if (udp.beginPacket(broadcast, targetPort)) {
-                    msg.send(udp);
-                    if (udp.endPacket()) {
-                        success = true;
-                        debug_network( "[OSC] Broadcast STA réussi (tentative %d)\n", retryCount + 1);
-                    } else {
-                        debug_network( "[OSC] Échec endPacket STA (tentative %d)\n", retryCount + 1);
-                    }
-                } else {
-                    debug_network( "[OSC] Échec beginPacket STA (tentative %d)\n", retryCount + 1);
-                }
-                retryCount++;
-            }
+    const OSCSendResult result = transport->send(data, length, format, 1, maxRetries, false);
+    if (result != OSC_SEND_OK) {
+        debug_network( "[OSC] Échec d'envoi (%d) après %d tentatives\n", result, maxRetries + 1);
+    }
+    return result == OSC_SEND_OK;
+}
+
+void OSCManager::update() {
+    if (!isEnabled() || !initialized) {
+        return;
+    }
+
+    // Éléments de bundle arrivés à échéance
+    runScheduled();
+
+    // Vider tous les datagrammes en attente (lwIP), dans la limite du budget de temps
+    const uint32_t start = micros();
+    size_t len;
+    while (transport->receive(rxBuffer, sizeof(rxBuffer), len) > 0) {
+        rxPackets++;
+        if (len == 0) {
+            // Trop grand pour un datagramme OSC valide : ignoré
+            rxErrors++;
+        } else {
+            // Décodage en place : adresse et arguments restent dans rxBuffer
+            handlePacket(rxBuffer, len);
         }
-    } else {
-        // Mode IP spécifique
-        if (!targetIP.isEmpty()) {
-            while (retryCount <= maxRetries && !success) {
-                if (udp.beginPacket(targetIP.c_str(), targetPort)) {
-                    msg.send(udp);
-                    if (udp.endPacket()) {
-                        success = true;
-                        debug_network( "[OSC] Unicast réussi (tentative %d)\n", retryCount + 1);
-                    } else {
-                        debug_network( "[OSC] Échec endPacket unicast (tentative %d)\n", retryCount + 1);
-                    }
-                } else {
-                    debug_network( "[OSC] Échec beginPacket unicast (tentative %d)\n", retryCount + 1);
-                }
-                retryCount++;
-            }
+        if ((uint32_t)(micros() - start) >= rxBudgetUs) {
+            break; // Le reste attend le prochain cycle
         }
     }
-    
-    if (!success) {
-        debug_network( "[OSC] Échec définitif après %d tentatives\n", maxRetries + 1);
+}
+
+void OSCManager::handlePacket(const uint8_t* data, size_t length, uint8_t depth) {
+    if (!OSCBundleView::isBundle(data, length)) {
+        dispatchMessage(data, length);
+        return;
+    }
+
+    OSCBundleView bundle;
+    if (!bundle.parse(data, length) || depth >= MAX_BUNDLE_DEPTH) {
+        rxErrors++;
+        return;
+    }
+
+    // Timetag relatif à l'horloge locale (immédiat si non synchronisée)
+    const int64_t delay = oscTimetagDelayUs(bundle.timetag());
+    const uint8_t* element;
+    size_t elementLength;
+    while (bundle.next(element, elementLength)) {
+        if (OSCBundleView::isBundle(element, elementLength)) {
+            handlePacket(element, elementLength, depth + 1);
+        } else if (delay > 0 && delay <= SCHEDULE_MAX_DELAY_US &&
+                   schedule(element, elementLength, (uint32_t)delay)) {
+            rxScheduled++;
+        } else {
+            dispatchMessage(element, elementLength);
+        }
     }
-    
-    return success;
 }
 
-void OSCManager::update() {
-    if (!isEnabled() || !initialized) {
+void OSCManager::dispatchMessage(const uint8_t* data, size_t length) {
+    OSCMessageView msg;
+    if (!msg.parse(data, length)) {
+        rxErrors++;
         return;
     }
+    rxMessages++;
 
-    // Vérifier s'il y a des paquets entrants
-    int packetSize = udp.parsePacket();
-    if (packetSize > 0) {
-        // Lire le paquet entrant
-        uint8_t buffer[256];
-        int len = udp.read(buffer, sizeof(buffer) - 1);
-        if (len > 0) {
-            buffer[len] = 0; // Null terminate
-            
-            // Parser le message OSC
-            OSCMessage msg;
-            msg.fill(buffer, len);
-            
-            if (!msg.hasError()) {
-                // Extraire l'adresse
-                char addressBuffer[64];
-                msg.getAddress(addressBuffer, sizeof(addressBuffer));
-                String address = String(addressBuffer);
-                
-                // Extraire la première valeur float (si disponible)
-                if (msg.size() > 0 && msg.isFloat(0)) {
-                    float value = msg.getFloat(0);
-                    
-                    // Appeler le callback si défini
-                    if (messageCallback) {
-                        messageCallback(address, value);
-                    }
-                }
+    if (messageHandler) {
+        messageHandler(msg);
+        msg.rewind();
+    }
+
+    // "/midi ,mi" : l'entier est le nombre de relais, pas une valeur de composant
+    const bool relayed = strcmp(msg.typeTags(), "mi") == 0 && strcmp(msg.address(), OSC_MIDI_ADDRESS) == 0;
+    OSCArgument arg;
+    bool valueSent = false;
+    while (msg.next(arg)) {
+        if (arg.type == 'm') {
+            uint8_t status, data1, data2;
+            uint8_t hops = 0;
+            OSCArgument hopsArg;
+            if (relayed && msg.next(hopsArg)) {
+                const int32_t value = hopsArg.asInt32();
+                hops = value <= 0 ? 0 : (value >= 15 ? 15 : (uint8_t)value);
+            }
+            if (midiCallback && arg.asMidi(status, data1, data2)) {
+                midiCallback(msg.address(), status, data1, data2, hops);
+            }
+        } else if (!valueSent && arg.isNumber()) {
+            // Première valeur numérique (int ou float) -> callback historique
+            valueSent = true;
+            if (messageCallback) {
+                messageCallback(String(msg.address()), arg.asFloat());
             }
         }
     }
 }
 
+bool OSCManager::schedule(const uint8_t* data, size_t length, uint32_t delayUs) {
+    if (length > SCHEDULE_SLOT_SIZE || scheduledCount >= SCHEDULE_SLOTS) {
+        return false; // Pas de place : exécuté immédiatement par l'appelant
+    }
+    for (uint8_t i = 0; i < SCHEDULE_SLOTS; i++) {
+        if (scheduled[i].length == 0) {
+            memcpy(scheduled[i].data, data, length);
+            scheduled[i].length = (uint16_t)length;
+            scheduled[i].due = micros() + delayUs;
+            scheduledCount++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void OSCManager::runScheduled() {
+    if (scheduledCount == 0) {
+        return;
+    }
+    const uint32_t now = micros();
+    for (uint8_t i = 0; i < SCHEDULE_SLOTS; i++) {
+        if (scheduled[i].length != 0 && (int32_t)(now - scheduled[i].due) >= 0) {
+            dispatchMessage(scheduled[i].data, scheduled[i].length);
+            scheduled[i].length = 0;
+            scheduledCount--;
+        }
+    }
+}
+
+void OSCManager::setMidiCallback(OSCMidiCallback callback) {
+    midiCallback = callback;
+}
+
+void OSCManager::setMessageHandler(OSCMessageHandler handler) {
+    messageHandler = handler;
+}
+
+void OSCManager::setReceiveBudget(uint32_t microseconds) {
+    rxBudgetUs = microseconds > 0 ? microseconds : OSC_RX_BUDGET_US;
+}
+
+uint32_t OSCManager::getReceivedPackets() const {
+    return rxPackets;
+}
+
+uint32_t OSCManager::getReceivedMessages() const {
+    return rxMessages;
+}
+
+uint32_t OSCManager::getReceiveErrors() const {
+    return rxErrors;
+}
+
+uint32_t OSCManager::getScheduledMessages() const {
+    return rxScheduled;
+}
+
 void OSCManager::setMessageCallback(OSCMessageCallback callback) {
     messageCallback = callback;
     #ifdef ESP32SERVER_debug_osc
@@ -317,9 +380,14 @@ void OSCManager::printStatus() const {
     debug_network( "=== OSC Manager Status ===\n");
     debug_network( "Initialisé: %s\n", initialized ? "Oui" : "Non\n");
     debug_network( "Activé: %s\n", enabled ? "Oui" : "Non\n");
-    debug_network( "Destination: %s:%d\n", targetIP.c_str(), targetPort);
-    debug_network( "Broadcast: %s\n", broadcastEnabled ? "Oui" : "Non\n");
+    if (transport) {
+        debug_network( "Destination: %s:%d\n", transport->getTargetIP(), transport->getTargetPort());
+        debug_network( "Broadcast: %s\n", transport->isBroadcastEnabled() ? "Oui" : "Non\n");
+    }
     debug_network( "Callback: %s\n", messageCallback ? "Défini" : "Non défini\n");
+    debug_network( "Reçus: %lu paquets, %lu messages, %lu erreurs, %lu planifiés\n",
+                  (unsigned long)rxPackets, (unsigned long)rxMessages,
+                  (unsigned long)rxErrors, (unsigned long)rxScheduled);
     debug_network( "=========================\n");
 }
 
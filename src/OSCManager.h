@@ -2,8 +2,8 @@
 #define OSCMANAGER_H
 
 #include <Arduino.h>
-#include <WiFiUdp.h>
-#include <OSCMessage.h>
+#include "osc/OSCCodec.h"
+#include "osc/OSCTransport.h"
 
 // Interfaces réseau pour l'envoi OSC
 enum OSCInterface : uint8_t {
@@ -13,13 +13,27 @@ enum OSCInterface : uint8_t {
 };
 
 typedef void (*OSCMessageCallback)(const String& address, float value);
+// Message MIDI du pont : "/midi ,m" ; "/midi ,mi" quand il a déjà été relayé (entier = relais traversés)
+static constexpr const char* OSC_MIDI_ADDRESS = "/midi";
+
+// Argument MIDI OSC ('m') : adresse pointant dans le buffer de réception (valide pendant l'appel) ;
+// hops : relais déjà traversés ("/midi ,mi"), 0 sinon
+typedef void (*OSCMidiCallback)(const char* address, uint8_t status, uint8_t data1, uint8_t data2, uint8_t hops);
+// Message décodé en place (adresse/arguments valides pendant l'appel), pour un dispatch par adresse
+typedef void (*OSCMessageHandler)(const OSCMessageView& message);
+
+// Budget de temps par défaut pour vider la réception à chaque update()
+#ifndef OSC_RX_BUDGET_US
+#define OSC_RX_BUDGET_US 2000
+#endif
 
 class OSCManager {
 public:
     OSCManager();
     ~OSCManager();
 
-    bool begin(const String& target_ip, uint16_t target_port, uint16_t local_port);
+    // Réception et envois directs sur le transport partagé (socket + destinations)
+    bool begin(OSCTransport& transport);
     void end();
 
     void setEnabled(bool enable);
@@ -33,7 +47,7 @@ public:
     bool sendMidiMessage(const String& address, uint8_t data1, uint8_t data2, uint8_t channel);
     bool sendMultiFloat(const String& address, float* values, int count);
 
-    // Cible unicast
+    // Cible unicast (déléguée au transport, partagée avec OSCQueue)
     void setTarget(const String& target_ip, uint16_t target_port);
     String getTargetIP() const;
     uint16_t getTargetPort() const;
@@ -44,28 +58,61 @@ public:
     void setInterface(uint8_t interface);
     uint8_t getInterface() const;
 
-    // Réception
-    void setMessageCallback(OSCMessageCallback callback);
+    // Liste de destinations (count = 0 : cible/broadcast ci-dessus)
+    void setDestinations(const OSCDestinationConfig* list, uint8_t count);
+
+    // Réception : update() vide tous les datagrammes en attente dans le budget de temps
+    void setMessageCallback(OSCMessageCallback callback); // Premier argument i/f/h/d/T/F
+    void setMidiCallback(OSCMidiCallback callback);       // Chaque argument 'm'
+    void setMessageHandler(OSCMessageHandler handler);    // Chaque message, avant les callbacks
+    void setReceiveBudget(uint32_t microseconds);
     void update();
+    uint32_t getReceivedPackets() const;
+    uint32_t getReceivedMessages() const;
+    uint32_t getReceiveErrors() const;    // Datagrammes malformés ou trop grands
+    uint32_t getScheduledMessages() const; // Éléments de bundle planifiés selon leur timetag
     void printStatus() const;
     void disconnect();
 
 private:
-    bool sendOSCMessage(OSCMessage& msg);
+    bool sendPacket(const uint8_t* data, size_t length, uint8_t format); // OSCDestinationFormat
+    void handlePacket(const uint8_t* data, size_t length, uint8_t depth = 0);
+    void dispatchMessage(const uint8_t* data, size_t length);
+    bool schedule(const uint8_t* data, size_t length, uint32_t delayUs);
+    void runScheduled();
 
 private:
-    WiFiUDP udp;
-    String targetIP;
-    uint16_t targetPort;
-    uint16_t localPort;
+    OSCTransport* transport; // Socket et destinations partagés
     bool initialized;
     bool enabled;
 
-    // Broadcast
-    bool broadcastEnabled;
-    String broadcastIP; // calculée au démarrage selon AP/STA
-    uint8_t networkInterface; // OSCInterface
     OSCMessageCallback messageCallback;
+    OSCMidiCallback midiCallback;
+    OSCMessageHandler messageHandler;
+    uint32_t rxBudgetUs;
+
+    // Buffers d'encodage/décodage réutilisés (aucune allocation par message)
+    uint8_t txBuffer[OSC_MAX_PACKET_SIZE];
+    uint8_t rxBuffer[OSC_MAX_PACKET_SIZE];
+    
+    // Éléments de bundle datés dans le futur : copiés jusqu'à leur échéance
+    static const uint8_t SCHEDULE_SLOTS = 8;
+    static const uint16_t SCHEDULE_SLOT_SIZE = 128;
+    static const uint32_t SCHEDULE_MAX_DELAY_US = 10000000; // Au-delà : exécuté immédiatement
+    static const uint8_t MAX_BUNDLE_DEPTH = 4;
+    struct ScheduledMessage {
+        uint32_t due;    // micros() d'échéance
+        uint16_t length; // 0 = case libre
+        uint8_t data[SCHEDULE_SLOT_SIZE];
+    };
+    ScheduledMessage scheduled[SCHEDULE_SLOTS];
+    uint8_t scheduledCount;
+    
+    // Statistiques de réception
+    uint32_t rxPackets;
+    uint32_t rxMessages;
+    uint32_t rxErrors;
+    uint32_t rxScheduled;
 };
 
 #endif // OSCMANAGER_H
@@ -1,156 +1,678 @@
 #include "OSCQueue.h"
-#include <WiFi.h>
 
-OSCQueue::OSCQueue() 
-    : messageQueue(nullptr), targetPort(8000), initialized(false), 
-      broadcastEnabled(false), networkInterface(0), sentCount(0), failedCount(0) {
+OSCQueue::OSCQueue()
+    : transport(nullptr), initialized(false), bundleEnabled(false),
+      bundleMaxSize(OSC_MAX_PACKET_SIZE), dropPolicy(OSC_DROP_NEWEST),
+      coalescingEnabled(false),
+      carryValid(false), latestMask(0), latestTaken(false),
+      lastTransports(0), lastFailure(OSC_REASON_SEND_ERROR),
+      currentLane(OSC_LANE_DISCRETE), laneBurst(0),
+      drainBudgetUs(DEFAULT_DRAIN_BUDGET_US), sendCostUs(DEFAULT_SEND_COST_US),
+      reliableEnabled(false), reliableDeadlineUs(250000), reliablePending(0),
+      txTask(nullptr), txRunning(false), txActive(false), statsResetPending(false),
+      sentCount(0), failedCount(0), truncatedCount(0),
+      bundleCount(0) {
+    laneWeights[OSC_LANE_DISCRETE] = DEFAULT_DISCRETE_WEIGHT;
+    laneWeights[OSC_LANE_CONTINUOUS] = DEFAULT_CONTINUOUS_WEIGHT;
+    resetStats();
 }
 
 OSCQueue::~OSCQueue() {
     end();
 }
 
-bool OSCQueue::begin() {
+bool OSCQueue::begin(OSCTransport& shared) {
     if (initialized) {
         return true;
     }
-    
-    // Créer la queue FreeRTOS
-    messageQueue = xQueueCreate(QUEUE_SIZE, sizeof(OSCMessageItem));
-    if (!messageQueue) {
-        Serial.println("[OSCQueue] Erreur: Impossible de créer la queue");
+    if (!shared.isInitialized()) {
+        Serial.println("[OSCQueue] Erreur: transport OSC non démarré");
         return false;
     }
-    
-    // Configuration UDP optimisée pour la fiabilité
-    udp.setTimeout(1000); // Timeout 1s pour éviter les blocages
-    // Démarrer UDP avec port différent pour éviter les conflits
-    if (!udp.begin(4001)) { // Port différent de OSCManager (4000)
-        Serial.println("[OSCQueue] Erreur: Impossible de démarrer UDP");
-        vQueueDelete(messageQueue);
-        messageQueue = nullptr;
+    if (txActive) {
+        // L'ancienne tâche d'envoi vide encore les files : pas de second consommateur
+        Serial.println("[OSCQueue] Erreur: tâche d'envoi précédente non terminée");
         return false;
     }
+    transport = &shared;
+    
+    // La file est un buffer circulaire statique : rien à allouer, on repart à vide
+    for (uint8_t l = 0; l < OSC_LANE_COUNT; l++) {
+        lanes[l].clear();
+    }
+    latestValues.clear();
+    carryValid = false;
+    latestMask = 0;
+    latestTaken = false;
     
-    // Configuration WiFi optimisée pour la fiabilité
-    WiFi.setSleep(false); // Désactiver le sleep WiFi pour éviter les pertes
-    WiFi.setAutoReconnect(true); // Reconnexion automatique
+    // Nouvelle session : un récepteur distingue un redémarrage d'un retour en arrière des numéros
+    reliableWindow.clear();
+    reliableWindow.setSession(esp_random());
+    shared.resetReliableSources();
+    ReliableControl stale;
+    while (reliableControl.pop(stale)) {
+    }
     
     initialized = true;
-    // Serial.println("[OSCQueue] Initialisé avec succès (port 4001)");
+    
+    // Tâche d'envoi sur le cœur réseau : loop() ne touche plus jamais au socket
+    txRunning = true;
+    txActive = true;
+    TaskHandle_t task = nullptr;
+    if (xTaskCreatePinnedToCore(txTaskEntry, "osc_tx", OSC_TX_TASK_STACK, this,
+                                OSC_TX_TASK_PRIORITY, &task, OSC_TX_TASK_CORE) != pdPASS) {
+        // Repli : envoi depuis update() comme auparavant
+        txRunning = false;
+        txActive = false;
+        task = nullptr;
+        Serial.println("[OSCQueue] Tâche d'envoi indisponible, envoi depuis loop()");
+    }
+    txTask = task;
+    // Serial.println("[OSCQueue] Initialisé avec succès");
     return true;
 }
 
 void OSCQueue::end() {
-    if (messageQueue) {
-        vQueueDelete(messageQueue);
-        messageQueue = nullptr;
+    const TaskHandle_t task = txTask;
+    if (task != nullptr) {
+        // La tâche termine son cycle en cours (résolution DNS comprise) puis se
+        // supprime elle-même : attente sans délai maximal, les files restent à elle
+        txRunning = false;
+        xTaskNotifyGive(task);
+        while (txActive) {
+            delay(2);
+        }
+        txTask = nullptr;
     }
-    udp.stop();
+    for (uint8_t l = 0; l < OSC_LANE_COUNT; l++) {
+        lanes[l].clear();
+    }
+    latestValues.clear();
+    carryValid = false;
     initialized = false;
+    if (statsResetPending.exchange(false)) {
+        applyStatsReset();
+    }
     // Serial.println("[OSCQueue] Arrêté");
 }
 
+void OSCQueue::txTaskEntry(void* arg) {
+    static_cast<OSCQueue*>(arg)->txLoop();
+}
+
+void OSCQueue::txLoop() {
+    while (txRunning) {
+        // Réveil par enqueue() ; le délai couvre les reconstructions de config sans message,
+        // raccourci tant que des événements fiables attendent leur accusé
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(reliablePending > 0 ? 5 : 50));
+        if (!txRunning) {
+            break;
+        }
+        if (statsResetPending.exchange(false)) {
+            applyStatsReset();
+        }
+        // Noms d'hôte des destinations : résolus ici, jamais sur le chemin de loop()
+        transport->resolvePending();
+        serviceReliable();
+        
+        // Vider par tranches de computeDrainBudget() datagrammes tant qu'il reste du travail
+        while (txRunning && getQueueSize() > 0) {
+            drain(computeDrainBudget());
+#if CONFIG_FREERTOS_UNICORE
+            // Mono-cœur (ESP32-C3) : rendre la main à loop() entre deux tranches
+            if (getQueueSize() > 0) {
+                vTaskDelay(1);
+            }
+#endif
+        }
+    }
+    // Dernier accès à l'objet : end() peut vider les files dès que txActive retombe
+    txActive = false;
+    vTaskDelete(nullptr);
+}
+
+bool OSCQueue::enqueue(const OSCMessageItem& item) {
+    const uint8_t lane = laneOf(item);
+    OSCRing<OSCMessageItem, QUEUE_SIZE>& queue = lanes[lane];
+    bool queued;
+    
+    if (coalescingEnabled && item.continuous && item.source < MAX_SOURCES) {
+        // Une case par composant : recherche O(1) par index, profondeur bornée
+        // par le nombre de contrôles actifs et non par leur vitesse
+        if (latestValues.store(item.source, item)) {
+            recordDrop(lane, OSC_REASON_REPLACED);
+        }
+        queued = true;
+    } else if (dropPolicy == OSC_DROP_COALESCE && item.continuous && item.source < MAX_SOURCES) {
+        // Une valeur plus ancienne de ce composant attend déjà hors file :
+        // la remplacer pour ne jamais envoyer une valeur périmée après une récente
+        if (latestValues.isPending(item.source)) {
+            if (latestValues.store(item.source, item)) {
+                recordDrop(lane, OSC_REASON_REPLACED);
+            }
+            queued = true;
+        } else if (queue.push(item)) {
+            queued = true;
+        } else {
+            latestValues.store(item.source, item);
+            queued = true;
+        }
+    } else if (dropPolicy == OSC_DROP_OLDEST) {
+        if (!queue.pushOverwrite(item)) {
+            recordDrop(lane, OSC_REASON_EVICTED); // Le plus ancien a été écarté
+        }
+        queued = true;
+    } else {
+        queued = queue.push(item); // Non-bloquant
+        if (!queued) {
+            recordDrop(lane, OSC_REASON_QUEUE_FULL);
+            // Serial.printf("[OSCQueue] Queue pleine, message perdu\n");
+        }
+    }
+    
+    if (queued) {
+        updateHighWater(lane);
+        const TaskHandle_t task = txTask;
+        if (task != nullptr) {
+            xTaskNotifyGive(task);
+        }
+    }
+    return queued;
+}
+
 bool OSCQueue::enqueueFloat(const String& address, float value) {
-    if (!initialized || !messageQueue) {
+    OSCPacketTemplate packet;
+    if (!packet.build(address.c_str(), 0)) {
+        truncatedCount++;
+    }
+    return enqueueFloat(packet, value);
+}
+
+bool OSCQueue::enqueueMidi(const String& address, uint8_t data1, uint8_t data2, uint8_t channel) {
+    OSCPacketTemplate packet;
+    if (!packet.build(address.c_str(), 1)) {
+        truncatedCount++;
+    }
+    return enqueueMidi(packet, data1, data2, channel);
+}
+
+bool OSCQueue::enqueueFloat(const OSCPacketTemplate& packet, float value,
+                            uint8_t source, bool continuous) {
+    if (!initialized || packet.messageType != 0) {
         return false;
     }
     
     OSCMessageItem item;
-    item.address = address;
+    item.packet = packet;
     item.value = value;
     item.data1 = 0;
     item.data2 = 0;
     item.channel = 0;
     item.messageType = 0; // Float
-    item.timestamp = millis();
-    
-    BaseType_t result = xQueueSend(messageQueue, &item, 0); // Non-bloquant
-    if (result != pdTRUE) {
-        // Serial.printf("[OSCQueue] Queue pleine, message float perdu: %s=%.3f\n", 
-        //              address.c_str(), value);
-        return false;
-    }
+    item.source = source;
+    item.continuous = continuous;
+    item.timestamp = micros();
     
-    return true;
+    return enqueue(item);
 }
 
-bool OSCQueue::enqueueMidi(const String& address, uint8_t data1, uint8_t data2, uint8_t channel) {
-    if (!initialized || !messageQueue) {
+bool OSCQueue::enqueueMidi(const OSCPacketTemplate& packet, uint8_t data1, uint8_t data2, uint8_t channel,
+                           uint8_t source, bool continuous) {
+    if (!initialized || packet.messageType != 1) {
         return false;
     }
     
     OSCMessageItem item;
-    item.address = address;
+    item.packet = packet;
     item.value = 0.0f;
     item.data1 = data1;
     item.data2 = data2;
     item.channel = channel;
     item.messageType = 1; // MIDI
-    item.timestamp = millis();
-    
-    BaseType_t result = xQueueSend(messageQueue, &item, 0); // Non-bloquant
-    if (result != pdTRUE) {
-        // Serial.printf("[OSCQueue] Queue pleine, message MIDI perdu: %s ch%d d1%d d2%d\n", 
-        //              address.c_str(), channel, data1, data2);
-        return false;
-    }
+    item.source = source;
+    item.continuous = continuous;
+    item.timestamp = micros();
     
-    return true;
+    return enqueue(item);
 }
 
 void OSCQueue::update() {
-    if (!initialized || !messageQueue) {
+    if (!initialized || txActive) {
         return;
     }
     
-    // Traiter jusqu'à 3 messages par cycle pour éviter de bloquer
-    for (int i = 0; i < 3; i++) {
+    if (statsResetPending.exchange(false)) {
+        applyStatsReset();
+    }
+    // Repli sans tâche : budget adaptatif plutôt que 3 messages fixes par cycle ;
+    // la résolution DNS d'une destination nommée retombe alors sur loop()
+    transport->resolvePending();
+    serviceReliable();
+    drain(computeDrainBudget());
+}
+
+uint16_t OSCQueue::computeDrainBudget() const {
+    // Datagrammes que l'on peut envoyer dans le budget de boucle, au coût mesuré
+    return oscDrainBudget(getQueueSize(), QUEUE_SIZE, drainBudgetUs, sendCostUs);
+}
+
+void OSCQueue::drain(uint16_t maxPackets) {
+    // Un seul prélèvement des valeurs coalescées par cycle
+    latestTaken = false;
+    if (bundleEnabled) {
+        drainBundle(maxPackets);
+    } else {
+        drainMessages(maxPackets);
+    }
+}
+
+bool OSCQueue::nextItem(OSCMessageItem& item) {
+    // Élément reporté du bundle précédent (déjà sorti de sa file)
+    if (carryValid) {
+        item = carryItem;
+        carryValid = false;
+        return true;
+    }
+    
+    // Tourniquet pondéré : laneWeights[l] éléments d'affilée par voie,
+    // une voie vide cède immédiatement son tour
+    for (uint8_t attempt = 0; attempt <= OSC_LANE_COUNT; attempt++) {
+        if (laneBurst >= laneWeights[currentLane]) {
+            currentLane = (currentLane + 1) % OSC_LANE_COUNT;
+            laneBurst = 0;
+        }
+        if (nextFromLane(currentLane, item)) {
+            laneBurst++;
+            return true;
+        }
+        currentLane = (currentLane + 1) % OSC_LANE_COUNT;
+        laneBurst = 0;
+    }
+    return false;
+}
+
+bool OSCQueue::nextFromLane(uint8_t lane, OSCMessageItem& item) {
+    if (lane == OSC_LANE_DISCRETE) {
+        return lanes[OSC_LANE_DISCRETE].pop(item);
+    }
+    
+    // 1. Valeurs coalescées déjà prélevées : à envoyer avant tout nouvel
+    //    élément de la file, qui peut être plus récent pour la même source
+    while (latestMask != 0) {
+        uint8_t source = (uint8_t)__builtin_ctz(latestMask);
+        latestMask &= latestMask - 1;
+        if (latestValues.read(source, item)) {
+            return true;
+        }
+        latestValues.restore(source); // Écriture concurrente : cycle suivant
+    }
+    
+    // 2. File continue (ordre d'arrivée)
+    if (lanes[OSC_LANE_CONTINUOUS].pop(item)) {
+        return true;
+    }
+    
+    // 3. File vide : prélever les dernières valeurs des composants continus
+    if (!latestTaken) {
+        latestTaken = true;
+        latestMask = latestValues.takePending();
+        if (latestMask != 0) {
+            return nextFromLane(lane, item);
+        }
+    }
+    return false;
+}
+
+void OSCQueue::drainMessages(uint16_t maxMessages) {
+    for (uint16_t i = 0; i < maxMessages; i++) {
         OSCMessageItem item;
-        BaseType_t result = xQueueReceive(messageQueue, &item, 0); // Non-bloquant
-        
-        if (result != pdTRUE) {
+        if (!nextItem(item)) {
             break; // Pas de message en attente
         }
+        if (!item.continuous && reliableEnabled.load(std::memory_order_relaxed)) {
+            sendReliable(item);
+            continue;
+        }
+        
+        // Encoder et envoyer le message OSC
+        OSCWriter writer(packetBuffer, sizeof(packetBuffer));
+        if (!encodeItem(writer, item)) {
+            recordFailed(laneOf(item), 1);
+            recordDrop(laneOf(item), OSC_REASON_OVERSIZE);
+        } else if (sendPacket(writer.data(), writer.length(), formatOf(item), 1)) {
+            recordSent(laneOf(item), item.timestamp, micros());
+        } else {
+            recordFailed(laneOf(item), 1);
+            recordDrop(laneOf(item), lastFailure);
+        }
+    }
+}
+
+void OSCQueue::drainBundle(uint16_t maxPackets) {
+    // Une destination filtrant par format : bundles homogènes (un encodage par format)
+    const bool homogeneous = transport->hasFormatFilter();
+    
+    // Vider la file dans des #bundle successifs, dans la limite du budget MTU
+    for (uint16_t packet = 0; packet < maxPackets; packet++) {
+        OSCWriter writer(packetBuffer, bundleMaxSize);
+        if (!writer.beginBundle(oscTimetagNow())) {
+            return;
+        }
         
-        // Créer et envoyer le message OSC
-        OSCMessage msg(item.address.c_str());
+        uint32_t count = 0;
+        uint8_t formats = 0;
+        bool full = false;
+        OSCMessageItem item;
+        while (nextItem(item)) {
+            if (!item.continuous && reliableEnabled.load(std::memory_order_relaxed)) {
+                // Événement numéroté : son propre datagramme, retransmissible seul
+                sendReliable(item);
+                continue;
+            }
+            if (homogeneous && count > 0 && formatOf(item) != formats) {
+                // Changement de format : l'élément ouvrira le bundle suivant
+                carryItem = item;
+                carryValid = true;
+                full = true;
+                break;
+            }
+            size_t mark = writer.beginElement();
+            if (!encodeItem(writer, item)) {
+                writer.rewind(mark);
+                if (count == 0) {
+                    // Un message seul dépasse le budget MTU : l'écarter pour ne pas bloquer la file
+                    recordFailed(laneOf(item), 1);
+                    recordDrop(laneOf(item), OSC_REASON_OVERSIZE);
+                    continue;
+                }
+                // L'élément ne tient plus : il ouvrira le bundle suivant
+                carryItem = item;
+                carryValid = true;
+                full = true;
+                break;
+            }
+            writer.endElement(mark);
+            formats |= formatOf(item);
+            bundleStamps[count] = item.timestamp;
+            bundleLanes[count] = laneOf(item);
+            count++;
+            if (count >= MAX_BUNDLE_ITEMS) {
+                full = true;
+                break;
+            }
+        }
         
-        if (item.messageType == 0) { // Float
-            msg.add(item.value);
-        } else { // MIDI
-            msg.add((int32_t)item.data1);
-            msg.add((int32_t)item.data2);
-            msg.add((int32_t)item.channel);
+        if (count == 0) {
+            return;
         }
         
-        if (sendOSCMessage(msg)) {
-            sentCount++;
+        if (sendPacket(writer.data(), writer.length(), formats, (uint16_t)count)) {
+            const uint32_t now = micros();
+            for (uint32_t i = 0; i < count; i++) {
+                recordSent(bundleLanes[i], bundleStamps[i], now);
+            }
+            bundleCount++;
         } else {
-            failedCount++;
+            for (uint32_t i = 0; i < count; i++) {
+                recordFailed(bundleLanes[i], 1);
+                recordDrop(bundleLanes[i], lastFailure);
+            }
+        }
+        
+        if (!full) {
+            return;
         }
     }
 }
 
-void OSCQueue::setTarget(const String& target_ip, uint16_t target_port) {
-    targetIP = target_ip;
-    targetPort = target_port;
-    // Serial.printf("[OSCQueue] Cible: %s:%d\n", targetIP.c_str(), targetPort);
+void OSCQueue::sendReliable(const OSCMessageItem& item) {
+    const uint8_t lane = laneOf(item);
+    uint8_t message[OSC_TEMPLATE_HEADER_SIZE + 12];
+    OSCWriter writer(message, sizeof(message));
+    bool evicted = false;
+    OSCReliableWindow::Slot* slot = nullptr;
+    if (encodeItem(writer, item)) {
+        slot = reliableWindow.open(message, writer.length(), formatOf(item), micros(), evicted);
+    }
+    if (evicted) {
+        reliableExpired++; // Fenêtre pleine : le plus ancien n'attend plus son accusé
+    }
+    if (!slot) {
+        recordFailed(lane, 1);
+        recordDrop(lane, OSC_REASON_OVERSIZE);
+        return;
+    }
+    reliableSent++;
+    reliablePending = reliableWindow.pending();
+    
+    // Premier envoi ; en échec, l'événement reste dans la fenêtre et sera retransmis
+    if (sendPacket(slot->data, slot->length, slot->formats, 1)) {
+        recordSent(lane, item.timestamp, micros());
+    } else {
+        recordFailed(lane, 1);
+        recordDrop(lane, lastFailure);
+    }
 }
 
-void OSCQueue::setBroadcast(bool enable) {
-    broadcastEnabled = enable;
-    // Serial.printf("[OSCQueue] Broadcast: %s\n", enable ? "activé" : "désactivé");
+void OSCQueue::serviceReliable() {
+    // Désactivé : la fenêtre est abandonnée, les accusés tardifs ignorés
+    if (!reliableEnabled.load(std::memory_order_relaxed)) {
+        if (reliablePending > 0) {
+            reliableWindow.clear();
+            reliablePending = 0;
+        }
+        ReliableControl stale;
+        while (reliableControl.pop(stale)) {
+        }
+        return;
+    }
+    reliableWindow.setDeadline(reliableDeadlineUs.load(std::memory_order_relaxed));
+    
+    // Accusés et NACK transmis par loop()
+    uint32_t now = micros();
+    ReliableControl control;
+    while (reliableControl.pop(control)) {
+        if (!control.nack) {
+            if (reliableWindow.ack(control.seq, now)) {
+                reliableAcked++;
+            }
+            continue;
+        }
+        reliableNacks++;
+        OSCReliableWindow::Slot* slot = reliableWindow.find(control.seq);
+        if (slot && !reliableWindow.expired(*slot, now)) {
+            // Retransmission sélective immédiate du trou signalé
+            slot->retries++;
+            slot->lastSent = now;
+            if (sendPacket(slot->data, slot->length, slot->formats, 1, true)) {
+                reliableRetransmits++;
+            }
+        }
+    }
+    
+    // Échéances et retransmissions faute d'accusé après le RTO (doublé à chaque essai) ;
+    // seules les destinations ayant déjà accusé les reçoivent : un récepteur ordinaire
+    // n'a que le premier envoi
+    now = micros();
+    for (uint8_t i = 0; i < OSCReliableWindow::SIZE; i++) {
+        OSCReliableWindow::Slot* slot = reliableWindow.slot(i);
+        if (!slot) {
+            continue;
+        }
+        if (reliableWindow.expired(*slot, now)) {
+            slot->used = false;
+            reliableExpired++;
+        } else if (reliableWindow.due(*slot, now)) {
+            slot->retries++;
+            slot->lastSent = now;
+            if (sendPacket(slot->data, slot->length, slot->formats, 1, true)) {
+                reliableRetransmits++;
+            }
+        }
+    }
+    reliablePending = reliableWindow.pending();
 }
 
-void OSCQueue::setInterface(uint8_t interface) {
-    networkInterface = interface;
-    // Serial.printf("[OSCQueue] Interface: %d\n", interface);
+bool OSCQueue::handleReliableControl(const OSCMessageView& message) {
+    const char* address = message.address();
+    bool nack;
+    if (strcmp(address, OSC_RELIABLE_ACK_ADDRESS) == 0) {
+        nack = false;
+    } else if (strcmp(address, OSC_RELIABLE_NACK_ADDRESS) == 0) {
+        nack = true;
+    } else {
+        return false;
+    }
+    
+    // ,i session puis ,i... numéros de séquence ; accusés d'une autre session ignorés
+    OSCMessageView view = message;
+    view.rewind();
+    OSCArgument arg;
+    if (!view.next(arg) || !arg.isNumber() || (uint32_t)arg.asInt32() != reliableWindow.getSession()) {
+        return true;
+    }
+    // L'émetteur parle le protocole : ses destinations recevront les retransmissions
+    if (transport != nullptr) {
+        transport->markReliableSource();
+    }
+    while (view.next(arg)) {
+        if (arg.isNumber()) {
+            ReliableControl control = { (uint32_t)arg.asInt32(), nack };
+            if (!reliableControl.push(control)) {
+                break; // File pleine : le récepteur renverra ses accusés
+            }
+        }
+    }
+    return true;
+}
+
+void OSCQueue::setReliable(bool enable) {
+    reliableEnabled.store(enable, std::memory_order_relaxed);
+}
+
+bool OSCQueue::isReliable() const {
+    return reliableEnabled.load(std::memory_order_relaxed);
+}
+
+void OSCQueue::setReliableDeadline(uint32_t milliseconds) {
+    if (milliseconds < 20) milliseconds = 20;
+    if (milliseconds > 5000) milliseconds = 5000;
+    reliableDeadlineUs.store(milliseconds * 1000, std::memory_order_relaxed);
+}
+
+uint32_t OSCQueue::getReliableDeadline() const {
+    return reliableDeadlineUs.load(std::memory_order_relaxed) / 1000;
+}
+
+bool OSCQueue::encodeItem(OSCWriter& writer, const OSCMessageItem& item) {
+    // En-tête déjà encodé : copie brute puis arguments big-endian
+    writer.bytes(item.packet.header, item.packet.headerLength);
+    if (item.messageType == 0) { // Float
+        writer.float32(item.value);
+    } else { // MIDI
+        writer.int32(item.data1);
+        writer.int32(item.data2);
+        writer.int32(item.channel);
+    }
+    return writer.ok();
+}
+
+void OSCQueue::recordSent(uint8_t lane, uint32_t timestamp, uint32_t now) {
+    uint32_t latency = now - timestamp;
+    uint8_t bucket = latency == 0 ? 0 : (uint8_t)(32 - __builtin_clz(latency));
+    if (bucket >= LATENCY_BUCKETS) {
+        bucket = LATENCY_BUCKETS - 1;
+    }
+    sentCount++;
+    laneStats[lane].sent++;
+    laneStats[lane].latency[bucket]++;
+    for (uint8_t t = 0; t < OSC_TRANSPORT_COUNT; t++) {
+        if (lastTransports & (1 << t)) {
+            transportStats[t].sent++;
+            transportStats[t].latency[bucket]++;
+        }
+    }
+}
+
+void OSCQueue::recordFailed(uint8_t lane, uint32_t count) {
+    failedCount += count;
+    laneStats[lane].failed += count;
+}
+
+void OSCQueue::recordDrop(uint8_t lane, OSCDropReason reason) {
+    laneDrops[lane].fetch_add(1, std::memory_order_relaxed);
+    dropReasons[reason].fetch_add(1, std::memory_order_relaxed);
+}
+
+void OSCQueue::updateHighWater(uint8_t lane) {
+    const uint32_t depth = getLaneDepth((OSCLane)lane);
+    if (depth > laneStats[lane].highWater) {
+        laneStats[lane].highWater = depth;
+    }
+}
+
+void OSCQueue::setBundleMode(bool enable) {
+    bundleEnabled = enable;
+}
+
+bool OSCQueue::isBundleMode() const {
+    return bundleEnabled;
+}
+
+void OSCQueue::setBundleMaxSize(uint16_t bytes) {
+    // Minimum : en-tête bundle (16) + un élément raisonnable
+    if (bytes < 64) bytes = 64;
+    if (bytes > OSC_MAX_PACKET_SIZE) bytes = OSC_MAX_PACKET_SIZE;
+    bundleMaxSize = bytes;
+}
+
+uint16_t OSCQueue::getBundleMaxSize() const {
+    return bundleMaxSize;
+}
+
+void OSCQueue::setDropPolicy(OSCDropPolicy policy) {
+    dropPolicy = policy > OSC_DROP_COALESCE ? OSC_DROP_NEWEST : policy;
+}
+
+OSCDropPolicy OSCQueue::getDropPolicy() const {
+    return dropPolicy;
+}
+
+void OSCQueue::setCoalescing(bool enable) {
+    coalescingEnabled = enable;
+}
+
+bool OSCQueue::isCoalescing() const {
+    return coalescingEnabled;
+}
+
+void OSCQueue::setLaneWeights(uint8_t discrete, uint8_t continuous) {
+    laneWeights[OSC_LANE_DISCRETE] = discrete > 0 ? discrete : 1;
+    laneWeights[OSC_LANE_CONTINUOUS] = continuous > 0 ? continuous : 1;
+}
+
+void OSCQueue::setDrainBudget(uint32_t microseconds) {
+    drainBudgetUs = microseconds > 0 ? microseconds : DEFAULT_DRAIN_BUDGET_US;
+}
+
+uint32_t OSCQueue::getDrainBudget() const {
+    return drainBudgetUs;
+}
+
+uint32_t OSCQueue::getSendCost() const {
+    return sendCostUs;
+}
+
+uint8_t OSCQueue::getLaneWeight(OSCLane lane) const {
+    return lane < OSC_LANE_COUNT ? laneWeights[lane] : 0;
+}
+
+bool OSCQueue::isTaskRunning() const {
+    return txActive;
 }
 
 uint32_t OSCQueue::getQueueSize() const {
-    if (!messageQueue) return 0;
-    return uxQueueMessagesWaiting(messageQueue);
+    return getLaneDepth(OSC_LANE_DISCRETE) + getLaneDepth(OSC_LANE_CONTINUOUS) + (carryValid ? 1 : 0);
 }
 
 uint32_t OSCQueue::getSentCount() const {
@@ -161,127 +683,207 @@ uint32_t OSCQueue::getFailedCount() const {
     return failedCount;
 }
 
+uint32_t OSCQueue::getOverflowCount() const {
+    // Pertes dues à la saturation de la file (hors remplacements par coalescence)
+    return dropReasons[OSC_REASON_QUEUE_FULL].load(std::memory_order_relaxed) +
+           dropReasons[OSC_REASON_EVICTED].load(std::memory_order_relaxed);
+}
+
+uint32_t OSCQueue::getTruncatedCount() const {
+    return truncatedCount;
+}
+
+uint32_t OSCQueue::getBundleCount() const {
+    return bundleCount;
+}
+
+uint32_t OSCQueue::getCoalescedCount() const {
+    return dropReasons[OSC_REASON_REPLACED].load(std::memory_order_relaxed);
+}
+
+uint32_t OSCQueue::getDropCount(OSCDropReason reason) const {
+    return reason < OSC_REASON_COUNT ? dropReasons[reason].load(std::memory_order_relaxed) : 0;
+}
+
+uint32_t OSCQueue::getLatencyBucket(uint8_t bucket) const {
+    if (bucket >= LATENCY_BUCKETS) {
+        return 0;
+    }
+    return laneStats[OSC_LANE_DISCRETE].latency[bucket] + laneStats[OSC_LANE_CONTINUOUS].latency[bucket];
+}
+
+uint32_t OSCQueue::getLaneDepth(OSCLane lane) const {
+    if (lane >= OSC_LANE_COUNT) {
+        return 0;
+    }
+    // Les valeurs coalescées en attente comptent dans la voie continue
+    return lanes[lane].size() + (lane == OSC_LANE_CONTINUOUS ? latestValues.size() : 0);
+}
+
+uint32_t OSCQueue::getLaneSentCount(OSCLane lane) const {
+    return lane < OSC_LANE_COUNT ? laneStats[lane].sent : 0;
+}
+
+uint32_t OSCQueue::getLaneFailedCount(OSCLane lane) const {
+    return lane < OSC_LANE_COUNT ? laneStats[lane].failed : 0;
+}
+
+uint32_t OSCQueue::getLaneDropCount(OSCLane lane) const {
+    return lane < OSC_LANE_COUNT ? laneDrops[lane].load(std::memory_order_relaxed) : 0;
+}
+
+uint32_t OSCQueue::getLaneHighWater(OSCLane lane) const {
+    return lane < OSC_LANE_COUNT ? laneStats[lane].highWater : 0;
+}
+
+uint32_t OSCQueue::getTransportSentCount(uint8_t transport) const {
+    return transport < OSC_TRANSPORT_COUNT ? transportStats[transport].sent : 0;
+}
+
+uint32_t OSCQueue::getTransportLatencyBucket(uint8_t transport, uint8_t bucket) const {
+    return (transport < OSC_TRANSPORT_COUNT && bucket < LATENCY_BUCKETS) ? transportStats[transport].latency[bucket] : 0;
+}
+
+uint32_t OSCQueue::getLaneLatencyBucket(OSCLane lane, uint8_t bucket) const {
+    return (lane < OSC_LANE_COUNT && bucket < LATENCY_BUCKETS) ? laneStats[lane].latency[bucket] : 0;
+}
+
 void OSCQueue::resetStats() {
+    // Compteurs écrits par la tâche d'envoi : remis à zéro par elle, au début de son
+    // cycle suivant ; sans consommateur actif (constructeur, file arrêtée), sur place
+    if (initialized) {
+        statsResetPending = true;
+        const TaskHandle_t task = txTask;
+        if (task != nullptr) {
+            xTaskNotifyGive(task);
+        }
+    } else {
+        applyStatsReset();
+    }
+    if (transport != nullptr) {
+        transport->resetStats();
+    }
+}
+
+void OSCQueue::applyStatsReset() {
     sentCount = 0;
     failedCount = 0;
+    truncatedCount = 0;
+    bundleCount = 0;
+    reliableSent = 0;
+    reliableAcked = 0;
+    reliableRetransmits = 0;
+    reliableExpired = 0;
+    reliableNacks = 0;
+    memset(laneStats, 0, sizeof(laneStats));
+    memset(transportStats, 0, sizeof(transportStats));
+    for (uint8_t l = 0; l < OSC_LANE_COUNT; l++) {
+        laneDrops[l].store(0, std::memory_order_relaxed);
+    }
+    for (uint8_t r = 0; r < OSC_REASON_COUNT; r++) {
+        dropReasons[r].store(0, std::memory_order_relaxed);
+    }
 }
 
 void OSCQueue::printNetworkStatus() const {
-    Serial.println("=== OSCQueue Network Status ===");
-    Serial.printf("WiFi Status: %d (%s)\n", WiFi.status(), 
-                  WiFi.status() == WL_CONNECTED ? "Connected" : "Disconnected");
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.printf("Local IP: %s\n", WiFi.localIP().toString().c_str());
-        Serial.printf("Subnet: %s\n", WiFi.subnetMask().toString().c_str());
-        Serial.printf("Gateway: %s\n", WiFi.gatewayIP().toString().c_str());
-        Serial.printf("RSSI: %d dBm\n", WiFi.RSSI());
-    }
-    Serial.printf("Target: %s:%d\n", targetIP.c_str(), targetPort);
-    Serial.printf("Broadcast: %s\n", broadcastEnabled ? "Enabled" : "Disabled");
-    Serial.printf("Interface: %d (0=AP, 1=STA, 2=BOTH)\n", networkInterface);
+    if (transport != nullptr) {
+        transport->printStatus();
+    }
+    Serial.printf("TX task: %s (core %d)\n", txActive ? "running" : "off", OSC_TX_TASK_CORE);
     Serial.printf("Queue Size: %d/%d\n", getQueueSize(), QUEUE_SIZE);
-    Serial.println("===============================");
+}
+
+// Affiche les buckets non vides d'un histogramme log2 (µs)
+static void printLatencyHistogram(const uint32_t* histogram, uint8_t buckets) {
+    for (uint8_t i = 0; i < buckets; i++) {
+        if (histogram[i] == 0) {
+            continue;
+        }
+        if (i == 0) {
+            Serial.printf("    < 1 us: %lu\n", (unsigned long)histogram[i]);
+        } else if (i == buckets - 1) {
+            Serial.printf("    >= %lu us: %lu\n", 1UL << (i - 1), (unsigned long)histogram[i]);
+        } else {
+            Serial.printf("    %lu-%lu us: %lu\n", 1UL << (i - 1), (1UL << i) - 1, (unsigned long)histogram[i]);
+        }
+    }
 }
 
 void OSCQueue::printDetailedStats() const {
+    static const char* policyNames[] = {"drop-newest", "drop-oldest", "coalesce"};
+    static const char* laneNames[] = {"discrete", "continuous"};
+    static const char* transportNames[] = {"unicast", "broadcast-ap", "broadcast-sta", "multicast", "serial"};
+    static const char* reasonNames[] = {"queue full", "evicted", "replaced", "oversize", "no network", "send error", "rate limited"};
     Serial.println("=== OSCQueue Detailed Stats ===");
     Serial.printf("Messages sent: %d\n", sentCount);
     Serial.printf("Messages failed: %d\n", failedCount);
-    Serial.printf("Success rate: %.1f%%\n", 
-                  sentCount + failedCount > 0 ? 
+    Serial.printf("Queue overflows: %d\n", getOverflowCount());
+    Serial.printf("Truncated addresses: %d\n", truncatedCount);
+    Serial.printf("Drop policy: %s\n", policyNames[dropPolicy]);
+    Serial.printf("Coalescing: %s (%d pending)\n", coalescingEnabled ? "ON" : "OFF", latestValues.size());
+    Serial.printf("Bundle mode: %s (max %d bytes, %d bundles)\n",
+                  bundleEnabled ? "ON" : "OFF", bundleMaxSize, bundleCount);
+    Serial.printf("Reliable: %s (deadline %lu ms, rtt %lu us): sent %lu, acked %lu, retransmits %lu, nacks %lu, expired %lu, pending %d\n",
+                  isReliable() ? "ON" : "OFF", (unsigned long)getReliableDeadline(),
+                  (unsigned long)reliableWindow.getSmoothedRtt(), (unsigned long)reliableSent,
+                  (unsigned long)reliableAcked, (unsigned long)reliableRetransmits,
+                  (unsigned long)reliableNacks, (unsigned long)reliableExpired, reliablePending);
+    Serial.printf("Drain budget: %lu us (send cost ~%lu us, %d datagrams/slice)\n",
+                  (unsigned long)drainBudgetUs, (unsigned long)sendCostUs, computeDrainBudget());
+    Serial.printf("Success rate: %.1f%%\n",
+                  sentCount + failedCount > 0 ?
                   (float)sentCount / (sentCount + failedCount) * 100.0f : 0.0f);
-    Serial.printf("Queue utilization: %.1f%%\n", 
-                  (float)getQueueSize() / QUEUE_SIZE * 100.0f);
+    Serial.println("Drops by reason:");
+    for (uint8_t r = 0; r < OSC_REASON_COUNT; r++) {
+        Serial.printf("  %s: %lu\n", reasonNames[r], (unsigned long)dropReasons[r].load(std::memory_order_relaxed));
+    }
+    for (uint8_t l = 0; l < OSC_LANE_COUNT; l++) {
+        const LaneStats& stats = laneStats[l];
+        Serial.printf("Lane %s (weight %d): depth %d/%d (high-water %lu), sent %d, failed %d, dropped %lu\n",
+                      laneNames[l], laneWeights[l], getLaneDepth((OSCLane)l), QUEUE_SIZE,
+                      (unsigned long)stats.highWater, stats.sent, stats.failed,
+                      (unsigned long)laneDrops[l].load(std::memory_order_relaxed));
+        printLatencyHistogram(stats.latency, LATENCY_BUCKETS);
+    }
+    for (uint8_t t = 0; t < OSC_TRANSPORT_COUNT; t++) {
+        const TransportStats& stats = transportStats[t];
+        if (stats.sent == 0) {
+            continue;
+        }
+        Serial.printf("Transport %s: sent %lu\n", transportNames[t], (unsigned long)stats.sent);
+        printLatencyHistogram(stats.latency, LATENCY_BUCKETS);
+    }
     Serial.println("===============================");
 }
 
-bool OSCQueue::sendOSCMessage(OSCMessage& msg) {
-    bool success = false;
-    int retryCount = 0;
+bool OSCQueue::sendPacket(const uint8_t* data, size_t length, uint8_t formats, uint16_t messages,
+                          bool reliableOnly) {
     const int maxRetries = 3; // Plus de retry pour la fiabilité
+    const uint32_t start = micros();
     
-    // Vérifier l'état WiFi avant l'envoi
-    if (WiFi.status() != WL_CONNECTED && networkInterface != 0) {
-        // Serial.printf("[OSCQueue] WiFi déconnecté, statut: %d\n", WiFi.status());
-        return false;
-    }
+    // Tampons lwIP saturés : la tâche dédiée cède le cœur entre deux tentatives ;
+    // en repli sans tâche on ne retente pas pour ne pas figer le scan
+    const OSCSendResult result = transport->send(data, length, formats, messages,
+                                                 txActive ? maxRetries : 0,
+                                                 txActive, &lastTransports, reliableOnly);
     
-    if (broadcastEnabled) {
-        // Mode broadcast avec optimisation
-        if (networkInterface == 0 || networkInterface == 2) { // AP ou BOTH
-            while (retryCount <= maxRetries && !success) {
-                if (udp.beginPacket("192.168.4.255", targetPort)) {
-                    msg.send(udp);
-                    if (udp.endPacket()) {
-                        success = true;
-                        // Serial.printf("[OSCQueue] Broadcast AP réussi (tentative %d)\n", retryCount + 1);
-                    } else {
-                        // Serial.printf("[OSCQueue] Échec endPacket AP (tentative %d)\n", retryCount + 1);
-                    }
-                } else {
-                    // Serial.printf("[OSCQueue] Échec beginPacket AP (tentative %d)\n", retryCount + 1);
-                }
-                retryCount++;
-                if (!success && retryCount <= maxRetries) {
-                    delay(2); // Petit délai entre les tentatives
-                }
-            }
-        }
-        
-        if ((networkInterface == 1 || networkInterface == 2) && WiFi.status() == WL_CONNECTED) {
-            // Broadcast STA avec calcul d'adresse optimisé
-            IPAddress ip = WiFi.localIP();
-            IPAddress subnet = WiFi.subnetMask();
-            IPAddress broadcast = IPAddress(ip[0] | (~subnet[0]), 
-                                           ip[1] | (~subnet[1]), 
-                                           ip[2] | (~subnet[2]), 
-                                           ip[3] | (~subnet[3]));
-            
-            retryCount = 0;
-            while (retryCount <= maxRetries && !success) {
-                if (udp.beginPacket(broadcast, targetPort)) {
-                    msg.send(udp);
-                    if (udp.endPacket()) {
-                        success = true;
-                        // Serial.printf("[OSCQueue] Broadcast STA réussi (tentative %d)\n", retryCount + 1);
-                    } else {
-                        // Serial.printf("[OSCQueue] Échec endPacket STA (tentative %d)\n", retryCount + 1);
-                    }
-                } else {
-                    // Serial.printf("[OSCQueue] Échec beginPacket STA (tentative %d)\n", retryCount + 1);
-                }
-                retryCount++;
-                if (!success && retryCount <= maxRetries) {
-                    delay(2); // Petit délai entre les tentatives
-                }
-            }
-        }
-    } else {
-        // Mode unicast avec vérification d'adresse
-        if (!targetIP.isEmpty()) {
-            while (retryCount <= maxRetries && !success) {
-                if (udp.beginPacket(targetIP.c_str(), targetPort)) {
-                    msg.send(udp);
-                    if (udp.endPacket()) {
-                        success = true;
-                        // Serial.printf("[OSCQueue] Unicast réussi (tentative %d)\n", retryCount + 1);
-                    } else {
-                        // Serial.printf("[OSCQueue] Échec endPacket unicast (tentative %d)\n", retryCount + 1);
-                    }
-                } else {
-                    // Serial.printf("[OSCQueue] Échec beginPacket unicast (tentative %d)\n", retryCount + 1);
-                }
-                retryCount++;
-                if (!success && retryCount <= maxRetries) {
-                    delay(2); // Petit délai entre les tentatives
-                }
-            }
-        }
-    }
+    // Moyenne glissante du coût d'un datagramme, base du budget de vidage
+    sendCostUs = oscUpdateSendCost(sendCostUs, (int32_t)(micros() - start));
     
-    if (!success) {
-        // Serial.printf("[OSCQueue] Échec définitif après %d tentatives\n", maxRetries + 1);
+    switch (result) {
+        case OSC_SEND_OK:
+            return true;
+        case OSC_SEND_RATE_LIMITED:
+            lastFailure = OSC_REASON_RATE_LIMITED;
+            break;
+        case OSC_SEND_NO_DESTINATION:
+            // WiFi déconnecté ou aucune destination pour ce format
+            lastFailure = OSC_REASON_NO_NETWORK;
+            break;
+        default:
+            lastFailure = OSC_REASON_SEND_ERROR;
+            // Serial.printf("[OSCQueue] Échec définitif après %d tentatives\n", maxRetries + 1);
+            break;
     }
-    
-    return success;
+    return false;
 }
@@ -2,46 +2,169 @@
 #define OSCQUEUE_H
 
 #include <Arduino.h>
-#include <WiFiUdp.h>
-#include <OSCMessage.h>
+#include <atomic>
 #include <freertos/FreeRTOS.h>
-#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "osc/OSCRing.h"
+#include "osc/OSCLatest.h"
+#include "osc/OSCCodec.h"
+#include "osc/OSCTransport.h"
+#include "osc/OSCReliable.h"
+#include "osc/OSCDrainBudget.h"
 
-// Structure pour les messages OSC en queue
+// Tâche d'envoi OSC : cœur réseau (WiFi sur le cœur 0), priorité au-dessus de loop()
+#ifndef OSC_TX_TASK_CORE
+#define OSC_TX_TASK_CORE 0
+#endif
+#ifndef OSC_TX_TASK_PRIORITY
+#define OSC_TX_TASK_PRIORITY 2
+#endif
+#ifndef OSC_TX_TASK_STACK
+#define OSC_TX_TASK_STACK 4096
+#endif
+
+// Source inconnue (message non rattaché à un composant)
+static constexpr uint8_t OSC_SOURCE_NONE = 0xFF;
+
+// Politique appliquée quand la file est pleine
+enum OSCDropPolicy : uint8_t {
+    OSC_DROP_NEWEST = 0,   // Le nouveau message est perdu (comportement historique)
+    OSC_DROP_OLDEST = 1,   // Le plus ancien message en attente est écarté
+    OSC_DROP_COALESCE = 2  // Valeurs continues : dernière valeur par composant
+};
+
+// Voies de priorité de la file sortante
+enum OSCLane : uint8_t {
+    OSC_LANE_DISCRETE = 0,   // Boutons, notes : jamais retardés par les flux continus
+    OSC_LANE_CONTINUOUS = 1, // Potentiomètres : flux à haut débit
+    OSC_LANE_COUNT = 2
+};
+
+// Causes de perte d'un message
+enum OSCDropReason : uint8_t {
+    OSC_REASON_QUEUE_FULL = 0, // File pleine : nouveau message refusé (drop-newest)
+    OSC_REASON_EVICTED = 1,    // File pleine : plus ancien écarté (drop-oldest)
+    OSC_REASON_REPLACED = 2,   // Valeur continue remplacée par une plus récente (coalescence)
+    OSC_REASON_OVERSIZE = 3,   // Message plus grand que le budget MTU du bundle
+    OSC_REASON_NO_NETWORK = 4, // WiFi STA déconnecté ou aucune destination résolue
+    OSC_REASON_SEND_ERROR = 5, // beginPacket/endPacket en échec après les tentatives
+    OSC_REASON_RATE_LIMITED = 6, // Toutes les destinations concernées au-delà de leur débit
+    OSC_REASON_COUNT = 7
+};
+
+// Transports de sortie (type des destinations ayant accepté le datagramme)
+static constexpr uint8_t OSC_TRANSPORT_COUNT = OSC_DEST_KIND_COUNT; // cf. OSCDestinationKind
+
+// Structure POD pour les messages OSC en queue (copiée par valeur, sans allocation)
 struct OSCMessageItem {
-    String address;
+    OSCPacketTemplate packet; // En-tête pré-encodé (adresse + type tags)
     float value;
     uint8_t data1;
     uint8_t data2;
     uint8_t channel;
     uint8_t messageType; // 0=float, 1=MIDI
-    uint32_t timestamp;
+    uint8_t source;      // Index du composant (OSC_SOURCE_NONE si aucun)
+    bool continuous;     // Valeur continue (potentiomètre) : remplaçable par une plus récente
+    uint32_t timestamp;  // micros() à la mise en file (histogramme de latence)
 };
 
 class OSCQueue {
 public:
+    static const uint8_t LATENCY_BUCKETS = 16; // Puissances de 2 en µs (< 1 µs ... >= 16 ms)
+    static const uint8_t DEFAULT_DISCRETE_WEIGHT = 4;
+    static const uint8_t DEFAULT_CONTINUOUS_WEIGHT = 1;
+    static const uint32_t DEFAULT_DRAIN_BUDGET_US = 1000;
+    static const uint32_t DEFAULT_SEND_COST_US = 200;
+    
     OSCQueue();
     ~OSCQueue();
-
-    bool begin();
+    
+    // Envoi via le transport partagé (socket et destinations), qui doit survivre à la file
+    bool begin(OSCTransport& transport);
     void end();
     
     // Ajouter des messages à la queue (non-bloquant)
     bool enqueueFloat(const String& address, float value);
     bool enqueueMidi(const String& address, uint8_t data1, uint8_t data2, uint8_t channel);
     
-    // Traiter la queue (à appeler dans loop())
+    // Variantes sans encodage : en-tête pré-construit par le composant (cf. OSCPacketTemplate)
+    bool enqueueFloat(const OSCPacketTemplate& packet, float value,
+                      uint8_t source = OSC_SOURCE_NONE, bool continuous = false);
+    bool enqueueMidi(const OSCPacketTemplate& packet, uint8_t data1, uint8_t data2, uint8_t channel,
+                     uint8_t source = OSC_SOURCE_NONE, bool continuous = false);
+    
+    // Traiter la queue (à appeler dans loop()) : sans effet quand la tâche d'envoi tourne,
+    // sinon envoie une tranche bornée par le budget de vidage
     void update();
     
-    // Configuration
-    void setTarget(const String& target_ip, uint16_t target_port);
-    void setBroadcast(bool enable);
-    void setInterface(uint8_t interface);
+    // Mode bundle (opt-in) : toute la file part dans un seul #bundle par cycle
+    void setBundleMode(bool enable);
+    bool isBundleMode() const;
+    void setBundleMaxSize(uint16_t bytes); // Budget MTU du datagramme (clampé à OSC_MAX_PACKET_SIZE)
+    uint16_t getBundleMaxSize() const;
+    
+    // Politique de saturation
+    void setDropPolicy(OSCDropPolicy policy);
+    OSCDropPolicy getDropPolicy() const;
+    
+    // Coalescence (opt-in) : toute valeur continue remplace en place la valeur
+    // en attente du même composant ; les événements discrets restent dans la file
+    void setCoalescing(bool enable);
+    bool isCoalescing() const;
+    
+    // Tourniquet pondéré : nombre d'éléments consécutifs servis par voie (>= 1)
+    void setLaneWeights(uint8_t discrete, uint8_t continuous);
+    uint8_t getLaneWeight(OSCLane lane) const;
+    
+    // Livraison fiable (opt-in) des événements discrets : numéro de séquence,
+    // accusés/NACK et retransmission sélective jusqu'à l'échéance ; les valeurs
+    // continues restent sans accusé (cf. OSCReliableWindow)
+    void setReliable(bool enable);
+    bool isReliable() const;
+    void setReliableDeadline(uint32_t milliseconds);
+    uint32_t getReliableDeadline() const; // ms
+    // Réception (loop()) : /esp32/ack et /esp32/nack ; false pour tout autre message
+    bool handleReliableControl(const OSCMessageView& message);
+    
+    // Budget de vidage adaptatif : temps alloué par tranche (µs) ; le nombre de
+    // datagrammes découle de la profondeur et du coût d'envoi mesuré
+    void setDrainBudget(uint32_t microseconds);
+    uint32_t getDrainBudget() const;
+    uint32_t getSendCost() const; // Moyenne glissante du coût d'un datagramme (µs)
+    bool isTaskRunning() const;
     
     // Statistiques
     uint32_t getQueueSize() const;
     uint32_t getSentCount() const;
     uint32_t getFailedCount() const;
+    uint32_t getOverflowCount() const;  // Messages perdus car file pleine
+    uint32_t getTruncatedCount() const; // Adresses tronquées à OSC_TEMPLATE_ADDRESS_SIZE-1
+    uint32_t getBundleCount() const;    // Datagrammes #bundle envoyés
+    uint32_t getCoalescedCount() const; // Valeurs continues remplacées par une plus récente
+    uint32_t getDropCount(OSCDropReason reason) const;
+    // Histogramme de latence enqueue -> envoyé : bucket i = [2^(i-1), 2^i) µs
+    uint32_t getLatencyBucket(uint8_t bucket) const;
+    
+    // Statistiques par voie
+    uint32_t getLaneDepth(OSCLane lane) const;
+    uint32_t getLaneSentCount(OSCLane lane) const;
+    uint32_t getLaneFailedCount(OSCLane lane) const;
+    uint32_t getLaneDropCount(OSCLane lane) const;
+    uint32_t getLaneHighWater(OSCLane lane) const; // Profondeur max observée depuis le dernier reset
+    uint32_t getLaneLatencyBucket(OSCLane lane, uint8_t bucket) const;
+    
+    // Statistiques par transport (OSCDestinationKind : unicast, broadcast AP/STA, multicast, série)
+    uint32_t getTransportSentCount(uint8_t transport) const;   // Messages envoyés
+    uint32_t getTransportLatencyBucket(uint8_t transport, uint8_t bucket) const;
+    
+    // Statistiques de livraison fiable
+    uint32_t getReliableSentCount() const { return reliableSent; }        // Événements numérotés
+    uint32_t getReliableAckedCount() const { return reliableAcked; }
+    uint32_t getReliableRetransmitCount() const { return reliableRetransmits; }
+    uint32_t getReliableExpiredCount() const { return reliableExpired; }  // Échéance dépassée ou fenêtre pleine
+    uint32_t getReliableNackCount() const { return reliableNacks; }
+    uint8_t getReliablePending() const { return reliablePending; }
+    uint32_t getReliableRtt() const { return reliableWindow.getSmoothedRtt(); } // µs
     void resetStats();
     
     // Diagnostic réseau
@@ -49,24 +172,107 @@ public:
     void printDetailedStats() const;
 
 private:
-    void processQueue();
-    bool sendOSCMessage(OSCMessage& msg);
+    bool enqueue(const OSCMessageItem& item);
+    bool nextItem(OSCMessageItem& item);
+    bool nextFromLane(uint8_t lane, OSCMessageItem& item);
+    static uint8_t laneOf(const OSCMessageItem& item) {
+        return item.continuous ? OSC_LANE_CONTINUOUS : OSC_LANE_DISCRETE;
+    }
+    uint16_t computeDrainBudget() const;
+    void drain(uint16_t maxPackets);
+    void drainMessages(uint16_t maxMessages);
+    void drainBundle(uint16_t maxPackets);
+    bool encodeItem(OSCWriter& writer, const OSCMessageItem& item);
+    bool sendPacket(const uint8_t* data, size_t length, uint8_t formats, uint16_t messages,
+                    bool reliableOnly = false);
+    void sendReliable(const OSCMessageItem& item);
+    void serviceReliable(); // Accusés, retransmissions, échéances (tâche d'envoi)
+    static uint8_t formatOf(const OSCMessageItem& item) {
+        return item.messageType == 1 ? OSC_FORMAT_MIDI : OSC_FORMAT_FLOAT;
+    }
+    void recordSent(uint8_t lane, uint32_t timestamp, uint32_t now);
+    void recordFailed(uint8_t lane, uint32_t count);
+    void recordDrop(uint8_t lane, OSCDropReason reason);
+    void updateHighWater(uint8_t lane);
+    void applyStatsReset(); // Côté consommateur (tâche d'envoi ou update() en repli)
     
+    static void txTaskEntry(void* arg);
+    void txLoop();
+
 private:
-    QueueHandle_t messageQueue;
-    WiFiUDP udp;
-    String targetIP;
-    uint16_t targetPort;
+    static const int QUEUE_SIZE = 32;
+    static const int MAX_RETRIES = 2;
+    static const uint8_t MAX_SOURCES = 32;
+    static const uint8_t MAX_BUNDLE_ITEMS = 96; // Éléments suivis par bundle (latence par message)
+    
+    OSCRing<OSCMessageItem, QUEUE_SIZE> lanes[OSC_LANE_COUNT]; // Une file par voie de priorité
+    OSCLatest<OSCMessageItem, MAX_SOURCES> latestValues; // Mode coalescence / débordement COALESCE
+    OSCTransport* transport; // Socket et destinations partagés avec OSCManager
     bool initialized;
-    bool broadcastEnabled;
-    uint8_t networkInterface;
+    bool bundleEnabled;
+    uint16_t bundleMaxSize;
+    OSCDropPolicy dropPolicy;
+    bool coalescingEnabled;
+    uint8_t packetBuffer[OSC_MAX_PACKET_SIZE]; // Buffer d'encodage réutilisé (pas d'allocation)
+    
+    // Consommateur : élément reporté (bundle plein) et sources continues à vider
+    OSCMessageItem carryItem;
+    bool carryValid;
+    uint32_t latestMask;
+    bool latestTaken;
+    uint32_t bundleStamps[MAX_BUNDLE_ITEMS]; // Horodatage des éléments du bundle en cours
+    uint8_t bundleLanes[MAX_BUNDLE_ITEMS];
+    uint8_t lastTransports;        // Transports (bits OSCDestinationKind) du dernier datagramme envoyé
+    OSCDropReason lastFailure;     // Cause du dernier échec d'envoi
+    uint8_t laneWeights[OSC_LANE_COUNT];
+    uint8_t currentLane;
+    uint8_t laneBurst; // Éléments servis d'affilée sur currentLane
+    uint32_t drainBudgetUs;
+    uint32_t sendCostUs;
+    
+    // Livraison fiable : fenêtre côté tâche d'envoi, accusés transmis par loop()
+    struct ReliableControl {
+        uint32_t seq;
+        bool nack;
+    };
+    OSCReliableWindow reliableWindow;
+    OSCRing<ReliableControl, 32> reliableControl;
+    std::atomic<bool> reliableEnabled;
+    std::atomic<uint32_t> reliableDeadlineUs;
+    uint8_t reliablePending;
+    
+    // Tâche d'envoi : txRunning demande l'arrêt, txActive reste vrai jusqu'à la
+    // sortie effective de la tâche (un seul consommateur sur les files SPSC)
+    std::atomic<TaskHandle_t> txTask;
+    std::atomic<bool> txRunning;
+    std::atomic<bool> txActive;
+    std::atomic<bool> statsResetPending; // resetStats() depuis une autre tâche (serveur web)
     
     // Statistiques
+    struct LaneStats {
+        uint32_t sent;
+        uint32_t failed;
+        uint32_t highWater;
+        uint32_t latency[LATENCY_BUCKETS];
+    };
+    struct TransportStats {
+        uint32_t sent;
+        uint32_t latency[LATENCY_BUCKETS];
+    };
+    LaneStats laneStats[OSC_LANE_COUNT];
+    TransportStats transportStats[OSC_TRANSPORT_COUNT];
+    // Pertes : comptées par loop() (enqueue) et par la tâche d'envoi (autre cœur)
+    std::atomic<uint32_t> laneDrops[OSC_LANE_COUNT]; // Toutes causes (cf. dropReasons)
+    std::atomic<uint32_t> dropReasons[OSC_REASON_COUNT];
     uint32_t sentCount;
     uint32_t failedCount;
-    
-    static const int QUEUE_SIZE = 32;
-    static const int MAX_RETRIES = 2;
+    uint32_t truncatedCount;
+    uint32_t bundleCount;
+    uint32_t reliableSent;
+    uint32_t reliableAcked;
+    uint32_t reliableRetransmits;
+    uint32_t reliableExpired;
+    uint32_t reliableNacks;
 };
 
 #endif // OSCQUEUE_H
@@ -2,7 +2,7 @@
 #include <Arduino.h> // For Serial.printf
 #include <ESPmDNS.h>
 #include <Preferences.h>
-#include "ComponentManager.h"
+#include "midi/MidiEventBus.h"
 
 USING_NAMESPACE_APPLEMIDI
 
@@ -10,7 +10,7 @@ USING_NAMESPACE_APPLEMIDI
 // Le nom sera changé dynamiquement dans begin()
 APPLEMIDI_CREATE_INSTANCE(WiFiUDP, MIDI, "ESP32-MIDI", 5004);
 
-RtpMidi::RtpMidi() : isStarted(false) {
+RtpMidi::RtpMidi() : isStarted(false), lock(nullptr), eventsSent(0), packetsSent(0) {
 }
 
 RtpMidi::~RtpMidi() {
@@ -18,6 +18,15 @@ RtpMidi::~RtpMidi() {
 }
 
 bool RtpMidi::begin(const String& name) {
+    // Créé une fois : jamais détruit, la tâche de la clock peut l'attendre
+    if (!lock) {
+        lock = xSemaphoreCreateMutex();
+        if (!lock) {
+            Serial.println("RTP-MIDI: Échec de création du verrou");
+            return false;
+        }
+    }
+    
     // Lire le nom depuis les préférences (priorité) ou utiliser le paramètre
     Preferences preferences;
     preferences.begin("esp32server", false);
@@ -71,23 +80,23 @@ bool RtpMidi::begin(const String& name) {
         // debug_network( "RTP-MIDI: Déconnexion reçue\n");
     });
     
+    // MIDI Thru (actif par défaut dans la bibliothèque MIDI) : chaque message reçu
+    // repartait vers l'hôte, d'où l'écho observé (docs/ANALYSE_ECHO_MIDIROUTER.md) ;
+    // le relais entre transports est désormais décidé par MidiRouter
+    MIDI.turnThruOff();
+    
     // Configurer les callbacks MIDI standard pour éviter l'écho
+    // (publiés sur le bus : MidiRouter les route vers le retour LED, sans réémission)
     MIDI.setHandleNoteOn([](byte channel, byte note, byte velocity) {
-        Serial.printf("Note On: ch%d note%d vel%d\n", channel, note, velocity);
-        extern ComponentManager g_componentManager;
-        g_componentManager.handleMidiNoteOn(channel, note, velocity);
+        g_midiBus.publish(MidiEvent::noteOn(channel, note, velocity, MIDI_SOURCE_RTP));
     });
 
     MIDI.setHandleNoteOff([](byte channel, byte note, byte velocity) {
-        Serial.printf("Note Off: ch%d note%d vel%d\n", channel, note, velocity);
-        extern ComponentManager g_componentManager;
-        g_componentManager.handleMidiNoteOff(channel, note, velocity);
+        g_midiBus.publish(MidiEvent::noteOff(channel, note, velocity, MIDI_SOURCE_RTP));
     });
 
     MIDI.setHandleControlChange([](byte channel, byte control, byte value) {
-        Serial.printf("CC: ch%d cc%d val%d\n", channel, control, value);
-        extern ComponentManager g_componentManager;
-        g_componentManager.handleMidiControlChange(channel, control, value);
+        g_midiBus.publish(MidiEvent::controlChange(channel, control, value, MIDI_SOURCE_RTP));
     });
     
     isStarted = true;
@@ -100,70 +109,109 @@ bool RtpMidi::begin(const String& name) {
 
 void RtpMidi::stop() {
     if (isStarted) {
+        xSemaphoreTake(lock, portMAX_DELAY);
+        batch.clear();
         AppleMIDI.end();
         isStarted = false;
+        xSemaphoreGive(lock);
         Serial.println("RTP-MIDI: Arrêté");
     }
 }
 
 void RtpMidi::update() {
     if (!isStarted) return;
+    // Tenu par la tâche de la clock : elle lit la session, on réessaie au cycle suivant
+    if (xSemaphoreTake(lock, 0) != pdTRUE) return;
+    
+    // Liste prête (fenêtre écoulée ou liste pleine) : la session l'envoie pendant MIDI.read()
+    if (batch.ready(micros(), RTP_MIDI_FLUSH_US)) {
+        flush();
+    }
     
     // Nécessaire pour que les callbacks MIDI soient appelés
     // Les callbacks évitent l'écho en traitant directement les messages
     MIDI.read();
+    xSemaphoreGive(lock);
 }
 
-void RtpMidi::sendNoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
+void RtpMidi::send(const MidiEvent& event) {
     if (!isStarted) return;
-    MIDI.sendNoteOn(note, velocity, channel);
+    // Messages canal et temps réel seulement (la liste ne code pas le système commun)
+    if (event.status < 0x80 || (event.status >= 0xF0 && !event.isRealtime())) return;
+    xSemaphoreTake(lock, portMAX_DELAY);
+    batch.add(event);
+    xSemaphoreGive(lock);
 }
 
-void RtpMidi::sendNoteOff(uint8_t channel, uint8_t note, uint8_t velocity) {
+void RtpMidi::sendNow(const MidiEvent& event) {
     if (!isStarted) return;
-    MIDI.sendNoteOff(note, velocity, channel);
+    xSemaphoreTake(lock, portMAX_DELAY);
+    // Liste en cours et événement dans le même paquet, sans attendre RTP_MIDI_FLUSH_US ;
+    // la session ne transmet que pendant MIDI.read()
+    batch.add(event);
+    flush();
+    MIDI.read();
+    xSemaphoreGive(lock);
+}
+
+void RtpMidi::flush() {
+    if (batch.empty()) return;
+    
+    // Une liste de commandes par cycle ; ce qui dépasse part au cycle suivant
+    uint8_t list[RTP_MIDI_BATCH_BYTES];
+    uint16_t commands = 0;
+    const size_t length = batch.take(list, sizeof(list), commands);
+    if (length == 0) return;
+    
+    // Liste déjà encodée (delta times, running status) : une seule transmission
+    AppleMIDI.beginTransmission(midi::InvalidType);
+    for (size_t i = 0; i < length; i++) {
+        AppleMIDI.write(list[i]);
+    }
+    AppleMIDI.endTransmission();
+    eventsSent += commands;
+    packetsSent++;
+}
+
+void RtpMidi::sendNoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
+    send(MidiEvent::noteOn(channel, note, velocity));
+}
+
+void RtpMidi::sendNoteOff(uint8_t channel, uint8_t note, uint8_t velocity) {
+    send(MidiEvent::noteOff(channel, note, velocity));
 }
 
 void RtpMidi::sendControlChange(uint8_t channel, uint8_t control, uint8_t value) {
-    if (!isStarted) return;
-    MIDI.sendControlChange(control, value, channel);
+    send(MidiEvent::controlChange(channel, control, value));
 }
 
 void RtpMidi::sendProgramChange(uint8_t channel, uint8_t program) {
-    if (!isStarted) return;
-    MIDI.sendProgramChange(program, channel);
+    send(MidiEvent::programChange(channel, program));
 }
 
 void RtpMidi::sendPitchBend(uint8_t channel, int bend) {
-    if (!isStarted) return;
     // Pitch Bend: -8192 à +8191, centre=0
-    // La bibliothèque MIDI attend une valeur signée
-    MIDI.sendPitchBend(bend, channel);
+    send(MidiEvent::pitchBend(channel, bend));
 }
 
 void RtpMidi::sendAftertouch(uint8_t channel, uint8_t pressure) {
-    if (!isStarted) return;
-    MIDI.sendAfterTouch(pressure, channel);
+    send(MidiEvent::aftertouch(channel, pressure));
 }
 
 void RtpMidi::sendClock() {
-    if (!isStarted) return;
-    MIDI.sendRealTime(midi::Clock);
+    send(MidiEvent::realtime(0xF8));
 }
 
 void RtpMidi::sendStart() {
-    if (!isStarted) return;
-    MIDI.sendRealTime(midi::Start);
+    send(MidiEvent::realtime(0xFA));
 }
 
 void RtpMidi::sendStop() {
-    if (!isStarted) return;
-    MIDI.sendRealTime(midi::Stop);
+    send(MidiEvent::realtime(0xFC));
 }
 
 void RtpMidi::sendContinue() {
-    if (!isStarted) return;
-    MIDI.sendRealTime(midi::Continue);
+    send(MidiEvent::realtime(0xFB));
 }
 
 bool RtpMidi::isConnected() const {
@@ -6,13 +6,35 @@
 #include <WiFiClient.h>
 #include <WiFiUDP.h>
 #include <AppleMIDI.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "midi/RtpMidiBatch.h"
 
 USING_NAMESPACE_APPLEMIDI
 
+/**
+ * @brief Session RTP-MIDI (AppleMIDI)
+ *
+ * Les send*() n'envoient rien immédiatement : les événements sont regroupés
+ * (RtpMidiBatch) puis remis à la session par update() en une seule transmission,
+ * soit un paquet RTP portant plusieurs commandes (delta times, running status).
+ * Une liste part au plus toutes les RTP_MIDI_FLUSH_US (ou dès qu'elle est pleine) :
+ * le débit de paquets ne suit plus la vitesse de loop(), les deltas gardent l'écart
+ * entre événements (test/bench_rtp_midi.cpp).
+ * sendNow() (tâche de la clock) envoie la liste en cours avec l'événement sans
+ * attendre la fenêtre ; la liste et la session sont protégées par un mutex,
+ * update() passe son tour s'il est pris.
+ */
 class RtpMidi {
 private:
     String deviceName;
     bool isStarted;
+    RtpMidiBatch batch;
+    SemaphoreHandle_t lock;  // Liste et session : loop() et tâche de la clock
+    uint32_t eventsSent;
+    uint32_t packetsSent;
+    
+    void flush(); // Verrou tenu
     
 public:
     RtpMidi();
@@ -34,6 +56,15 @@ public:
     void sendStart();
     void sendStop();
     void sendContinue();
+    // Événement du bus (horodatage conservé : deltas RFC 6295) : chemin utilisé par MidiRouter
+    void send(const MidiEvent& event);
+    // Ajouté puis transmis immédiatement, depuis une autre tâche que loop() (clock)
+    void sendNow(const MidiEvent& event);
+    
+    // Statistiques d'envoi : événements et listes de commandes (paquets)
+    uint32_t getEventsSent() const { return eventsSent; }
+    uint32_t getPacketsSent() const { return packetsSent; }
+    uint32_t getOverflowCount() const { return batch.getOverflowCount(); }
     
     bool isConnected() const;
     bool isInitialized() const { return isStarted; }
@@ -1,6 +1,7 @@
 #include "ServerCore.h"
 #include <ESPmDNS.h>
 #include <Preferences.h>
+#include "osc/OSCQuery.h"
 // setupWebAPI est déclaré plus bas et défini dans WebAPI.cpp
 
 // Déclaration de la fonction setupHttp définie dans WebAPI.cpp
@@ -46,6 +47,8 @@ void ServerCore::begin(const char* apSsid, const char* apPass, const char* hostn
         // Serial.print("[ServerCore] Trying mDNS name: "); Serial.println(mdnsNames[i]);
         if (MDNS.begin(mdnsNames[i].c_str())) {
             MDNS.addService("http", "tcp", 80);
+            MDNS.addService("oscjson", "tcp", 80); // Découverte OSCQuery
+            g_oscQuery.setName(mdnsNames[i].c_str());
             mdnsOk = true;
             workingName = mdnsNames[i];
             // Serial.print("[ServerCore] mDNS success: http://"); Serial.print(workingName); Serial.println(".local/");
@@ -136,6 +139,7 @@ void ServerCore::setStaticStaIp(IPAddress ip, IPAddress gateway, IPAddress subne
 void ServerCore::update() {
     // Mise à jour du WebSocket
     ws.cleanupClients();
+    g_oscQuery.update();
     
     // Mise à jour RTP-MIDI
     rtpMidiInstance.update();
@@ -171,6 +175,8 @@ void ServerCore::reconfigureMdns(const char* hostname) {
         // Serial.print("[ServerCore] Trying mDNS name: "); Serial.println(mdnsNames[i]);
         if (MDNS.begin(mdnsNames[i].c_str())) {
             MDNS.addService("http", "tcp", 80);
+            MDNS.addService("oscjson", "tcp", 80); // Découverte OSCQuery
+            g_oscQuery.setName(mdnsNames[i].c_str());
             mdnsOk = true;
             workingName = mdnsNames[i];
             // Serial.print("[ServerCore] mDNS success: http://"); Serial.print(workingName); Serial.println(".local/");
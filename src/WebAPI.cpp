@@ -1,6 +1,9 @@
 #include "ServerCore.h"
 #include "ui_index.h"
 #include "PinMapper.h"
+#include "ComponentManager.h"
+#include "midi/MidiRouter.h"
+#include "midi/MidiClock.h"
 #include "api/APICommon.h"
 #include <Preferences.h>
 #include <ESPAsyncWebServer.h>
@@ -10,6 +13,8 @@ Preferences preferences;
 
 // Signale au runtime de recharger les configs pins
 extern "C" void esp32server_requestReloadPins();
+extern "C" void esp32server_requestReloadOsc();
+extern "C" void esp32server_requestReloadMidi();
 
 // Fonction pour obtenir la configuration par défaut d'une pin
 String getDefaultConfig(String pin) {
@@ -78,6 +83,31 @@ void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventTyp
     }
 }
 
+// Tableau JSON des voies de la file OSC (profondeur, high-water, compteurs, latence log2 en µs)
+static String buildOscLanesJson(OSCQueue& queue) {
+    static const char* laneNames[] = {"discrete", "continuous"};
+    String json = "[";
+    for (uint8_t l = 0; l < OSC_LANE_COUNT; l++) {
+        OSCLane lane = (OSCLane)l;
+        if (l > 0) json += ",";
+        json += "{\"name\":\"" + String(laneNames[l]) + "\"";
+        json += ",\"weight\":" + String(queue.getLaneWeight(lane));
+        json += ",\"depth\":" + String(queue.getLaneDepth(lane));
+        json += ",\"high_water\":" + String(queue.getLaneHighWater(lane));
+        json += ",\"sent\":" + String(queue.getLaneSentCount(lane));
+        json += ",\"failed\":" + String(queue.getLaneFailedCount(lane));
+        json += ",\"dropped\":" + String(queue.getLaneDropCount(lane));
+        json += ",\"latency_us_log2\":[";
+        for (uint8_t b = 0; b < OSCQueue::LATENCY_BUCKETS; b++) {
+            if (b > 0) json += ",";
+            json += String(queue.getLaneLatencyBucket(lane, b));
+        }
+        json += "]}";
+    }
+    json += "]";
+    return json;
+}
+
 // Fonction pour envoyer le statut RTP-MIDI via WebSocket
 void sendRtpStatus(AsyncWebSocket& ws) {
     preferences.begin("esp32server", false);
@@ -103,6 +133,10 @@ void sendRtpStatus(AsyncWebSocket& ws) {
 void setupWebAPI(AsyncWebServer& server, AsyncWebSocket& ws) {
     // Serial.println("[WebAPI] Starting setup...");
     
+    // OSCQuery : arbre JSON et WebSocket LISTEN, avant la page principale
+    // (la racine "/" reste l'UI pour les navigateurs, cf. OSCQueryServer)
+    g_oscQuery.attach(server);
+    
     // Page principale
     // Serial.println("[WebAPI] Setting up main page...");
     server.on("/", HTTP_GET, [](AsyncWebServerRequest *request){
@@ -230,6 +264,7 @@ void setupWebAPI(AsyncWebServer& server, AsyncWebSocket& ws) {
             preferences.begin("esp32server", false);
             preferences.putBool("rtp_enabled", isEnabled);
             preferences.end();
+            esp32server_requestReloadMidi();
             
             extern ServerCore serverCore;
             if(isEnabled){
@@ -265,10 +300,134 @@ void setupWebAPI(AsyncWebServer& server, AsyncWebSocket& ws) {
         json += "\"name\":\"" + name + "\",";
         json += "\"target\":\"" + target + "\",";
         json += "\"connected\":" + String(serverCore.rtpMidi().isConnected() ? "true" : "false");
+        // Envois regroupés : événements, listes de commandes (paquets), événements écartés
+        json += ",\"events\":" + String(serverCore.rtpMidi().getEventsSent());
+        json += ",\"packets\":" + String(serverCore.rtpMidi().getPacketsSent());
+        json += ",\"overflow\":" + String(serverCore.rtpMidi().getOverflowCount());
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+    
+    // API - Bus d'événements MIDI : publiés, refusés (file pleine), profondeur maximale, transports
+    server.on("/api/midi/stats", HTTP_GET, [](AsyncWebServerRequest *request){
+        extern MidiRouter g_midiRouter;
+        String json = "{";
+        json += "\"published\":" + String(g_midiBus.getPublishedCount());
+        json += ",\"dropped\":" + String(g_midiBus.getDroppedCount());
+        json += ",\"high_water\":" + String(g_midiBus.getHighWater());
+        json += ",\"capacity\":" + String(g_midiBus.capacity());
+        // Transports sortants : bits 0=RTP, 1=BLE, 2=OSC (compilés / activés)
+        json += ",\"transports_compiled\":" + String(MidiRouter::getCompiledTransports());
+        json += ",\"transports_enabled\":" + String(g_midiRouter.getTransportMask());
+        json += ",\"bridge\":" + String(g_midiRouter.isBridgeEnabled() ? "true" : "false");
+        json += ",\"duplicates\":" + String(g_midiRouter.getDuplicateCount());
+        json += ",\"relayed\":" + String(g_midiRouter.getRelayedCount());
+        json += ",\"hop_limited\":" + String(g_midiRouter.getHopLimitCount());
+        // BLE-MIDI : notifications envoyées, paquets reçus décodés (SysEx comptés, non transmis)
+        BluetoothManager& ble = serverCore.bluetooth();
+        json += ",\"ble\":{\"connected\":" + String(ble.isConnected() ? "true" : "false");
+        json += ",\"mtu\":" + String(ble.getMtu());
+        json += ",\"notifications\":" + String(ble.getNotificationCount());
+        json += ",\"bytes_received\":" + String(ble.getBytesReceived());
+        json += ",\"messages_received\":" + String(ble.getMessagesReceived());
+        json += ",\"sysex_received\":" + String(ble.getSysExReceived());
+        json += ",\"malformed\":" + String(ble.getMalformedPackets()) + "}";
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+    
+    // API - Routage MIDI : pont entre transports (RTP-MIDI, BLE, OSC), jamais vers l'origine
+    // (déclarée après /api/midi/stats : ESPAsyncWebServer route aussi les sous-chemins)
+    server.on("/api/midi", HTTP_POST, [](AsyncWebServerRequest *request){
+        if(request->hasParam("bridge", true)){
+            preferences.begin("esp32server", false);
+            preferences.putBool("midi_bridge", request->getParam("bridge", true)->value() == "true");
+            preferences.end();
+            esp32server_requestReloadMidi();
+            request->send(200, "application/json", "{\"status\":\"ok\"}");
+        } else {
+            request->send(400, "application/json", "{\"error\":\"bridge parameter required\"}");
+        }
+    });
+    
+    // API - Clock MIDI : état, tempo, position (ticks depuis Start)
+    server.on("/api/clock", HTTP_GET, [](AsyncWebServerRequest *request){
+        String json = "{";
+        json += "\"enabled\":" + String(g_midiClock.isEnabled() ? "true" : "false");
+        json += ",\"playing\":" + String(g_midiClock.isPlaying() ? "true" : "false");
+        json += ",\"bpm\":" + String(g_midiClock.getTempo() / 100.0f, 2);
+        json += ",\"tap_active\":" + String(g_midiClock.isTapActive(millis()) ? "true" : "false");
+        json += ",\"ticks\":" + String(g_midiClock.getTickCount());
+        json += ",\"late\":" + String(g_midiClock.getLateCount());
         json += "}";
         request->send(200, "application/json", json);
     });
     
+    // API - Clock MIDI : action=start|stop|continue|on|off|tap, bpm (sauvegardé en NVS)
+    server.on("/api/clock", HTTP_POST, [](AsyncWebServerRequest *request){
+        if(!request->hasParam("action", true) && !request->hasParam("bpm", true)){
+            request->send(400, "application/json", "{\"error\":\"action or bpm required\"}");
+            return;
+        }
+        if(request->hasParam("bpm", true)){
+            const uint32_t bpmCenti = (uint32_t)(request->getParam("bpm", true)->value().toFloat() * 100.0f + 0.5f);
+            g_midiClock.setTempo(bpmCenti);
+            preferences.begin("esp32server", false);
+            preferences.putUInt("clock_bpm", g_midiClock.getTempo());
+            preferences.end();
+        }
+        if(request->hasParam("action", true)){
+            String action = request->getParam("action", true)->value();
+            if(action == "start") g_midiClock.start();
+            else if(action == "stop") g_midiClock.stop();
+            else if(action == "continue") g_midiClock.resume();
+            else if(action == "on") g_midiClock.setEnabled(true);
+            else if(action == "off") g_midiClock.setEnabled(false);
+            else if(action == "tap") g_midiClock.tap(millis());
+            else {
+                request->send(400, "application/json", "{\"error\":\"unknown action\"}");
+                return;
+            }
+        }
+        request->send(200, "application/json", "{\"status\":\"ok\"}");
+    });
+    
+    // API - Remise à zéro des statistiques OSC
+    // (déclarée avant /api/osc : ESPAsyncWebServer route aussi les sous-chemins "/api/osc/...")
+    server.on("/api/osc/stats/reset", HTTP_POST, [](AsyncWebServerRequest *request){
+        extern ComponentManager g_componentManager;
+        g_componentManager.getOSCQueue().resetStats();
+        request->send(200, "application/json", "{\"status\":\"ok\"}");
+    });
+    
+    // API - Liste des destinations OSC : "hôte:port[:float|midi][@débit[/rafale]]" séparées par ','
+    // (hôte = IP, nom, groupe multicast, "ap", "sta" ou "serial:<uart>" ; liste vide : cible/broadcast de /api/osc)
+    // baud (optionnel) : débit de l'UART 1 pour les destinations "serial:1"
+    server.on("/api/osc/destinations", HTTP_POST, [](AsyncWebServerRequest *request){
+        if(!request->hasParam("list", true)){
+            request->send(400, "application/json", "{\"error\":\"list required\"}");
+            return;
+        }
+        String list = request->getParam("list", true)->value();
+        OSCDestinationConfig dests[OSCDestinationTable::MAX_DESTINATIONS];
+        uint8_t count = OSCDestinationTable::parseList(list.c_str(), dests, OSCDestinationTable::MAX_DESTINATIONS);
+        if(list.length() > 0 && count == 0){
+            request->send(400, "application/json", "{\"error\":\"invalid list\"}");
+            return;
+        }
+        
+        String baud = request->hasParam("baud", true) ? request->getParam("baud", true)->value() : "";
+        
+        preferences.begin("esp32server", false);
+        preferences.putString("osc_dests", list);
+        if(baud.toInt() > 0) preferences.putInt("osc_baud", baud.toInt());
+        preferences.end();
+        
+        // Appliqué sans redémarrage : relu par ComponentManager à l'époque suivante
+        esp32server_requestReloadOsc();
+        request->send(200, "application/json", "{\"status\":\"ok\",\"count\":" + String(count) + "}");
+    });
+    
     // API - Configuration OSC
     server.on("/api/osc", HTTP_POST, [](AsyncWebServerRequest *request){
         if(request->hasParam("target", true) && request->hasParam("port", true)){
@@ -278,6 +437,18 @@ void setupWebAPI(AsyncWebServer& server, AsyncWebSocket& ws) {
             // Nouveaux paramètres OSC
             String ip = request->hasParam("ip", true) ? request->getParam("ip", true)->value() : "";
             String broadcast = request->hasParam("broadcast", true) ? request->getParam("broadcast", true)->value() : "false";
+            // Mode bundle (optionnel) : un seul datagramme #bundle par cycle, budget MTU en octets
+            String bundle = request->hasParam("bundle", true) ? request->getParam("bundle", true)->value() : "";
+            String mtu = request->hasParam("mtu", true) ? request->getParam("mtu", true)->value() : "";
+            // Politique de saturation de la file : 0=drop-newest, 1=drop-oldest, 2=coalesce
+            String drop = request->hasParam("drop", true) ? request->getParam("drop", true)->value() : "";
+            // Coalescence des potentiomètres : dernière valeur par composant
+            String coalesce = request->hasParam("coalesce", true) ? request->getParam("coalesce", true)->value() : "";
+            // Budget de vidage par tranche, en microsecondes
+            String budget = request->hasParam("budget_us", true) ? request->getParam("budget_us", true)->value() : "";
+            // Livraison fiable des événements discrets et échéance de retransmission (ms)
+            String reliable = request->hasParam("reliable", true) ? request->getParam("reliable", true)->value() : "";
+            String reliableMs = request->hasParam("reliable_ms", true) ? request->getParam("reliable_ms", true)->value() : "";
             
             // Sauvegarder en NVS
             preferences.begin("esp32server", false);
@@ -285,7 +456,15 @@ void setupWebAPI(AsyncWebServer& server, AsyncWebSocket& ws) {
             preferences.putInt("osc_port", port);
             if(ip.length() > 0) preferences.putString("osc_ip", ip);
             preferences.putBool("osc_broadcast", broadcast == "true");
+            if(bundle.length() > 0) preferences.putBool("osc_bundle", bundle == "true");
+            if(mtu.length() > 0) preferences.putInt("osc_mtu", mtu.toInt());
+            if(drop.length() > 0) preferences.putInt("osc_drop", drop.toInt());
+            if(coalesce.length() > 0) preferences.putBool("osc_coalesce", coalesce == "true");
+            if(budget.length() > 0) preferences.putInt("osc_budget_us", budget.toInt());
+            if(reliable.length() > 0) preferences.putBool("osc_reliable", reliable == "true");
+            if(reliableMs.length() > 0) preferences.putInt("osc_rel_ms", reliableMs.toInt());
             preferences.end();
+            esp32server_requestReloadOsc();
             
             request->send(200, "application/json", "{\"status\":\"ok\"}");
         } else {
@@ -300,16 +479,116 @@ void setupWebAPI(AsyncWebServer& server, AsyncWebSocket& ws) {
         int port = preferences.getInt("osc_port", 8000);
         String ip = preferences.getString("osc_ip", "");
         bool broadcast = preferences.getBool("osc_broadcast", false);
+        bool bundle = preferences.getBool("osc_bundle", false);
+        int mtu = preferences.getInt("osc_mtu", 1472);
+        int drop = preferences.getInt("osc_drop", 0);
+        bool coalesce = preferences.getBool("osc_coalesce", false);
+        int budget = preferences.getInt("osc_budget_us", 1000);
+        bool reliable = preferences.getBool("osc_reliable", false);
+        int reliableMs = preferences.getInt("osc_rel_ms", 250);
+        String dests = preferences.getString("osc_dests", "");
         preferences.end();
         String json = "{";
         json += "\"target\":\"" + target + "\",";
         json += "\"port\":" + String(port);
         if(ip.length() > 0) json += ",\"ip\":\"" + ip + "\"";
         json += ",\"broadcast\":" + String(broadcast ? "true" : "false");
+        json += ",\"bundle\":" + String(bundle ? "true" : "false");
+        json += ",\"mtu\":" + String(mtu);
+        json += ",\"drop\":" + String(drop);
+        json += ",\"coalesce\":" + String(coalesce ? "true" : "false");
+        json += ",\"budget_us\":" + String(budget);
+        json += ",\"reliable\":" + String(reliable ? "true" : "false");
+        json += ",\"reliable_ms\":" + String(reliableMs);
+        json += ",\"destinations\":\"" + dests + "\"";
+        json += ",\"oscquery\":{\"nodes\":" + String(g_oscQuery.getNodeCount());
+        json += ",\"listeners\":" + String(g_oscQuery.getListenerCount()) + "}";
         json += "}";
         request->send(200, "application/json", json);
     });
     
+    // API - Voies de priorité de la file OSC sortante (profondeur, pertes, latence)
+    server.on("/api/osc/lanes", HTTP_GET, [](AsyncWebServerRequest *request){
+        extern ComponentManager g_componentManager;
+        String json = "{\"lanes\":" + buildOscLanesJson(g_componentManager.getOSCQueue()) + "}";
+        request->send(200, "application/json", json);
+    });
+    
+    // API - Statistiques OSC complètes : latence par voie et par transport, pertes par cause
+    server.on("/api/osc/stats", HTTP_GET, [](AsyncWebServerRequest *request){
+        extern ComponentManager g_componentManager;
+        static const char* transportNames[] = {"unicast", "broadcast_ap", "broadcast_sta", "multicast", "serial"};
+        static const char* reasonNames[] = {"queue_full", "evicted", "replaced", "oversize", "no_network", "send_error", "rate_limited"};
+        OSCQueue& queue = g_componentManager.getOSCQueue();
+        String json = "{";
+        json += "\"sent\":" + String(queue.getSentCount());
+        json += ",\"failed\":" + String(queue.getFailedCount());
+        json += ",\"bundles\":" + String(queue.getBundleCount());
+        json += ",\"truncated\":" + String(queue.getTruncatedCount());
+        json += ",\"depth\":" + String(queue.getQueueSize());
+        json += ",\"send_cost_us\":" + String(queue.getSendCost());
+        json += ",\"drops\":{";
+        for (uint8_t r = 0; r < OSC_REASON_COUNT; r++) {
+            if (r > 0) json += ",";
+            json += "\"" + String(reasonNames[r]) + "\":" + String(queue.getDropCount((OSCDropReason)r));
+        }
+        json += "},\"reliable\":{\"enabled\":" + String(queue.isReliable() ? "true" : "false");
+        json += ",\"sent\":" + String(queue.getReliableSentCount());
+        json += ",\"acked\":" + String(queue.getReliableAckedCount());
+        json += ",\"retransmits\":" + String(queue.getReliableRetransmitCount());
+        json += ",\"nacks\":" + String(queue.getReliableNackCount());
+        json += ",\"expired\":" + String(queue.getReliableExpiredCount());
+        json += ",\"pending\":" + String(queue.getReliablePending());
+        json += ",\"rtt_us\":" + String(queue.getReliableRtt());
+        json += "},\"lanes\":" + buildOscLanesJson(queue);
+        json += ",\"transports\":[";
+        for (uint8_t t = 0; t < OSC_TRANSPORT_COUNT; t++) {
+            if (t > 0) json += ",";
+            json += "{\"name\":\"" + String(transportNames[t]) + "\"";
+            json += ",\"sent\":" + String(queue.getTransportSentCount(t));
+            json += ",\"latency_us_log2\":[";
+            for (uint8_t b = 0; b < OSCQueue::LATENCY_BUCKETS; b++) {
+                if (b > 0) json += ",";
+                json += String(queue.getTransportLatencyBucket(t, b));
+            }
+            json += "]}";
+        }
+        json += "]}";
+        request->send(200, "application/json", json);
+    });
+    
+    // API - Destinations OSC résolues : ce que reçoit chaque récepteur
+    server.on("/api/osc/destinations", HTTP_GET, [](AsyncWebServerRequest *request){
+        extern ComponentManager g_componentManager;
+        static const char* kindNames[] = {"unicast", "broadcast_ap", "broadcast_sta", "multicast", "serial"};
+        static const char* formatNames[] = {"none", "float", "midi", "all"};
+        OSCTransport& transport = g_componentManager.getOSCTransport();
+        String json = "{\"serial_baud\":" + String(transport.getSerialBaud());
+        json += ",\"serial_dropped\":" + String(transport.getSerialDroppedFrames());
+        json += ",\"destinations\":[";
+        // Copie de chaque entrée : la tâche d'envoi peut reconstruire la table entre-temps
+        OSCDestination dest;
+        OSCDestinationConfig config;
+        for (uint8_t d = 0; transport.getDestination(d, dest, config); d++) {
+            if (d > 0) json += ",";
+            json += "{\"kind\":\"" + String(kindNames[dest.kind]) + "\"";
+            json += ",\"host\":\"" + String(config.host) + "\"";
+            json += ",\"ip\":\"" + dest.ip.toString() + "\"";
+            json += ",\"port\":" + String(dest.port);
+            json += ",\"format\":\"" + String(formatNames[dest.formats & OSC_FORMAT_ALL]) + "\"";
+            json += ",\"rate\":" + String(dest.rate);
+            json += ",\"burst\":" + String(dest.burst);
+            json += ",\"active\":" + String(dest.active ? "true" : "false");
+            json += ",\"sent\":" + String(dest.sent);
+            json += ",\"failed\":" + String(dest.failed);
+            json += ",\"limited\":" + String(dest.limited);
+            json += ",\"bytes\":" + String(dest.bytes);
+            json += "}";
+        }
+        json += "]}";
+        request->send(200, "application/json", json);
+    });
+    
     // API - Configuration mDNS
     server.on("/api/mdns", HTTP_POST, [](AsyncWebServerRequest *request){
         if(request->hasParam("name", true)){
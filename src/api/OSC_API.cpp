@@ -21,9 +21,8 @@ void setupOSC_API(AsyncWebServer& server) {
             preferences.putString("osc_interface", interface);
             preferences.end();
             
-            /* Demander le rechargement OSC */
-            // TODO: Implémenter esp32server_requestReloadOsc() si nécessaire
-            // esp32server_requestReloadOsc();
+            /* Demander le rechargement OSC (époque de configuration) */
+            esp32server_requestReloadOsc();
             
             request->send(200, "application/json", "{\"status\":\"ok\"}\n");
         } else {
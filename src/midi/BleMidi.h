@@ -0,0 +1,296 @@
+// Format de paquet BLE-MIDI (spécification MIDI over Bluetooth Low Energy)
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "messages.h"
+
+// Service et caractéristique standard : reconnus par iOS, macOS, Android, Windows
+#define BLE_MIDI_SERVICE_UUID        "03b80e5a-ede8-4b33-a751-6ce34ec4c700"
+#define BLE_MIDI_CHARACTERISTIC_UUID "7772e5db-3868-4112-a1a9-f2669d106bf3"
+
+// Taille maximale d'une notification (MTU négocié - 3, plafonné ici)
+#ifndef BLE_MIDI_MAX_PACKET
+#define BLE_MIDI_MAX_PACKET 128
+#endif
+
+// MTU ATT par défaut avant négociation : 20 octets utiles
+static constexpr uint16_t BLE_MIDI_DEFAULT_MTU = 23;
+
+/**
+ * @brief Encodeur de paquets BLE-MIDI
+ *
+ * Un paquet = en-tête (10hhhhhh : 6 bits hauts d'un horodatage 13 bits en ms)
+ * puis des messages précédés de leur octet d'horodatage (1lllllll : 7 bits bas).
+ * - Running status : même statut canal que le message précédent → octet de
+ *   statut omis ; même horodatage en plus → octet d'horodatage omis aussi
+ * - Les messages temps réel sont toujours complets et rompent le running status
+ * - add() retourne false si le message ne tient pas (capacité atteinte, ou
+ *   écart ≥ 128 ms avec le précédent : le récepteur ne saurait plus compter
+ *   les débordements des 7 bits bas) : envoyer data()/size() puis reset()
+ *
+ * Sans dépendance BLE (testable sur l'hôte).
+ */
+class BleMidiEncoder {
+public:
+    BleMidiEncoder() : capacity(BLE_MIDI_DEFAULT_MTU - 3), length(0), lastTime(0), runningStatus(0) {}
+
+    // Octets utiles d'une notification (MTU - 3), plafonnés à BLE_MIDI_MAX_PACKET
+    void setCapacity(size_t bytes) {
+        if (bytes < 5) bytes = 5;
+        capacity = bytes > BLE_MIDI_MAX_PACKET ? BLE_MIDI_MAX_PACKET : bytes;
+    }
+    size_t getCapacity() const { return capacity; }
+
+    bool add(const MidiEvent& event, uint16_t timeMs) {
+        timeMs &= 0x1FFF;
+        if (length > 0) {
+            const uint16_t elapsed = (uint16_t)((timeMs - lastTime) & 0x1FFF);
+            if (elapsed >= 0x1000) {
+                timeMs = lastTime; // Horodatage antérieur : aligné sur le précédent
+            } else if (elapsed >= 128) {
+                return false;
+            }
+        }
+
+        uint8_t bytes[5];
+        size_t count = 0;
+        const bool channelMessage = !event.isRealtime();
+        const bool running = length > 0 && channelMessage && event.status == runningStatus;
+        if (length == 0) {
+            bytes[count++] = (uint8_t)(0x80 | ((timeMs >> 7) & 0x3F));
+        }
+        if (!running || timeMs != lastTime) {
+            bytes[count++] = (uint8_t)(0x80 | (timeMs & 0x7F));
+        }
+        if (!running) {
+            bytes[count++] = event.status;
+        }
+        if (channelMessage) {
+            bytes[count++] = event.data1;
+            const uint8_t type = event.status & 0xF0;
+            if (type != 0xC0 && type != 0xD0) {
+                bytes[count++] = event.data2;
+            }
+        }
+        if (length + count > capacity) {
+            return false;
+        }
+
+        memcpy(buffer + length, bytes, count);
+        length += count;
+        lastTime = timeMs;
+        runningStatus = channelMessage ? event.status : 0;
+        return true;
+    }
+
+    bool empty() const { return length == 0; }
+    const uint8_t* data() const { return buffer; }
+    size_t size() const { return length; }
+    void reset() {
+        length = 0;
+        runningStatus = 0;
+    }
+
+private:
+    uint8_t buffer[BLE_MIDI_MAX_PACKET];
+    size_t capacity;
+    size_t length;
+    uint16_t lastTime;
+    uint8_t runningStatus;
+};
+
+/**
+ * @brief Décodeur de paquets BLE-MIDI reçus (flux, paquet par paquet)
+ *
+ * - Octet à bit haut : horodatage (7 bits bas ; retour en arrière = +128 ms
+ *   sur les bits hauts de l'en-tête), sauf juste après un horodatage où
+ *   c'est un octet de statut
+ * - Octets de données sans statut : running status (avec ou sans nouvel
+ *   horodatage)
+ * - SysEx : peut s'étendre sur plusieurs paquets (données juste après
+ *   l'en-tête), fin par horodatage + F7 ; les temps réel intercalés sont
+ *   émis. Le contenu n'est pas transmis (MidiEvent : 2 octets de données),
+ *   seulement compté
+ * - Messages système communs (F1-F6) analysés puis ignorés
+ * - Paquet malformé (en-tête invalide, donnée sans statut, message coupé en
+ *   fin de paquet, horodatage final orphelin) : compté, la partie valide est
+ *   conservée, le message incomplet écarté
+ *
+ * Les événements sont horodatés relativement à la réception : le premier
+ * message du paquet à nowUs, les suivants décalés de l'écart de leurs
+ * horodatages BLE (espacement conservé pour le relais RTP-MIDI).
+ *
+ * Un seul producteur (tâche BLE) ; sans dépendance BLE (testable sur l'hôte).
+ */
+class BleMidiDecoder {
+public:
+    BleMidiDecoder() : status(0), expected(0), received(0), inSysEx(false), high(0), low(0),
+                       firstTime(-1), timeUs(0), messages(0), sysex(0), malformed(0) {}
+
+    // Sink : appelable avec (const MidiEvent&), p. ex. publication sur g_midiBus
+    template<typename Sink>
+    void decode(const uint8_t* packet, size_t length, uint32_t nowUs, uint8_t source, Sink&& sink) {
+        if (length < 2 || !(packet[0] & 0x80) || (packet[0] & 0x40)) {
+            malformed++;
+            return;
+        }
+        high = packet[0] & 0x3F;
+        low = 0;
+        firstTime = -1;
+        timeUs = nowUs;
+        bool afterTimestamp = false;
+        bool stamped = false;
+
+        for (size_t i = 1; i < length; i++) {
+            const uint8_t byte = packet[i];
+            if (byte & 0x80) {
+                if (!afterTimestamp) {
+                    timestamp(byte & 0x7F, stamped, nowUs);
+                    stamped = true;
+                    afterTimestamp = true;
+                    continue;
+                }
+                afterTimestamp = false;
+                handleStatus(byte, source, sink);
+            } else {
+                // Donnée juste après l'en-tête hors SysEx : pas d'horodatage
+                if (!stamped && !inSysEx) {
+                    malformed++;
+                    resetMessage();
+                    return;
+                }
+                afterTimestamp = false;
+                handleData(byte, source, sink);
+            }
+        }
+
+        // Seul un SysEx peut continuer dans le paquet suivant
+        if (afterTimestamp || (!inSysEx && received > 0)) {
+            malformed++;
+            received = 0;
+        }
+    }
+
+    // Nouvelle connexion : état du flux (running status, SysEx) oublié
+    void reset() {
+        resetMessage();
+        inSysEx = false;
+    }
+
+    uint32_t getMessageCount() const { return messages; }
+    uint32_t getSysExCount() const { return sysex; }
+    uint32_t getMalformedCount() const { return malformed; }
+    void resetStats() {
+        messages = 0;
+        sysex = 0;
+        malformed = 0;
+    }
+
+private:
+    void timestamp(uint8_t value, bool stamped, uint32_t nowUs) {
+        if (stamped && value < low) {
+            high = (high + 1) & 0x3F;
+        }
+        low = value;
+        const int32_t ms = (int32_t)((high << 7) | low);
+        if (firstTime < 0) {
+            firstTime = ms;
+        }
+        timeUs = nowUs + (uint32_t)(((ms - firstTime) & 0x1FFF) * 1000);
+    }
+
+    template<typename Sink>
+    void handleStatus(uint8_t byte, uint8_t source, Sink& sink) {
+        if (byte >= 0xF8) {
+            // Temps réel : n'interrompt ni le message en cours ni le SysEx
+            emit(byte, 0, 0, source, sink);
+            return;
+        }
+        if (inSysEx) {
+            inSysEx = false;
+            if (byte == 0xF7) {
+                sysex++;
+                return;
+            }
+            malformed++; // SysEx interrompu par un autre statut
+        } else if (byte == 0xF7) {
+            malformed++;
+            return;
+        }
+        if (received > 0) {
+            malformed++; // Message précédent incomplet
+        }
+        received = 0;
+        if (byte == 0xF0) {
+            inSysEx = true;
+            status = 0;
+            return;
+        }
+        status = byte;
+        expected = dataLength(byte);
+        if (expected == 0) {
+            status = 0; // F6 (et F4/F5 indéfinis) : sans données, ignoré
+        }
+    }
+
+    template<typename Sink>
+    void handleData(uint8_t byte, uint8_t source, Sink& sink) {
+        if (inSysEx) {
+            return;
+        }
+        if (status == 0) {
+            malformed++; // Donnée sans statut
+            return;
+        }
+        data[received++] = byte;
+        if (received < expected) {
+            return;
+        }
+        received = 0;
+        if (status < 0xF0) {
+            emit(status, data[0], expected > 1 ? data[1] : 0, source, sink);
+        } else {
+            status = 0; // Système commun : pas de running status
+        }
+    }
+
+    template<typename Sink>
+    void emit(uint8_t byte, uint8_t data1, uint8_t data2, uint8_t source, Sink& sink) {
+        MidiEvent event = { byte, data1, data2, source, timeUs };
+        messages++;
+        sink(event);
+    }
+
+    void resetMessage() {
+        status = 0;
+        received = 0;
+    }
+
+    // Octets de données d'un statut (hors SysEx et temps réel)
+    static uint8_t dataLength(uint8_t byte) {
+        switch (byte & 0xF0) {
+            case 0xC0:
+            case 0xD0:
+                return 1;
+            case 0xF0:
+                return (byte == 0xF2) ? 2 : (byte == 0xF1 || byte == 0xF3) ? 1 : 0;
+            default:
+                return 2;
+        }
+    }
+
+    uint8_t status;     // Statut courant (running status), 0 = aucun
+    uint8_t expected;   // Octets de données attendus
+    uint8_t received;   // Octets de données reçus
+    uint8_t data[2];
+    bool inSysEx;
+    uint8_t high;       // 6 bits hauts de l'horodatage du paquet
+    uint8_t low;        // 7 bits bas du dernier horodatage
+    int32_t firstTime;  // Premier horodatage du paquet (ms), -1 = aucun
+    uint32_t timeUs;    // Horodatage local du message en cours
+    uint32_t messages;
+    uint32_t sysex;
+    uint32_t malformed;
+};
@@ -0,0 +1,123 @@
+// Calculs de tempo de la clock MIDI (docs/SPEC_CLOCK_MIDI.md)
+#pragma once
+
+#include <stdint.h>
+
+// 24 ticks par noire (MIDI 1.0)
+#define MIDI_CLOCK_PPQN 24
+
+// Plage de tempo, en BPM
+#ifndef MIDI_CLOCK_MIN_BPM
+#define MIDI_CLOCK_MIN_BPM 20
+#endif
+#ifndef MIDI_CLOCK_MAX_BPM
+#define MIDI_CLOCK_MAX_BPM 300
+#endif
+
+// Tap tempo : intervalles moyennés (2 à 4) et fin de série sans tap
+#ifndef TAP_TEMPO_WINDOW
+#define TAP_TEMPO_WINDOW 3
+#endif
+#ifndef TAP_TEMPO_TIMEOUT_MS
+#define TAP_TEMPO_TIMEOUT_MS 3000
+#endif
+
+static_assert(TAP_TEMPO_WINDOW >= 2 && TAP_TEMPO_WINDOW <= 4, "TAP_TEMPO_WINDOW : 2 à 4 intervalles");
+
+// Tempo en centièmes de BPM (12000 = 120 BPM), borné à la plage configurée
+inline uint32_t clampTempo(uint32_t bpmCenti) {
+    if (bpmCenti < MIDI_CLOCK_MIN_BPM * 100) return MIDI_CLOCK_MIN_BPM * 100;
+    if (bpmCenti > MIDI_CLOCK_MAX_BPM * 100) return MIDI_CLOCK_MAX_BPM * 100;
+    return bpmCenti;
+}
+
+/**
+ * @brief Intervalles entre ticks avec report de la partie fractionnaire
+ *
+ * Période d'un tick = 60 000 000 / (24 × BPM) µs, rarement entière
+ * (120 BPM : 20 833,33 µs). next() rend la partie entière et accumule le
+ * reste : sur bpmCenti ticks, la somme vaut exactement 250 000 000 µs,
+ * sans dérive quelle que soit la durée.
+ */
+class MidiTickAccumulator {
+public:
+    static constexpr uint32_t NUMERATOR = (uint32_t)(6000000000ULL / MIDI_CLOCK_PPQN); // µs × centièmes de BPM
+
+    MidiTickAccumulator() { setTempo(12000); }
+
+    void setTempo(uint32_t bpmCenti) {
+        tempo = clampTempo(bpmCenti);
+        whole = NUMERATOR / tempo;
+        fraction = NUMERATOR % tempo;
+        remainder = 0;
+    }
+    uint32_t getTempo() const { return tempo; }
+
+    // Durée jusqu'au tick suivant (µs)
+    uint32_t next() {
+        uint32_t interval = whole;
+        remainder += fraction;
+        if (remainder >= tempo) {
+            remainder -= tempo;
+            interval++;
+        }
+        return interval;
+    }
+    uint32_t period() const { return whole; }
+
+private:
+    uint32_t tempo;     // Centièmes de BPM
+    uint32_t whole;     // Partie entière de la période (µs)
+    uint32_t fraction;  // Reste de la division (unités de 1/tempo µs)
+    uint32_t remainder; // Reste accumulé
+};
+
+/**
+ * @brief Tap tempo : moyenne glissante des derniers intervalles
+ *
+ * Premier tap : mémorisé. À partir du 2e, tap() rend true et getTempo()
+ * donne 60 000 / moyenne des TAP_TEMPO_WINDOW derniers intervalles (moins
+ * au début de la série). Sans tap pendant TAP_TEMPO_TIMEOUT_MS, la série
+ * recommence (le tempo déjà calculé reste en vigueur).
+ */
+class TapTempo {
+public:
+    TapTempo() : count(0), next(0), lastTap(0), tapping(false), tempo(0) {}
+
+    bool tap(uint32_t nowMs) {
+        if (!tapping || nowMs - lastTap > TAP_TEMPO_TIMEOUT_MS) {
+            count = 0;
+            next = 0;
+            tapping = true;
+            lastTap = nowMs;
+            return false;
+        }
+        intervals[next] = nowMs - lastTap;
+        next = (uint8_t)((next + 1) % TAP_TEMPO_WINDOW);
+        if (count < TAP_TEMPO_WINDOW) {
+            count++;
+        }
+        lastTap = nowMs;
+
+        uint32_t total = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            total += intervals[i];
+        }
+        // BPM × 100 = 6 000 000 / intervalle moyen (ms), arrondi
+        tempo = total > 0 ? clampTempo((uint32_t)((6000000ULL * count + total / 2) / total)) : tempo;
+        return total > 0;
+    }
+
+    // Série en cours (dernier tap il y a moins de TAP_TEMPO_TIMEOUT_MS)
+    bool isActive(uint32_t nowMs) const { return tapping && nowMs - lastTap <= TAP_TEMPO_TIMEOUT_MS; }
+    uint32_t getTempo() const { return tempo; } // 0 tant qu'aucun intervalle
+    uint32_t getLastTap() const { return lastTap; }
+
+private:
+    uint32_t intervals[TAP_TEMPO_WINDOW];
+    uint8_t count;
+    uint8_t next;
+    uint32_t lastTap;
+    bool tapping;
+    uint32_t tempo;
+};
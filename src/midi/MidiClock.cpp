@@ -0,0 +1,233 @@
+#include "MidiClock.h"
+#include <Preferences.h>
+
+MidiClock::MidiClock()
+    : sender(nullptr), timer(nullptr), task(nullptr), lock(portMUX_INITIALIZER_UNLOCKED), nextTick(0),
+      pendingTicks(0), pendingTransport(0), tempo(12000), enabled(false), playing(false), ticks(0), lateTicks(0) {
+}
+
+MidiClock::~MidiClock() {
+    if (timer) {
+        esp_timer_stop(timer);
+        esp_timer_delete(timer);
+    }
+    if (task) {
+        vTaskDelete(task);
+    }
+}
+
+void MidiClock::begin(MidiSender* midiSender) {
+    sender = midiSender;
+    
+    Preferences prefs;
+    prefs.begin("esp32server", true);
+    setTempo(prefs.getUInt("clock_bpm", 12000));
+    prefs.end();
+    
+    if (!timer) {
+        esp_timer_create_args_t args = {};
+        args.callback = &MidiClock::onTimer;
+        args.arg = this;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "midi_clock";
+        if (esp_timer_create(&args, &timer) != ESP_OK) {
+            timer = nullptr;
+            Serial.println("[CLOCK] Timer indisponible");
+        }
+    }
+    
+    // Émission hors loop() : réveillée par le timer, elle envoie aux transports
+    if (!task && xTaskCreatePinnedToCore(&MidiClock::taskEntry, "midi_clock", MIDI_CLOCK_TASK_STACK, this,
+                                         MIDI_CLOCK_TASK_PRIORITY, &task, MIDI_CLOCK_TASK_CORE) != pdPASS) {
+        task = nullptr;
+        Serial.println("[CLOCK] Tâche d'émission indisponible, émission depuis le timer");
+    }
+}
+
+void MidiClock::setEnabled(bool on) {
+    if (on == enabled) {
+        return;
+    }
+    if (on) {
+        enabled = true;
+        restart();
+        return;
+    }
+    
+    // OFF : plus aucun tick ; un transport en cours est arrêté
+    portENTER_CRITICAL(&lock);
+    enabled = false;
+    const bool wasPlaying = playing;
+    playing = false;
+    portEXIT_CRITICAL(&lock);
+    if (timer) {
+        esp_timer_stop(timer);
+    }
+    if (wasPlaying) {
+        transport(0xFC);
+    }
+}
+
+void MidiClock::start() {
+    portENTER_CRITICAL(&lock);
+    ticks = 0;
+    playing = true;
+    enabled = true;
+    portEXIT_CRITICAL(&lock);
+    transport(0xFA);
+    restart();
+}
+
+void MidiClock::stop() {
+    portENTER_CRITICAL(&lock);
+    const bool wasPlaying = playing;
+    playing = false;
+    portEXIT_CRITICAL(&lock);
+    if (wasPlaying) {
+        transport(0xFC);
+    }
+}
+
+void MidiClock::resume() {
+    portENTER_CRITICAL(&lock);
+    const bool wasPlaying = playing;
+    playing = true;
+    enabled = true;
+    portEXIT_CRITICAL(&lock);
+    if (wasPlaying) {
+        return;
+    }
+    transport(0xFB);
+    restart();
+}
+
+void MidiClock::setTempo(uint32_t bpmCenti) {
+    // Prise en compte à l'échéance suivante (le tick déjà programmé garde la sienne)
+    portENTER_CRITICAL(&lock);
+    accumulator.setTempo(bpmCenti);
+    tempo = accumulator.getTempo();
+    portEXIT_CRITICAL(&lock);
+}
+
+void MidiClock::tap(uint32_t nowMs) {
+    // Bouton (loop()) et API web (async_tcp) : série de taps et tempo mis à jour ensemble
+    portENTER_CRITICAL(&lock);
+    const bool updated = tapTempo.tap(nowMs);
+    if (updated) {
+        accumulator.setTempo(tapTempo.getTempo());
+        tempo = accumulator.getTempo();
+    }
+    portEXIT_CRITICAL(&lock);
+    if (!updated) {
+        return;
+    }
+    // Phase calée sur le tap : le temps commence maintenant
+    if (enabled) {
+        restart();
+    }
+}
+
+bool MidiClock::isTapActive(uint32_t nowMs) const {
+    portENTER_CRITICAL(&lock);
+    const bool active = tapTempo.isActive(nowMs);
+    portEXIT_CRITICAL(&lock);
+    return active;
+}
+
+void MidiClock::restart() {
+    if (!timer) {
+        return;
+    }
+    esp_timer_stop(timer);
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&lock);
+    nextTick = now;
+    portEXIT_CRITICAL(&lock);
+    schedule(now);
+}
+
+void MidiClock::schedule(int64_t deadline) {
+    const int64_t delay = deadline - esp_timer_get_time();
+    // Déjà armé (contrôle concurrent d'un tick en cours) : l'autre échéance reste valable
+    esp_timer_start_once(timer, delay > 0 ? (uint64_t)delay : 0);
+}
+
+void MidiClock::onTimer(void* arg) {
+    static_cast<MidiClock*>(arg)->tick();
+}
+
+void MidiClock::taskEntry(void* arg) {
+    static_cast<MidiClock*>(arg)->run();
+}
+
+void MidiClock::run() {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        portENTER_CRITICAL(&lock);
+        const uint8_t status = pendingTransport;
+        uint32_t count = pendingTicks;
+        pendingTransport = 0;
+        pendingTicks = 0;
+        portEXIT_CRITICAL(&lock);
+        
+        if (!sender) {
+            continue;
+        }
+        // Transport d'abord : le premier tick après Start suit le 0xFA
+        if (status) {
+            sender->sendRealtimeNow(status);
+        }
+        while (count-- > 0) {
+            sender->sendRealtimeNow(0xF8);
+        }
+    }
+}
+
+void MidiClock::transport(uint8_t status) {
+    if (!sender) {
+        return;
+    }
+    if (!task) {
+        sender->sendRealtimeNow(status);
+        return;
+    }
+    portENTER_CRITICAL(&lock);
+    pendingTransport = status;
+    portEXIT_CRITICAL(&lock);
+    xTaskNotifyGive(task);
+}
+
+void MidiClock::tick() {
+    const int64_t now = esp_timer_get_time();
+    
+    portENTER_CRITICAL(&lock);
+    if (!enabled) {
+        portEXIT_CRITICAL(&lock);
+        return;
+    }
+    const uint32_t interval = accumulator.next();
+    nextTick += interval;
+    // Retard de plus d'une période (tâche bloquée) : pas de rafale, échéances recalées
+    if (nextTick < now) {
+        nextTick = now + interval;
+        lateTicks++;
+    }
+    if (playing) {
+        ticks++;
+    }
+    const int64_t deadline = nextTick;
+    if (task) {
+        pendingTicks++;
+    }
+    portEXIT_CRITICAL(&lock);
+    
+    // Réarmé avant l'émission : l'envoi ne décale pas l'échéance suivante
+    schedule(deadline);
+    if (task) {
+        xTaskNotifyGive(task);
+    } else if (sender) {
+        sender->sendRealtimeNow(0xF8);
+    }
+}
+
+MidiClock g_midiClock;
@@ -0,0 +1,101 @@
+// Générateur de MIDI Clock sur timer matériel (docs/SPEC_CLOCK_MIDI.md)
+#pragma once
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "MidiSender.h"
+#include "ClockTiming.h"
+
+// Tâche d'émission des ticks : au-dessus de loop() et de l'envoi OSC, sur le cœur
+// libre (mono-cœur compris)
+#ifndef MIDI_CLOCK_TASK_CORE
+#define MIDI_CLOCK_TASK_CORE tskNO_AFFINITY
+#endif
+#ifndef MIDI_CLOCK_TASK_PRIORITY
+#define MIDI_CLOCK_TASK_PRIORITY 5
+#endif
+#ifndef MIDI_CLOCK_TASK_STACK
+#define MIDI_CLOCK_TASK_STACK 4096
+#endif
+
+/**
+ * @brief Clock MIDI 24 PPQN cadencée par esp_timer
+ *
+ * Chaque tick est émis depuis le callback d'un timer one-shot réarmé sur
+ * l'échéance suivante, calculée en absolu (MidiTickAccumulator : partie
+ * fractionnaire reportée) : ni la durée de loop() ni la latence du callback
+ * ne s'accumulent. Le callback ne fait que réarmer le timer et réveiller la
+ * tâche « midi_clock » (MIDI_CLOCK_TASK_PRIORITY) qui émet le tick par
+ * MidiSender::sendRealtimeNow() : MidiRouter l'envoie directement aux
+ * transports (paquet RTP-MIDI, notification BLE, datagramme OSC), sans passer
+ * par g_midiBus ni attendre loop(). Start/Stop/Continue prennent le même
+ * chemin, dans l'ordre, avant les ticks en attente. Sans tâche (création
+ * impossible), émission directe depuis l'appelant.
+ *
+ * - Toggle (bouton « Clock », API) : ticks émis ou non
+ * - Start / Continue : message de transport puis ticks, le premier tick
+ *   suit immédiatement (temps 1) ; Stop : message de transport, les ticks
+ *   continuent tant que la clock est active (récepteurs calés)
+ * - Tap tempo (bouton « Tap Tempo ») : tempo = moyenne glissante des derniers
+ *   intervalles ; clock active : la phase est recalée sur le tap
+ *
+ * Contrôle depuis loop() ou le serveur web, ticks depuis la tâche esp_timer :
+ * l'état partagé est protégé par un spinlock.
+ */
+class MidiClock {
+public:
+    MidiClock();
+    ~MidiClock();
+
+    // Tempo initial : NVS "clock_bpm" (centièmes de BPM, 120 par défaut)
+    void begin(MidiSender* sender);
+
+    // Ticks (toggle ON/OFF de la spécification)
+    void setEnabled(bool enabled);
+    void toggle() { setEnabled(!isEnabled()); }
+    bool isEnabled() const { return enabled; }
+
+    // Transport (Start/Stop/Continue via MidiSender)
+    void start();
+    void stop();
+    void resume(); // MIDI Continue
+    bool isPlaying() const { return playing; }
+
+    // Tempo en centièmes de BPM, borné à MIDI_CLOCK_MIN_BPM..MIDI_CLOCK_MAX_BPM
+    void setTempo(uint32_t bpmCenti);
+    uint32_t getTempo() const { return tempo; }
+    void tap(uint32_t nowMs);
+    bool isTapActive(uint32_t nowMs) const;
+
+    // Statistiques
+    uint32_t getTickCount() const { return ticks; }         // Ticks depuis Start (position)
+    uint32_t getLateCount() const { return lateTicks; }     // Échéances manquées (recalées)
+
+private:
+    static void onTimer(void* arg);
+    static void taskEntry(void* arg);
+    void run();
+    void tick();
+    void transport(uint8_t status); // Start/Stop/Continue vers la tâche
+    void restart(); // Premier tick immédiat, échéances recalées sur maintenant
+    void schedule(int64_t deadline);
+
+    MidiSender* sender;
+    esp_timer_handle_t timer;
+    TaskHandle_t task;
+    mutable portMUX_TYPE lock;
+    MidiTickAccumulator accumulator;
+    TapTempo tapTempo;
+    int64_t nextTick;           // Échéance du prochain tick (esp_timer_get_time, µs)
+    uint32_t pendingTicks;      // Ticks à émettre par la tâche
+    uint8_t pendingTransport;   // Start/Stop/Continue à émettre (le dernier l'emporte), 0 : aucun
+    volatile uint32_t tempo;    // Centièmes de BPM
+    volatile bool enabled;
+    volatile bool playing;
+    volatile uint32_t ticks;
+    volatile uint32_t lateTicks;
+};
+
+extern MidiClock g_midiClock;
@@ -0,0 +1,69 @@
+// Filtre des doublons et échos MIDI entre transports
+#pragma once
+
+#include <stdint.h>
+#include "messages.h"
+
+#ifndef MIDI_ECHO_WINDOW_US
+#define MIDI_ECHO_WINDOW_US 20000
+#endif
+
+/**
+ * @brief Mémoire courte des derniers messages vus par MidiRouter
+ *
+ * Un même message (statut + données) qui revient par un autre transport
+ * dans la fenêtre est un doublon : copie reçue par RTP-MIDI et BLE d'un
+ * même hôte, ou écho d'un envoi local renvoyé par un hôte (MIDI thru,
+ * broadcast OSC reçu sur notre propre port). Les répétitions par le même
+ * transport restent légitimes (note rejouée), les messages temps réel
+ * (Clock, Start...) ne sont jamais filtrés.
+ *
+ * Utilisée uniquement depuis MidiRouter::update() (pas de verrou).
+ */
+class MidiEchoFilter {
+public:
+    static constexpr uint8_t SIZE = 16;
+
+    MidiEchoFilter() : next(0) {
+        for (uint8_t i = 0; i < SIZE; i++) {
+            entries[i].used = false;
+        }
+    }
+
+    // Message vu (émis localement ou accepté en entrée)
+    void record(const MidiEvent& event, uint32_t now) {
+        if (event.isRealtime()) {
+            return;
+        }
+        Entry& entry = entries[next];
+        entry.event = event;
+        entry.time = now;
+        entry.used = true;
+        next = (uint8_t)((next + 1) % SIZE);
+    }
+
+    // Message entrant déjà vu par un autre transport (ou émis par nous) dans la fenêtre ?
+    bool isDuplicate(const MidiEvent& event, uint32_t now) const {
+        if (event.isRealtime()) {
+            return false;
+        }
+        for (uint8_t i = 0; i < SIZE; i++) {
+            const Entry& entry = entries[i];
+            if (entry.used && (uint32_t)(now - entry.time) < MIDI_ECHO_WINDOW_US &&
+                entry.event.sameMessage(event) && entry.event.origin() != event.origin()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Entry {
+        MidiEvent event;
+        uint32_t time;
+        bool used;
+    };
+
+    Entry entries[SIZE];
+    uint8_t next;
+};
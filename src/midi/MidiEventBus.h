@@ -0,0 +1,111 @@
+// Bus d'événements MIDI : sources multiples, un consommateur (MidiRouter)
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "messages.h"
+
+#ifndef MIDI_EVENT_BUS_SIZE
+#define MIDI_EVENT_BUS_SIZE 128
+#endif
+
+/**
+ * @brief File MPSC bornée sans verrou pour les MidiEvent
+ *
+ * Les sources publient depuis leur propre contexte : composants et OSC
+ * (loop()), RTP-MIDI (MIDI.read() dans loop()), BLE (tâche de la pile BLE),
+ * handlers web (tâche async_tcp). MidiRouter::update() draine des lots
+ * dans un tableau contigu et route chaque événement dans une boucle serrée.
+ *
+ * - Chaque case porte un numéro de séquence (file bornée de Vyukov) :
+ *   un producteur réserve sa case par CAS sur enqueuePos, l'écrit, puis
+ *   la publie ; le consommateur n'avance que sur des cases publiées
+ * - File pleine : l'événement est refusé et compté (jamais d'attente)
+ */
+template <uint16_t N>
+class MidiEventBusT {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MidiEventBus: N doit être une puissance de 2");
+
+public:
+    MidiEventBusT() : enqueuePos(0), dequeuePos(0), published(0), dropped(0), highWater(0) {
+        for (uint32_t i = 0; i < N; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Producteurs (tout contexte hors ISR) : false si la file est pleine
+    bool publish(const MidiEvent& event) {
+        uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & MASK];
+            const uint32_t seq = cell->sequence.load(std::memory_order_acquire);
+            const int32_t diff = (int32_t)(seq - pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->event = event;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        published.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consommateur unique : copie jusqu'à max événements dans out, dans l'ordre de publication
+    size_t drain(MidiEvent* out, size_t max) {
+        const uint32_t depth = enqueuePos.load(std::memory_order_relaxed) - dequeuePos;
+        if (depth > highWater) {
+            highWater = (uint16_t)depth;
+        }
+        size_t count = 0;
+        while (count < max) {
+            Cell& cell = cells[dequeuePos & MASK];
+            const uint32_t seq = cell.sequence.load(std::memory_order_acquire);
+            if ((int32_t)(seq - (dequeuePos + 1)) < 0) {
+                break; // Vide, ou case réservée pas encore publiée
+            }
+            out[count++] = cell.event;
+            cell.sequence.store(dequeuePos + N, std::memory_order_release);
+            dequeuePos++;
+        }
+        return count;
+    }
+
+    uint32_t getPublishedCount() const { return published.load(std::memory_order_relaxed); }
+    uint32_t getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+    uint16_t getHighWater() const { return highWater; } // Profondeur maximale observée
+    void resetStats() {
+        published.store(0, std::memory_order_relaxed);
+        dropped.store(0, std::memory_order_relaxed);
+        highWater = 0;
+    }
+    static constexpr uint16_t capacity() { return N; }
+
+private:
+    static constexpr uint32_t MASK = N - 1;
+
+    struct Cell {
+        std::atomic<uint32_t> sequence;
+        MidiEvent event;
+    };
+
+    Cell cells[N];
+    std::atomic<uint32_t> enqueuePos; // Réservé par CAS (producteurs)
+    uint32_t dequeuePos;              // Consommateur uniquement
+    std::atomic<uint32_t> published;
+    std::atomic<uint32_t> dropped;
+    uint16_t highWater;
+};
+
+typedef MidiEventBusT<MIDI_EVENT_BUS_SIZE> MidiEventBus;
+
+// Instance globale (définie avec MidiRouter, son unique consommateur)
+extern MidiEventBus g_midiBus;
@@ -0,0 +1,53 @@
+// Diffusion MIDI résolue à la compilation vers les transports compilés
+#pragma once
+
+#include <stdint.h>
+#include "messages.h"
+
+// Bits d'activation à l'exécution (MidiRouter::setTransportMask)
+enum MidiTransportBit : uint8_t {
+    MIDI_TRANSPORT_RTP = 0x01,
+    MIDI_TRANSPORT_BLE = 0x02,
+    MIDI_TRANSPORT_OSC = 0x04
+};
+
+/**
+ * @brief Diffusion d'un MidiEvent vers une liste de transports fixée à la compilation
+ *
+ * Chaque transport est une politique sans état :
+ *   struct X { static constexpr uint8_t BIT = MIDI_TRANSPORT_...; static void send(const MidiEvent&);
+ *              static void sendNow(const MidiEvent&); };
+ * send() : depuis loop(), regroupement du transport ; sendNow() : depuis une autre
+ * tâche (clock), émis immédiatement sous le verrou du transport.
+ * MidiFanOut<A, B>::send() se déplie en « if (enabled & A::BIT) A::send(e); if (enabled & B::BIT) ... »
+ * sans appel virtuel ; un transport absent de la liste ne génère aucun code.
+ * MASK réunit les bits des transports compilés.
+ */
+template <typename... Transports>
+struct MidiFanOut;
+
+template <>
+struct MidiFanOut<> {
+    static constexpr uint8_t MASK = 0;
+    static inline void send(const MidiEvent&, uint8_t) {}
+    static inline void sendNow(const MidiEvent&, uint8_t) {}
+};
+
+template <typename First, typename... Rest>
+struct MidiFanOut<First, Rest...> {
+    static constexpr uint8_t MASK = First::BIT | MidiFanOut<Rest...>::MASK;
+
+    static inline __attribute__((always_inline)) void send(const MidiEvent& event, uint8_t enabled) {
+        if (enabled & First::BIT) {
+            First::send(event);
+        }
+        MidiFanOut<Rest...>::send(event, enabled);
+    }
+
+    static inline __attribute__((always_inline)) void sendNow(const MidiEvent& event, uint8_t enabled) {
+        if (enabled & First::BIT) {
+            First::sendNow(event);
+        }
+        MidiFanOut<Rest...>::sendNow(event, enabled);
+    }
+};
@@ -1,5 +1,6 @@
 #include "MidiRouter.h"
 #include <Arduino.h>
+#include <Preferences.h>
 
 // Dépendances vers le serveur core
 #include "../ServerCore.h"
@@ -7,136 +8,232 @@
 
 extern ServerCore serverCore;
 
+// Bus d'événements MIDI (consommé uniquement par MidiRouter::update)
+MidiEventBus g_midiBus;
+
+namespace {
+
+// Politiques de transport (cf. MidiFanOut) : un switch par type, appels directs
+
+struct RtpMidiTransport {
+    static constexpr uint8_t BIT = MIDI_TRANSPORT_RTP;
+    // Regroupé par RtpMidi ; l'horodatage de publication donne les delta times
+    static inline void send(const MidiEvent& event) {
+        serverCore.rtpMidi().send(event);
+    }
+    static inline void sendNow(const MidiEvent& event) {
+        serverCore.rtpMidi().sendNow(event);
+    }
+};
+
+#ifdef ESP32SERVER_ENABLE_BLE_MIDI
+struct BleMidiTransport {
+    static constexpr uint8_t BIT = MIDI_TRANSPORT_BLE;
+    // Encodé et regroupé par BluetoothManager (une notification par intervalle)
+    static inline void send(const MidiEvent& event) {
+        serverCore.bluetooth().send(event);
+    }
+    static inline void sendNow(const MidiEvent& event) {
+        serverCore.bluetooth().sendNow(event);
+    }
+};
+#endif
+
+#ifdef ESP32SERVER_ENABLE_OSC_ROUTER
+struct OscMidiTransport {
+    static constexpr uint8_t BIT = MIDI_TRANSPORT_OSC;
+    // "/midi ,m" (port 0, statut, données) vers les destinations acceptant le format midi ;
+    // depuis loop() sans attente : écarté si la tâche d'envoi OSC tient le socket
+    static inline void send(const MidiEvent& event) {
+        emit(event, false);
+    }
+    // Tâche de la clock : attend le socket plutôt que de perdre le tick
+    static inline void sendNow(const MidiEvent& event) {
+        emit(event, true);
+    }
+    static inline void emit(const MidiEvent& event, bool fromTask) {
+        extern ComponentManager g_componentManager;
+        uint8_t packet[16];
+        OSCWriter writer(packet, sizeof(packet));
+        writer.address(OSC_MIDI_ADDRESS);
+        // Événement relayé par le pont : nombre de relais en second argument, lu par
+        // l'appareil suivant (RTP-MIDI et BLE-MIDI n'ont pas de place pour lui : remis à 0)
+        writer.typeTags(event.hops() > 0 ? ",mi" : ",m");
+        writer.uint32(((uint32_t)event.status << 16) | ((uint32_t)event.data1 << 8) | event.data2);
+        if (event.hops() > 0) {
+            writer.int32(event.hops());
+        }
+        if (writer.ok()) {
+            g_componentManager.getOSCTransport().send(packet, writer.length(), OSC_FORMAT_MIDI, 1, 0, fromTask);
+        }
+    }
+};
+#endif
+
+// Transports compilés : la diffusion est dépliée à la compilation
+typedef MidiFanOut<
+    RtpMidiTransport
+#ifdef ESP32SERVER_ENABLE_BLE_MIDI
+    , BleMidiTransport
+#endif
+#ifdef ESP32SERVER_ENABLE_OSC_ROUTER
+    , OscMidiTransport
+#endif
+> CompiledFanOut;
+
+} // namespace
+
 MidiRouter::MidiRouter()
-    : rtpEnabled(true), oscEnabled(true), bluetoothEnabled(true), oscToSta(true), oscPort(8000), defaultChannel(1) {}
+    : configWatcher(1 << CONFIG_DOMAIN_MIDI), enabledTransports(CompiledFanOut::MASK),
+      bridgeEnabled(false), duplicateCount(0), relayedCount(0), hopLimitCount(0), oscToSta(true), oscPort(8000), defaultChannel(1) {}
 
 MidiRouter::~MidiRouter() {}
 
 void MidiRouter::begin() {
-    // Rien ici: on s'appuie sur esp32Server pour RTP/OSC
+    // On s'appuie sur esp32Server pour RTP/OSC ; seul l'état d'activation est en NVS
+    loadConfig();
+}
+
+void MidiRouter::pollConfig() {
+    if (configWatcher.poll()) {
+        loadConfig();
+    }
+}
+
+void MidiRouter::loadConfig() {
+    Preferences prefs;
+    prefs.begin("esp32server", true);
+    // Absent : RTP actif (comportement historique du routeur)
+    setTransport(MIDI_TRANSPORT_RTP, prefs.getBool("rtp_enabled", true));
+    // Absent : entrées vers le retour LED seulement, sans relais (comportement historique)
+    bridgeEnabled = prefs.getBool("midi_bridge", false);
+    prefs.end();
 }
 
 void MidiRouter::update() {
-    // Mise à jour RTP si nécessaire
-    serverCore.rtpMidi().update();
+    // Lots bornés à la capacité du bus : les publications concurrentes (BLE, web)
+    // attendent le cycle suivant
+    MidiEvent batch[BATCH_SIZE];
+    size_t remaining = g_midiBus.capacity();
+    while (remaining > 0) {
+        const size_t count = g_midiBus.drain(batch, remaining < BATCH_SIZE ? remaining : BATCH_SIZE);
+        if (count == 0) {
+            break;
+        }
+        for (size_t i = 0; i < count; i++) {
+            route(batch[i]);
+        }
+        remaining -= count;
+    }
 }
 
-void MidiRouter::sendNoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
-    const uint8_t ch = channel ? channel : defaultChannel;
-    if (rtpEnabled) {
-        serverCore.rtpMidi().sendNoteOn(ch, note, velocity);
+void MidiRouter::route(const MidiEvent& event) {
+    const uint8_t origin = event.origin();
+    if (origin == MIDI_SOURCE_LOCAL) {
+        // Mémorisé : un hôte qui renverrait ce message (thru) sera reconnu
+        echoFilter.record(event, event.timestamp);
+        CompiledFanOut::send(event, enabledTransports);
+        return;
     }
-    if (bluetoothEnabled) {
-        serverCore.bluetooth().sendNoteOn(ch, note, velocity);
+    
+    // Même message déjà reçu par un autre transport, ou écho d'un envoi local
+    if (echoFilter.isDuplicate(event, event.timestamp)) {
+        duplicateCount++;
+        return;
     }
-    // Optionnel: route OSC si disponible côté serveur
-    // Activez avec -DESP32SERVER_ENABLE_OSC_ROUTER et implémentez les wrappers dans Esp32Server
-    #ifdef ESP32SERVER_ENABLE_OSC_ROUTER
-    if (oscEnabled) {
-        serverCore.sendOscNote(ch, note, velocity, oscToSta, oscPort);
+    echoFilter.record(event, event.timestamp);
+    
+    // Retour LED
+    switch (event.type()) {
+        case 0x90:
+            if (event.data2 > 0) {
+                handleMidiNoteOn(event.channel(), event.data1, event.data2);
+            } else {
+                handleMidiNoteOff(event.channel(), event.data1, 0);
+            }
+            break;
+        case 0x80:
+            handleMidiNoteOff(event.channel(), event.data1, event.data2);
+            break;
+        case 0xB0:
+            handleMidiControlChange(event.channel(), event.data1, event.data2);
+            break;
+        default:
+            break;
     }
-    #endif
-}
-
-void MidiRouter::sendNoteOff(uint8_t channel, uint8_t note, uint8_t velocity) {
-    const uint8_t ch = channel ? channel : defaultChannel;
-    if (rtpEnabled) {
-        serverCore.rtpMidi().sendNoteOff(ch, note, velocity);
+    
+    // Pont : jamais vers le transport d'origine, nombre de relais borné
+    if (!bridgeEnabled) {
+        return;
     }
-    if (bluetoothEnabled) {
-        serverCore.bluetooth().sendNoteOff(ch, note, velocity);
+    if (event.hops() >= MIDI_MAX_HOPS) {
+        hopLimitCount++;
+        return;
     }
-    #ifdef ESP32SERVER_ENABLE_OSC_ROUTER
-    if (oscEnabled) {
-        serverCore.sendOscNoteOff(ch, note, velocity, oscToSta, oscPort);
+    static const uint8_t originTransport[MIDI_SOURCE_COUNT] = {
+        0, MIDI_TRANSPORT_RTP, MIDI_TRANSPORT_BLE, MIDI_TRANSPORT_OSC
+    };
+    const uint8_t targets = enabledTransports & (uint8_t)~(origin < MIDI_SOURCE_COUNT ? originTransport[origin] : 0);
+    if (targets != 0) {
+        CompiledFanOut::send(event.relayed(), targets);
+        relayedCount++;
     }
-    #endif
+}
+
+void MidiRouter::sendNoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
+    publish(MidiEvent::noteOn(channel ? channel : defaultChannel, note, velocity));
+}
+
+void MidiRouter::sendNoteOff(uint8_t channel, uint8_t note, uint8_t velocity) {
+    publish(MidiEvent::noteOff(channel ? channel : defaultChannel, note, velocity));
 }
 
 void MidiRouter::sendControlChange(uint8_t channel, uint8_t control, uint8_t value) {
-    const uint8_t ch = channel ? channel : defaultChannel;
-    if (rtpEnabled) {
-        serverCore.rtpMidi().sendControlChange(ch, control, value);
-    }
-    if (bluetoothEnabled) {
-        serverCore.bluetooth().sendControlChange(ch, control, value);
-    }
-    #ifdef ESP32SERVER_ENABLE_OSC_ROUTER
-    if (oscEnabled) {
-        serverCore.sendOscCC(ch, control, value, oscToSta, oscPort);
-    }
-    #endif
+    publish(MidiEvent::controlChange(channel ? channel : defaultChannel, control, value));
 }
 
 void MidiRouter::sendProgramChange(uint8_t channel, uint8_t program) {
-    const uint8_t ch = channel ? channel : defaultChannel;
-    if (rtpEnabled) {
-        serverCore.rtpMidi().sendProgramChange(ch, program);
-    }
-    if (bluetoothEnabled) {
-        serverCore.bluetooth().sendProgramChange(ch, program);
-    }
+    publish(MidiEvent::programChange(channel ? channel : defaultChannel, program));
 }
 
 void MidiRouter::sendPitchBend(uint8_t channel, int bend) {
-    const uint8_t ch = channel ? channel : defaultChannel;
-    if (rtpEnabled) {
-        serverCore.rtpMidi().sendPitchBend(ch, bend);
-    }
-    if (bluetoothEnabled) {
-        serverCore.bluetooth().sendPitchBend(ch, bend);
-    }
+    publish(MidiEvent::pitchBend(channel ? channel : defaultChannel, bend));
 }
 
 void MidiRouter::sendAftertouch(uint8_t channel, uint8_t pressure) {
-    const uint8_t ch = channel ? channel : defaultChannel;
-    if (rtpEnabled) {
-        serverCore.rtpMidi().sendAftertouch(ch, pressure);
-    }
-    if (bluetoothEnabled) {
-        // BluetoothManager n'a pas sendAftertouch, on peut l'ignorer ou l'implémenter plus tard
-    }
+    publish(MidiEvent::aftertouch(channel ? channel : defaultChannel, pressure));
 }
 
 void MidiRouter::sendClock() {
-    if (rtpEnabled) {
-        serverCore.rtpMidi().sendClock();
-    }
-    if (bluetoothEnabled) {
-        // BluetoothManager n'a pas sendClock, on peut l'ignorer ou l'implémenter plus tard
-    }
+    publish(MidiEvent::realtime(0xF8));
 }
 
 void MidiRouter::sendStart() {
-    if (rtpEnabled) {
-        serverCore.rtpMidi().sendStart();
-    }
-    if (bluetoothEnabled) {
-        // BluetoothManager n'a pas sendStart, on peut l'ignorer ou l'implémenter plus tard
-    }
+    publish(MidiEvent::realtime(0xFA));
 }
 
 void MidiRouter::sendStop() {
-    if (rtpEnabled) {
-        serverCore.rtpMidi().sendStop();
-    }
-    if (bluetoothEnabled) {
-        // BluetoothManager n'a pas sendStop, on peut l'ignorer ou l'implémenter plus tard
-    }
+    publish(MidiEvent::realtime(0xFC));
 }
 
 void MidiRouter::sendContinue() {
-    if (rtpEnabled) {
-        serverCore.rtpMidi().sendContinue();
-    }
-    if (bluetoothEnabled) {
-        // BluetoothManager n'a pas sendContinue, on peut l'ignorer ou l'implémenter plus tard
-    }
+    publish(MidiEvent::realtime(0xFB));
+}
+
+void MidiRouter::sendRealtimeNow(uint8_t status) {
+    // Temps réel : un hôte ne le renvoie pas, rien à mémoriser dans echoFilter
+    CompiledFanOut::sendNow(MidiEvent::realtime(status), enabledTransports);
 }
 
-void MidiRouter::enableRtpMidi(bool enabled) { rtpEnabled = enabled; }
-void MidiRouter::enableOsc(bool enabled) { oscEnabled = enabled; }
-void MidiRouter::enableBluetooth(bool enabled) { bluetoothEnabled = enabled; }
+void MidiRouter::enableRtpMidi(bool enabled) { setTransport(MIDI_TRANSPORT_RTP, enabled); }
+void MidiRouter::enableOsc(bool enabled) { setTransport(MIDI_TRANSPORT_OSC, enabled); }
+void MidiRouter::enableBluetooth(bool enabled) { setTransport(MIDI_TRANSPORT_BLE, enabled); }
+void MidiRouter::setTransportMask(uint8_t mask) { enabledTransports = mask & CompiledFanOut::MASK; }
+uint8_t MidiRouter::getCompiledTransports() { return CompiledFanOut::MASK; }
+
+void MidiRouter::setTransport(uint8_t bit, bool enabled) {
+    setTransportMask(enabled ? (enabledTransports | bit) : (enabledTransports & ~bit));
+}
 void MidiRouter::setOscTargetSta(bool sta) { oscToSta = sta; }
 void MidiRouter::setOscPort(uint16_t port) { oscPort = port; }
 void MidiRouter::setMidiChannel(uint8_t channel) { defaultChannel = channel; }
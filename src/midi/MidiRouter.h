@@ -3,14 +3,41 @@
 
 #include <Arduino.h>
 #include "MidiSender.h"
+#include "MidiEventBus.h"
+#include "MidiFanOut.h"
+#include "MidiEchoFilter.h"
+#include "../ConfigEpoch.h"
 
+/**
+ * @brief Routeur MIDI : unique consommateur du bus d'événements
+ *
+ * Les send*() publient un MidiEvent (source locale) sur g_midiBus ; les
+ * transports entrants (RTP-MIDI, OSC, BLE) y publient avec leur source.
+ * update() draine le bus par lots et route chaque événement :
+ * - source locale : vers les transports sortants activés
+ * - source externe : vers ComponentManager (retour LED), doublons et échos
+ *   écartés (MidiEchoFilter) ; avec le pont activé, relayé vers les autres
+ *   transports, jamais vers celui d'origine, tant que hops() < MIDI_MAX_HOPS
+ *   (le nombre de relais ne traverse le réseau que par OSC, "/midi ,mi" ;
+ *   RTP-MIDI et BLE-MIDI le remettent à 0, seul le filtre d'écho les borne)
+ *
+ * Les transports sortants sont fixés à la compilation (MidiFanOut : RTP-MIDI,
+ * plus BLE avec ESP32SERVER_ENABLE_BLE_MIDI et OSC avec ESP32SERVER_ENABLE_OSC_ROUTER) ;
+ * l'activation à l'exécution n'est qu'un masque de bits MidiTransportBit.
+ */
 class MidiRouter : public MidiSender {
 public:
+    static constexpr uint8_t BATCH_SIZE = 32;
+
     MidiRouter();
     ~MidiRouter() override;
 
     void begin() override;
+    // loop() après les composants : draine le bus et route les événements
     void update() override;
+    
+    // Relit la configuration NVS seulement si l'époque MIDI a avancé
+    void pollConfig();
 
     void sendNoteOn(uint8_t channel, uint8_t note, uint8_t velocity) override;
     void sendNoteOff(uint8_t channel, uint8_t note, uint8_t velocity) override;
@@ -24,25 +51,50 @@ public:
     void sendStart() override;
     void sendStop() override;
     void sendContinue() override;
+    // Tâche de la clock : directement vers les transports, sans bus ni filtre d'écho
+    void sendRealtimeNow(uint8_t status) override;
 
     void enableRtpMidi(bool enabled);
     void enableOsc(bool enabled);
     void enableBluetooth(bool enabled);
+    // Masque MidiTransportBit (les transports non compilés sont ignorés)
+    void setTransportMask(uint8_t mask);
+    uint8_t getTransportMask() const { return enabledTransports; }
+    static uint8_t getCompiledTransports();
 
+    // Historique : la sortie OSC suit les destinations de OSCTransport (format midi)
     void setOscTargetSta(bool sta);
     void setOscPort(uint16_t port);
 
     void setMidiChannel(uint8_t channel); // défaut 1
     
+    // Pont entre transports (NVS "midi_bridge", désactivé par défaut)
+    void setBridge(bool enabled) { bridgeEnabled = enabled; }
+    bool isBridgeEnabled() const { return bridgeEnabled; }
+    
+    // Statistiques de routage (entrées écartées, relais)
+    uint32_t getDuplicateCount() const { return duplicateCount; }
+    uint32_t getRelayedCount() const { return relayedCount; }
+    uint32_t getHopLimitCount() const { return hopLimitCount; }
+    
     // Réception MIDI pour piloter les LEDs
     void handleMidiNoteOn(uint8_t channel, uint8_t note, uint8_t velocity);
     void handleMidiNoteOff(uint8_t channel, uint8_t note, uint8_t velocity);
     void handleMidiControlChange(uint8_t channel, uint8_t control, uint8_t value);
 
 private:
-    bool rtpEnabled;
-    bool oscEnabled;
-    bool bluetoothEnabled;
+    void loadConfig();
+    void route(const MidiEvent& event);
+    void publish(const MidiEvent& event) { g_midiBus.publish(event); }
+    void setTransport(uint8_t bit, bool enabled);
+    
+    ConfigWatcher configWatcher;
+    uint8_t enabledTransports; // MidiTransportBit, restreint aux transports compilés
+    bool bridgeEnabled;
+    MidiEchoFilter echoFilter;
+    uint32_t duplicateCount;   // Doublons/échos écartés en entrée
+    uint32_t relayedCount;     // Événements relayés par le pont
+    uint32_t hopLimitCount;    // Relais refusés (MIDI_MAX_HOPS atteint)
     bool oscToSta;
     uint16_t oscPort;
     uint8_t defaultChannel;
@@ -23,6 +23,18 @@ public:
     virtual void sendStart() = 0;      // MIDI Start
     virtual void sendStop() = 0;       // MIDI Stop
     virtual void sendContinue() = 0;   // MIDI Continue
+
+    // Temps réel (0xF8-0xFC) émis tout de suite vers les transports, sans attendre
+    // loop() (tâche de la clock) ; par défaut, même chemin que les autres messages
+    virtual void sendRealtimeNow(uint8_t status) {
+        switch (status) {
+            case 0xF8: sendClock(); break;
+            case 0xFA: sendStart(); break;
+            case 0xFB: sendContinue(); break;
+            case 0xFC: sendStop(); break;
+            default: break;
+        }
+    }
 };
 
 
@@ -0,0 +1,148 @@
+// Regroupement des envois RTP-MIDI : une liste de commandes par cycle
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "messages.h"
+
+// Événements en attente entre deux cycles
+#ifndef RTP_MIDI_BATCH_EVENTS
+#define RTP_MIDI_BATCH_EVENTS 64
+#endif
+
+// Octets par liste : sous le tampon de sortie de la session AppleMIDI (64 par défaut)
+#ifndef RTP_MIDI_BATCH_BYTES
+#define RTP_MIDI_BATCH_BYTES 60
+#endif
+
+// Horloge des horodatages RTP de la session (AppleMIDI : 10 kHz)
+#ifndef RTP_MIDI_CLOCK_HZ
+#define RTP_MIDI_CLOCK_HZ 10000
+#endif
+
+// Fenêtre de regroupement (µs) : une liste au plus par fenêtre, quelle que soit
+// la vitesse de loop() ; les delta times conservent l'écart entre événements
+#ifndef RTP_MIDI_FLUSH_US
+#define RTP_MIDI_FLUSH_US 1000
+#endif
+
+/**
+ * @brief File des événements RTP-MIDI d'un cycle et encodeur de liste de commandes
+ *
+ * add() accumule les événements émis pendant un cycle de loop() ; take()
+ * les encode en une liste de commandes MIDI RFC 6295 (§3) :
+ * - la première commande sans delta time, les suivantes précédées de leur
+ *   delta (octets de 7 bits, bit haut = suite) en ticks de RTP_MIDI_CLOCK_HZ
+ * - running status : l'octet de statut est omis s'il répète celui de la
+ *   commande canal précédente (jamais pour la première commande canal) ;
+ *   les messages temps réel ne l'interrompent pas
+ * Les événements qui ne tiennent pas dans capacity restent pour le cycle suivant.
+ * Les deltas sont comptés depuis l'instant déjà encodé (pas d'erreur de
+ * troncature cumulée sur la liste) ; ready() décide quand émettre.
+ *
+ * Sans dépendance Arduino hors messages.h (testable sur l'hôte).
+ */
+class RtpMidiBatch {
+public:
+    RtpMidiBatch() : count(0), overflow(0) {}
+
+    // false si la file est pleine (événement écarté et compté)
+    bool add(const MidiEvent& event) {
+        if (count >= RTP_MIDI_BATCH_EVENTS) {
+            overflow++;
+            return false;
+        }
+        events[count++] = event;
+        return true;
+    }
+
+    bool empty() const { return count == 0; }
+    uint16_t size() const { return count; }
+    uint32_t getOverflowCount() const { return overflow; }
+    void clear() { count = 0; }
+
+    // Liste à émettre : l'événement le plus ancien attend depuis windowUs,
+    // ou la file remplit déjà une liste (commandes de 3 octets)
+    bool ready(uint32_t now, uint32_t windowUs) const {
+        if (count == 0) {
+            return false;
+        }
+        return count >= RTP_MIDI_BATCH_BYTES / 3 || (uint32_t)(now - events[0].timestamp) >= windowUs;
+    }
+
+    // Encode dans out autant d'événements que possible et les retire de la file.
+    // Retourne la taille de la liste ; commands = nombre d'événements encodés.
+    size_t take(uint8_t* out, size_t capacity, uint16_t& commands) {
+        size_t pos = 0;
+        uint8_t runningStatus = 0;
+        // Instant représenté par les deltas déjà écrits (multiple du tick depuis la première commande)
+        uint32_t encodedTime = count > 0 ? events[0].timestamp : 0;
+        const uint32_t tickUs = 1000000 / RTP_MIDI_CLOCK_HZ;
+        commands = 0;
+        while (commands < count) {
+            const MidiEvent& event = events[commands];
+            uint8_t command[8];
+            size_t length = 0;
+            uint32_t ticks = 0;
+            if (commands > 0) {
+                const uint32_t elapsed = (int32_t)(event.timestamp - encodedTime) > 0 ? event.timestamp - encodedTime : 0;
+                ticks = elapsed / tickUs;
+                length = encodeDelta(ticks, command);
+            }
+            if (event.isRealtime()) {
+                command[length++] = event.status;
+            } else {
+                if (event.status != runningStatus) {
+                    command[length++] = event.status;
+                }
+                command[length++] = event.data1;
+                if (dataLength(event.status) > 1) {
+                    command[length++] = event.data2;
+                }
+            }
+            if (pos + length > capacity) {
+                break;
+            }
+            memcpy(out + pos, command, length);
+            pos += length;
+            if (!event.isRealtime()) {
+                runningStatus = event.status;
+            }
+            encodedTime += ticks * tickUs;
+            commands++;
+        }
+        // Le reste avance en tête de file
+        if (commands > 0) {
+            memmove(events, events + commands, (count - commands) * sizeof(MidiEvent));
+            count = (uint16_t)(count - commands);
+        }
+        return pos;
+    }
+
+    // Delta time RFC 6295 (1 à 4 octets) ; retourne le nombre d'octets écrits
+    static size_t encodeDelta(uint32_t ticks, uint8_t* out) {
+        if (ticks > 0x0FFFFFFF) {
+            ticks = 0x0FFFFFFF;
+        }
+        size_t length = 0;
+        for (int shift = 21; shift > 0; shift -= 7) {
+            if (ticks >> shift || length > 0) {
+                out[length++] = (uint8_t)(0x80 | ((ticks >> shift) & 0x7F));
+            }
+        }
+        out[length++] = (uint8_t)(ticks & 0x7F);
+        return length;
+    }
+
+    // Octets de données d'un message canal
+    static uint8_t dataLength(uint8_t status) {
+        const uint8_t type = status & 0xF0;
+        return (type == 0xC0 || type == 0xD0) ? 1 : 2;
+    }
+
+private:
+    MidiEvent events[RTP_MIDI_BATCH_EVENTS];
+    uint16_t count;
+    uint32_t overflow;
+};
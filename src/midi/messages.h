@@ -14,4 +14,100 @@ struct MidiMessage {
     } data;
 };
 
+// Origine d'un événement du bus (cf. MidiEventBus)
+enum MidiSource : uint8_t {
+    MIDI_SOURCE_LOCAL = 0, // Composants (boutons, potentiomètres)
+    MIDI_SOURCE_RTP = 1,   // RTP-MIDI entrant
+    MIDI_SOURCE_BLE = 2,   // BLE-MIDI entrant
+    MIDI_SOURCE_OSC = 3,   // Arguments OSC 'm' entrants
+    MIDI_SOURCE_COUNT = 4
+};
+
+// Octet source d'un MidiEvent : origine (4 bits bas) + nombre de sauts (4 bits hauts)
+static constexpr uint8_t MIDI_SOURCE_MASK = 0x0F;
+static constexpr uint8_t MIDI_HOPS_SHIFT = 4;
+static constexpr uint8_t MIDI_MAX_HOPS = 2; // Au-delà, un événement n'est plus relayé
+
+/**
+ * @brief Événement MIDI du bus : 3 octets de message + origine, puis horodatage
+ *
+ * Forme « fil » du message (octet de statut canal inclus, 2 octets de données),
+ * copiable par affectation : les puits le transmettent tel quel, sans repasser
+ * par un appel par type de message. L'octet source porte le transport
+ * d'origine et le nombre de relais : MidiRouter ne renvoie jamais un
+ * événement vers son transport d'origine et cesse de relayer à MIDI_MAX_HOPS.
+ */
+struct MidiEvent {
+    uint8_t status;     // Octet de statut MIDI (0x80-0xFF, canal dans les 4 bits bas)
+    uint8_t data1;
+    uint8_t data2;
+    uint8_t source;     // MidiSource | (sauts << MIDI_HOPS_SHIFT)
+    uint32_t timestamp; // micros() à la publication
+
+    uint8_t origin() const { return source & MIDI_SOURCE_MASK; } // Transport d'arrivée
+    uint8_t hops() const { return source >> MIDI_HOPS_SHIFT; }     // Relais déjà traversés
+    // Copie relayée une fois de plus (origine conservée, sauts saturés à 15)
+    MidiEvent relayed() const {
+        MidiEvent event = *this;
+        if (hops() < 15) {
+            event.source = (uint8_t)(source + (1 << MIDI_HOPS_SHIFT));
+        }
+        return event;
+    }
+    // Même message sur le fil (statut et données), quelle que soit l'origine
+    bool sameMessage(const MidiEvent& other) const {
+        return status == other.status && data1 == other.data1 && data2 == other.data2;
+    }
+
+    uint8_t type() const { return status < 0xF0 ? (status & 0xF0) : status; }
+    uint8_t channel() const { return (status & 0x0F) + 1; } // 1-16 (messages canal)
+    bool isRealtime() const { return status >= 0xF8; }
+    // Pitch bend : -8192 à +8191, centre=0
+    int bend() const { return (int)((data2 << 7) | data1) - 8192; }
+
+    static MidiEvent make(uint8_t status, uint8_t data1, uint8_t data2, uint8_t source) {
+        MidiEvent event = { status, (uint8_t)(data1 & 0x7F), (uint8_t)(data2 & 0x7F), source, (uint32_t)micros() };
+        return event;
+    }
+    static MidiEvent channelMessage(uint8_t type, uint8_t channel, uint8_t data1, uint8_t data2, uint8_t source) {
+        return make((uint8_t)(type | ((channel - 1) & 0x0F)), data1, data2, source);
+    }
+    static MidiEvent noteOn(uint8_t channel, uint8_t note, uint8_t velocity, uint8_t source = MIDI_SOURCE_LOCAL) {
+        return channelMessage(0x90, channel, note, velocity, source);
+    }
+    static MidiEvent noteOff(uint8_t channel, uint8_t note, uint8_t velocity, uint8_t source = MIDI_SOURCE_LOCAL) {
+        return channelMessage(0x80, channel, note, velocity, source);
+    }
+    static MidiEvent controlChange(uint8_t channel, uint8_t control, uint8_t value, uint8_t source = MIDI_SOURCE_LOCAL) {
+        return channelMessage(0xB0, channel, control, value, source);
+    }
+    static MidiEvent programChange(uint8_t channel, uint8_t program, uint8_t source = MIDI_SOURCE_LOCAL) {
+        return channelMessage(0xC0, channel, program, 0, source);
+    }
+    static MidiEvent aftertouch(uint8_t channel, uint8_t pressure, uint8_t source = MIDI_SOURCE_LOCAL) {
+        return channelMessage(0xD0, channel, pressure, 0, source);
+    }
+    static MidiEvent pitchBend(uint8_t channel, int bend, uint8_t source = MIDI_SOURCE_LOCAL) {
+        int value = bend + 8192;
+        if (value < 0) value = 0;
+        if (value > 16383) value = 16383;
+        return channelMessage(0xE0, channel, (uint8_t)(value & 0x7F), (uint8_t)(value >> 7), source);
+    }
+    static MidiEvent realtime(uint8_t status, uint8_t source = MIDI_SOURCE_LOCAL) {
+        return make(status, 0, 0, source);
+    }
+};
+static_assert(sizeof(MidiEvent) == 8, "MidiEvent: 4 octets + horodatage");
 
+// Conversion des messages typés vers le bus (note : velocity 0 = Note Off)
+inline MidiEvent toMidiEvent(const MidiMessage<MidiMsgType::Note>& message, uint8_t source = MIDI_SOURCE_LOCAL) {
+    return message.data.note.velocity
+        ? MidiEvent::noteOn(message.data.note.channel, message.data.note.note, message.data.note.velocity, source)
+        : MidiEvent::noteOff(message.data.note.channel, message.data.note.note, 0, source);
+}
+inline MidiEvent toMidiEvent(const MidiMessage<MidiMsgType::CC>& message, uint8_t source = MIDI_SOURCE_LOCAL) {
+    return MidiEvent::controlChange(message.data.cc.channel, message.data.cc.cc, message.data.cc.value, source);
+}
+inline MidiEvent toMidiEvent(const MidiMessage<MidiMsgType::PC>& message, uint8_t source = MIDI_SOURCE_LOCAL) {
+    return MidiEvent::programChange(message.data.pc.channel, message.data.pc.program, source);
+}
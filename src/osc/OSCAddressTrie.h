@@ -0,0 +1,209 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @brief Table de dispatch OSC compilée depuis les adresses des composants
+ *
+ * Trie par segment d'adresse ("/mixer/ch1/fader" -> mixer, ch1, fader) :
+ * - add() au chargement de la configuration (aucune allocation : noeuds
+ *   et noms dans des tableaux statiques dimensionnés par les paramètres)
+ * - match() en réception : adresse ou motif OSC 1.0 -> masque des
+ *   composants visés (bit i = composant i, 32 composants max)
+ *
+ * Motifs supportés dans l'adresse entrante, segment par segment :
+ *   ?  un caractère quelconque       *  zéro ou plusieurs caractères
+ *   [abc] [a-z] [!abc]  classe       {foo,bar}  alternatives
+ * Un segment littéral est comparé directement (chemin rapide).
+ */
+template <uint16_t MAX_NODES, uint16_t NAME_POOL_SIZE>
+class OSCAddressTrie {
+    static_assert(MAX_NODES >= 2 && MAX_NODES < 0xFFFF, "OSCAddressTrie: MAX_NODES invalide");
+
+public:
+    OSCAddressTrie() { clear(); }
+
+    void clear() {
+        nodes[0] = { 0, 0, NONE, NONE, 0 }; // Racine "/"
+        count = 1;
+        poolUsed = 0;
+    }
+
+    // Enregistre une adresse littérale pour le composant index (0-31).
+    // Retourne false si l'adresse est invalide ou si la table est pleine.
+    bool add(const char* address, uint8_t index) {
+        if (!address || address[0] != '/' || index >= 32) {
+            return false;
+        }
+        uint16_t node = 0;
+        const char* p = address + 1;
+        while (*p) {
+            const char* end = strchr(p, '/');
+            size_t len = end ? (size_t)(end - p) : strlen(p);
+            if (len == 0 || len > 0xFF) {
+                return false;
+            }
+            node = findOrAddChild(node, p, (uint8_t)len);
+            if (node == NONE) {
+                return false;
+            }
+            p += len;
+            if (*p == '/') {
+                p++;
+            }
+        }
+        if (node == 0) {
+            return false; // Adresse "/" seule
+        }
+        nodes[node].components |= 1UL << index;
+        return true;
+    }
+
+    // Composants visés par une adresse (ou un motif) entrante
+    uint32_t match(const char* pattern) const {
+        if (!pattern || pattern[0] != '/' || pattern[1] == '\0') {
+            return 0;
+        }
+        return matchFrom(0, pattern + 1);
+    }
+
+    uint16_t nodeCount() const { return count; }
+
+    // Correspondance d'un segment de motif OSC avec un nom (sans '/')
+    static bool matchSegment(const char* p, size_t pl, const char* n, size_t nl) {
+        while (pl > 0) {
+            const char c = *p;
+            if (c == '*') {
+                while (pl > 0 && *p == '*') { p++; pl--; }
+                if (pl == 0) {
+                    return true;
+                }
+                for (size_t k = 0; k <= nl; k++) {
+                    if (matchSegment(p, pl, n + k, nl - k)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            if (nl == 0) {
+                return false;
+            }
+            if (c == '?') {
+                p++; pl--;
+                n++; nl--;
+            } else if (c == '[') {
+                size_t i = 1;
+                bool negate = false;
+                if (i < pl && p[i] == '!') {
+                    negate = true;
+                    i++;
+                }
+                bool found = false;
+                while (i < pl && p[i] != ']') {
+                    if (i + 2 < pl && p[i + 1] == '-' && p[i + 2] != ']') {
+                        if (*n >= p[i] && *n <= p[i + 2]) found = true;
+                        i += 3;
+                    } else {
+                        if (*n == p[i]) found = true;
+                        i++;
+                    }
+                }
+                if (i >= pl || found == negate) {
+                    return false; // Classe non fermée ou caractère exclu
+                }
+                p += i + 1; pl -= i + 1;
+                n++; nl--;
+            } else if (c == '{') {
+                const char* close = (const char*)memchr(p, '}', pl);
+                if (!close) {
+                    return false;
+                }
+                const char* rest = close + 1;
+                const size_t restLen = pl - (size_t)(rest - p);
+                const char* alt = p + 1;
+                while (alt <= close) {
+                    const char* altEnd = alt;
+                    while (altEnd < close && *altEnd != ',') altEnd++;
+                    const size_t altLen = (size_t)(altEnd - alt);
+                    if (altLen <= nl && memcmp(alt, n, altLen) == 0 &&
+                        matchSegment(rest, restLen, n + altLen, nl - altLen)) {
+                        return true;
+                    }
+                    alt = altEnd + 1;
+                }
+                return false;
+            } else {
+                if (c != *n) {
+                    return false;
+                }
+                p++; pl--;
+                n++; nl--;
+            }
+        }
+        return nl == 0;
+    }
+
+private:
+    static constexpr uint16_t NONE = 0xFFFF;
+
+    struct Node {
+        uint16_t nameOffset;  // Nom du segment dans namePool
+        uint8_t nameLength;
+        uint16_t firstChild;
+        uint16_t nextSibling;
+        uint32_t components;  // Composants dont l'adresse se termine ici
+    };
+
+    uint16_t findOrAddChild(uint16_t parent, const char* name, uint8_t len) {
+        uint16_t last = NONE;
+        for (uint16_t child = nodes[parent].firstChild; child != NONE; child = nodes[child].nextSibling) {
+            if (nodes[child].nameLength == len && memcmp(namePool + nodes[child].nameOffset, name, len) == 0) {
+                return child;
+            }
+            last = child;
+        }
+        if (count >= MAX_NODES || poolUsed + len > NAME_POOL_SIZE) {
+            return NONE;
+        }
+        const uint16_t node = count++;
+        memcpy(namePool + poolUsed, name, len);
+        nodes[node] = { poolUsed, len, NONE, NONE, 0 };
+        poolUsed += len;
+        if (last == NONE) {
+            nodes[parent].firstChild = node;
+        } else {
+            nodes[last].nextSibling = node;
+        }
+        return node;
+    }
+
+    uint32_t matchFrom(uint16_t parent, const char* p) const {
+        const char* end = strchr(p, '/');
+        const size_t len = end ? (size_t)(end - p) : strlen(p);
+        const bool literal = strcspn(p, "*?[{") >= len;
+
+        uint32_t mask = 0;
+        for (uint16_t child = nodes[parent].firstChild; child != NONE; child = nodes[child].nextSibling) {
+            const Node& node = nodes[child];
+            const char* name = namePool + node.nameOffset;
+            const bool hit = literal
+                ? (node.nameLength == len && memcmp(name, p, len) == 0)
+                : matchSegment(p, len, name, node.nameLength);
+            if (!hit) {
+                continue;
+            }
+            mask |= end ? matchFrom(child, end + 1) : node.components;
+            if (literal) {
+                break; // Noms uniques parmi les frères
+            }
+        }
+        return mask;
+    }
+
+    Node nodes[MAX_NODES];
+    char namePool[NAME_POOL_SIZE];
+    uint16_t count;
+    uint16_t poolUsed;
+};
@@ -0,0 +1,441 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/time.h>
+
+// Taille max d'un datagramme OSC (MTU Ethernet/WiFi 1500 - en-têtes IP/UDP)
+static constexpr size_t OSC_MAX_PACKET_SIZE = 1472;
+
+// Timetag OSC "immédiat" (spécification OSC 1.0)
+static constexpr uint64_t OSC_TIMETAG_IMMEDIATE = 1ULL;
+
+// Décalage entre l'époque NTP (1900) et l'époque Unix (1970), en secondes
+static constexpr uint32_t OSC_NTP_UNIX_OFFSET = 2208988800UL;
+
+/**
+ * @brief Timetag NTP 64 bits de l'instant présent
+ *
+ * Retourne OSC_TIMETAG_IMMEDIATE tant que l'horloge système n'est pas
+ * synchronisée (avant 2020), pour ne pas envoyer de dates absurdes.
+ */
+inline uint64_t oscTimetagNow() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    if (tv.tv_sec < 1577836800L) { // 01/01/2020
+        return OSC_TIMETAG_IMMEDIATE;
+    }
+    uint64_t seconds = (uint64_t)tv.tv_sec + OSC_NTP_UNIX_OFFSET;
+    uint64_t fraction = ((uint64_t)tv.tv_usec << 32) / 1000000ULL;
+    return (seconds << 32) | fraction;
+}
+
+/**
+ * @brief Délai en µs entre maintenant et un timetag OSC
+ *
+ * Retourne 0 pour un timetag « immédiat », ou si l'horloge locale n'est
+ * pas synchronisée (impossible de planifier) ; négatif si l'instant est passé.
+ */
+inline int64_t oscTimetagDelayUs(uint64_t timetag) {
+    if (timetag == OSC_TIMETAG_IMMEDIATE) {
+        return 0;
+    }
+    const uint64_t now = oscTimetagNow();
+    if (now == OSC_TIMETAG_IMMEDIATE) {
+        return 0;
+    }
+    // Différence signée en virgule fixe 32.32 secondes -> µs
+    const int64_t delta = (int64_t)(timetag - now);
+    const int64_t seconds = delta >> 32;
+    const int64_t fraction = (int64_t)((uint64_t)delta & 0xFFFFFFFFULL);
+    return seconds * 1000000LL + ((fraction * 1000000LL) >> 32);
+}
+
+// Lecture d'un entier 32 bits big-endian
+inline uint32_t oscReadBE32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+/**
+ * @brief Encodeur OSC 1.0 sur un buffer fourni par l'appelant
+ *
+ * Types supportés : int32 (i), float32 (f), string (s), blob (b),
+ * ainsi que les bundles (#bundle + timetag + éléments dimensionnés).
+ *
+ * Aucune allocation : écrit directement en big-endian dans le buffer.
+ * En cas de dépassement, ok() devient false et les écritures suivantes
+ * sont ignorées (length() reste valide jusqu'au dernier octet correct).
+ *
+ * Usage message : address() → typeTags() → arguments
+ * Usage bundle  : beginBundle() → pour chaque élément :
+ *                 mark = beginElement(), message..., endElement(mark)
+ */
+class OSCWriter {
+public:
+    OSCWriter(uint8_t* buffer, size_t capacity)
+        : buf(buffer), cap(capacity), pos(0), valid(true) {}
+
+    bool beginBundle(uint64_t timetag) {
+        static const char BUNDLE_TAG[8] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', '\0'};
+        return bytes(BUNDLE_TAG, sizeof(BUNDLE_TAG)) && uint64(timetag);
+    }
+
+    // Réserve le champ taille d'un élément de bundle, retourne sa position
+    size_t beginElement() {
+        size_t mark = pos;
+        uint32(0);
+        return mark;
+    }
+
+    // Écrit la taille de l'élément commencé à `mark`
+    void endElement(size_t mark) {
+        if (!valid || mark + 4 > pos) return;
+        putBE32(buf + mark, (uint32_t)(pos - mark - 4));
+    }
+
+    bool address(const char* addr) { return paddedString(addr); }
+    bool typeTags(const char* tags) { return paddedString(tags); }
+    bool string(const char* str) { return paddedString(str); }
+
+    bool blob(const void* data, size_t size) {
+        size_t total = (size + 3) & ~(size_t)3;
+        if (!reserve(4 + total)) return false;
+        putBE32(buf + pos, (uint32_t)size);
+        memcpy(buf + pos + 4, data, size);
+        memset(buf + pos + 4 + size, 0, total - size);
+        pos += 4 + total;
+        return true;
+    }
+
+    bool int32(int32_t value) { return uint32((uint32_t)value); }
+
+    bool float32(float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return uint32(bits);
+    }
+
+    bool uint32(uint32_t value) {
+        if (!reserve(4)) return false;
+        putBE32(buf + pos, value);
+        pos += 4;
+        return true;
+    }
+
+    bool uint64(uint64_t value) {
+        return uint32((uint32_t)(value >> 32)) && uint32((uint32_t)value);
+    }
+
+    // Copie d'octets déjà encodés (ex: en-tête d'un OSCPacketTemplate)
+    bool bytes(const void* src, size_t n) {
+        if (!reserve(n)) return false;
+        memcpy(buf + pos, src, n);
+        pos += n;
+        return true;
+    }
+
+    // Revient à une position antérieure (annule un élément qui ne tient pas)
+    void rewind(size_t mark) {
+        if (mark <= pos) {
+            pos = mark;
+            valid = true;
+        }
+    }
+
+    size_t length() const { return pos; }
+    bool ok() const { return valid; }
+    const uint8_t* data() const { return buf; }
+
+    static void putBE32(uint8_t* p, uint32_t v) {
+        p[0] = (uint8_t)(v >> 24);
+        p[1] = (uint8_t)(v >> 16);
+        p[2] = (uint8_t)(v >> 8);
+        p[3] = (uint8_t)v;
+    }
+
+    // Taille d'une chaîne OSC ('\0' compris, alignée sur 4 octets)
+    static size_t paddedSize(size_t len) { return (len + 4) & ~(size_t)3; }
+
+private:
+    bool reserve(size_t n) {
+        if (!valid || pos + n > cap) {
+            valid = false;
+            return false;
+        }
+        return true;
+    }
+
+    bool paddedString(const char* s) {
+        size_t len = strlen(s);
+        size_t total = paddedSize(len);
+        if (!reserve(total)) return false;
+        memcpy(buf + pos, s, len);
+        memset(buf + pos + len, 0, total - len);
+        pos += total;
+        return true;
+    }
+
+    uint8_t* buf;
+    size_t cap;
+    size_t pos;
+    bool valid;
+};
+
+// Taille max d'une adresse OSC de composant ('\0' compris, cf. ComponentConfig::osc_address)
+static constexpr size_t OSC_TEMPLATE_ADDRESS_SIZE = 32;
+// Adresse (32) + type tags ",iii" (8)
+static constexpr size_t OSC_TEMPLATE_HEADER_SIZE = OSC_TEMPLATE_ADDRESS_SIZE + 8;
+
+/**
+ * @brief En-tête OSC pré-encodé (adresse + type tags) d'un message sortant
+ *
+ * Construit une seule fois (au chargement de la config d'un composant) ;
+ * l'envoi se limite ensuite à copier l'en-tête et écrire les arguments
+ * 32 bits big-endian à la suite.
+ *
+ * messageType : 0 = float (",f"), 1 = MIDI (",iii" data1 data2 canal)
+ */
+struct OSCPacketTemplate {
+    uint8_t header[OSC_TEMPLATE_HEADER_SIZE];
+    uint8_t addressLength; // Octets d'adresse encodée (multiple de 4)
+    uint8_t headerLength;  // Adresse + type tags
+    uint8_t messageType;
+
+    // Retourne false si l'adresse a dû être tronquée
+    bool build(const char* address, uint8_t type) {
+        char addr[OSC_TEMPLATE_ADDRESS_SIZE];
+        size_t len = strlen(address);
+        bool truncated = len >= sizeof(addr);
+        if (truncated) {
+            len = sizeof(addr) - 1;
+        }
+        memcpy(addr, address, len);
+        addr[len] = '\0';
+
+        OSCWriter writer(header, sizeof(header));
+        writer.address(addr);
+        addressLength = (uint8_t)writer.length();
+        writer.typeTags(type == 0 ? ",f" : ",iii");
+        headerLength = (uint8_t)writer.length();
+        messageType = type;
+        return !truncated;
+    }
+
+    // Nombre d'arguments 32 bits attendus après l'en-tête
+    uint8_t argCount() const { return messageType == 0 ? 1 : 3; }
+    size_t packetLength() const { return headerLength + 4 * argCount(); }
+};
+
+/**
+ * @brief Argument OSC décodé (vue sur le buffer reçu, sans copie)
+ */
+struct OSCArgument {
+    char type;           // Type tag OSC ('i', 'f', 's', 'b', 'm', 'T', ...)
+    const uint8_t* data; // Début des données dans le buffer (nullptr si aucune)
+    uint32_t size;       // Taille utile (octets de chaîne hors '\0', taille du blob, 4/8 sinon)
+
+    bool isNumber() const {
+        return type == 'i' || type == 'f' || type == 'h' || type == 'd' || type == 'T' || type == 'F';
+    }
+
+    int32_t asInt32() const {
+        switch (type) {
+            case 'i': return (int32_t)oscReadBE32(data);
+            case 'h': return (int32_t)oscReadBE32(data + 4);
+            case 'f': return (int32_t)asFloat();
+            case 'd': return (int32_t)asFloat();
+            case 'T': return 1;
+            default:  return 0;
+        }
+    }
+
+    float asFloat() const {
+        switch (type) {
+            case 'f': {
+                uint32_t bits = oscReadBE32(data);
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+            case 'd': {
+                uint64_t bits = ((uint64_t)oscReadBE32(data) << 32) | oscReadBE32(data + 4);
+                double value;
+                memcpy(&value, &bits, sizeof(value));
+                return (float)value;
+            }
+            case 'i': return (float)(int32_t)oscReadBE32(data);
+            case 'h': return (float)(int32_t)oscReadBE32(data + 4);
+            case 'T': return 1.0f;
+            default:  return 0.0f;
+        }
+    }
+
+    // Chaîne terminée par '\0' dans le buffer (s, S) ; nullptr sinon
+    const char* asString() const {
+        return (type == 's' || type == 'S') ? (const char*)data : nullptr;
+    }
+
+    // Message MIDI OSC ('m') : port, status, data1, data2
+    bool asMidi(uint8_t& status, uint8_t& data1, uint8_t& data2) const {
+        if (type != 'm') return false;
+        status = data[1];
+        data1 = data[2];
+        data2 = data[3];
+        return true;
+    }
+};
+
+/**
+ * @brief Décodeur de message OSC en place (aucune copie, aucune allocation)
+ *
+ * Le buffer doit rester valide tant que la vue et ses arguments sont utilisés.
+ *
+ * Usage :
+ *   OSCMessageView msg;
+ *   if (msg.parse(data, len)) {
+ *       OSCArgument arg;
+ *       for (uint8_t i = 0; msg.next(arg); i++) { ... }
+ *   }
+ */
+class OSCMessageView {
+public:
+    OSCMessageView()
+        : addr(nullptr), tags(""), argsStart(nullptr), cursor(nullptr), end(nullptr), tagIndex(0) {}
+
+    bool parse(const uint8_t* data, size_t length) {
+        addr = nullptr;
+        if (length < 4 || (length & 3) || data[0] != '/') return false;
+        const uint8_t* limit = data + length;
+
+        size_t addrLen = strnlen((const char*)data, length);
+        if (addrLen >= length) return false;
+        const uint8_t* p = data + OSCWriter::paddedSize(addrLen);
+
+        // Type tags optionnels (anciens émetteurs) : absence = aucun argument
+        tags = "";
+        if (p < limit && *p == ',') {
+            size_t tagLen = strnlen((const char*)p, limit - p);
+            if (tagLen >= (size_t)(limit - p)) return false;
+            tags = (const char*)p + 1;
+            p += OSCWriter::paddedSize(tagLen);
+        }
+        if (p > limit) return false;
+
+        addr = (const char*)data;
+        argsStart = p;
+        end = limit;
+        rewind();
+        return true;
+    }
+
+    const char* address() const { return addr; }
+    const char* typeTags() const { return tags; } // Sans la virgule
+    uint8_t size() const { return (uint8_t)strlen(tags); }
+
+    // Revient au premier argument
+    void rewind() {
+        cursor = argsStart;
+        tagIndex = 0;
+    }
+
+    // Argument suivant ; false en fin de message ou si le message est tronqué
+    bool next(OSCArgument& arg) {
+        if (!addr) return false;
+        char t = tags[tagIndex];
+        if (t == '\0') return false;
+
+        arg.type = t;
+        arg.data = cursor;
+        arg.size = 0;
+        size_t advance = 0;
+        switch (t) {
+            case 'i': case 'f': case 'c': case 'r': case 'm':
+                advance = arg.size = 4;
+                break;
+            case 'h': case 'd': case 't':
+                advance = arg.size = 8;
+                break;
+            case 's': case 'S': {
+                size_t len = strnlen((const char*)cursor, end - cursor);
+                if (len >= (size_t)(end - cursor)) return false;
+                arg.size = (uint32_t)len;
+                advance = OSCWriter::paddedSize(len);
+                break;
+            }
+            case 'b': {
+                if (end - cursor < 4) return false;
+                arg.size = oscReadBE32(cursor);
+                // Taille annoncée au-delà du paquet : rejet avant tout calcul (pas de débordement)
+                if (arg.size > (size_t)(end - cursor - 4)) return false;
+                arg.data = cursor + 4;
+                advance = 4 + (((size_t)arg.size + 3) & ~(size_t)3);
+                break;
+            }
+            case 'T': case 'F': case 'N': case 'I': case '[': case ']':
+                arg.data = nullptr;
+                break;
+            default:
+                return false; // Type inconnu : taille impossible à déterminer
+        }
+        if (advance > (size_t)(end - cursor)) return false;
+        cursor += advance;
+        tagIndex++;
+        return true;
+    }
+
+    // Accès direct à l'argument `index` (parcours depuis le début)
+    bool argument(uint8_t index, OSCArgument& arg) {
+        rewind();
+        for (uint8_t i = 0; next(arg); i++) {
+            if (i == index) return true;
+        }
+        return false;
+    }
+
+private:
+    const char* addr;
+    const char* tags;
+    const uint8_t* argsStart;
+    const uint8_t* cursor;
+    const uint8_t* end;
+    uint8_t tagIndex;
+};
+
+/**
+ * @brief Décodeur de bundle OSC en place
+ *
+ * Parcourt les éléments (messages ou bundles imbriqués) sans copie.
+ */
+class OSCBundleView {
+public:
+    static bool isBundle(const uint8_t* data, size_t length) {
+        return length >= 16 && memcmp(data, "#bundle", 8) == 0;
+    }
+
+    bool parse(const uint8_t* data, size_t length) {
+        if (!isBundle(data, length)) return false;
+        tag = ((uint64_t)oscReadBE32(data + 8) << 32) | oscReadBE32(data + 12);
+        cursor = data + 16;
+        end = data + length;
+        return true;
+    }
+
+    uint64_t timetag() const { return tag; }
+
+    // Élément suivant ; false en fin de bundle ou si un élément est tronqué
+    bool next(const uint8_t*& element, size_t& elementLength) {
+        if (end - cursor < 4) return false;
+        uint32_t size = oscReadBE32(cursor);
+        if (size > (size_t)(end - cursor - 4)) return false;
+        element = cursor + 4;
+        elementLength = size;
+        cursor += 4 + size;
+        return true;
+    }
+
+private:
+    uint64_t tag = OSC_TIMETAG_IMMEDIATE;
+    const uint8_t* cursor = nullptr;
+    const uint8_t* end = nullptr;
+};
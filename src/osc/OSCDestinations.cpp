@@ -0,0 +1,351 @@
+#include "OSCDestinations.h"
+#include <WiFi.h>
+
+std::atomic<uint32_t> OSCDestinationTable::networkGeneration(1);
+bool OSCDestinationTable::eventsAttached = false;
+
+// Réseau AP par défaut du serveur (192.168.4.1/24)
+static const IPAddress AP_BROADCAST_IP(192, 168, 4, 255);
+
+OSCDestinationTable::OSCDestinationTable()
+    : count(0), explicitList(false), dirty(true), staConnected(false), generation(0),
+      lookupPending(0), lookupValid(0), targetPort(8000), broadcastEnabled(false), networkInterface(0) {
+    memset(configs, 0, sizeof(configs));
+    memset(entries, 0, sizeof(entries));
+    targetIP[0] = '\0';
+}
+
+// Copie la liste ; les compteurs et le seau d'une entrée ne repartent à zéro
+// que si sa configuration a changé. Retourne les entrées modifiées (bit = index)
+static uint8_t assignList(OSCDestinationConfig* configs, OSCDestination* entries, uint8_t& count,
+                          const OSCDestinationConfig* list, uint8_t listCount) {
+    uint8_t changed = 0;
+    for (uint8_t i = 0; i < listCount; i++) {
+        if (i < count && memcmp(&configs[i], &list[i], sizeof(OSCDestinationConfig)) == 0) {
+            continue;
+        }
+        changed |= 1 << i;
+        configs[i] = list[i];
+        OSCDestination& entry = entries[i];
+        memset(&entry, 0, sizeof(OSCDestination));
+        entry.rate = list[i].rate;
+        entry.burst = list[i].burst;
+        entry.tokens = (uint32_t)list[i].burst * 1000;
+        entry.lastRefill = micros();
+    }
+    count = listCount;
+    return changed;
+}
+
+void OSCDestinationTable::setDestinations(const OSCDestinationConfig* list, uint8_t listCount) {
+    if (listCount > MAX_DESTINATIONS) {
+        listCount = MAX_DESTINATIONS;
+    }
+    if (listCount == 0) {
+        if (explicitList) {
+            explicitList = false;
+            dirty = true;
+        }
+        return;
+    }
+    if (explicitList && listCount == count &&
+        memcmp(configs, list, listCount * sizeof(OSCDestinationConfig)) == 0) {
+        return;
+    }
+    lookupValid &= ~assignList(configs, entries, count, list, listCount);
+    explicitList = true;
+    dirty = true;
+}
+
+void OSCDestinationTable::setTarget(const char* target_ip, uint16_t target_port) {
+    // Ne rien invalider si inchangé (aucune résolution DNS inutile)
+    if (!target_ip) {
+        target_ip = "";
+    }
+    if (target_port == targetPort && strncmp(target_ip, targetIP, OSC_DEST_HOST_SIZE) == 0) {
+        return;
+    }
+    strncpy(targetIP, target_ip, OSC_DEST_HOST_SIZE - 1);
+    targetIP[OSC_DEST_HOST_SIZE - 1] = '\0';
+    targetPort = target_port;
+    dirty = true;
+}
+
+void OSCDestinationTable::setBroadcast(bool enable) {
+    if (enable == broadcastEnabled) {
+        return;
+    }
+    broadcastEnabled = enable;
+    dirty = true;
+}
+
+void OSCDestinationTable::setInterface(uint8_t interface) {
+    if (interface == networkInterface) {
+        return;
+    }
+    networkInterface = interface;
+    dirty = true;
+}
+
+uint8_t OSCDestinationTable::activeCount() const {
+    uint8_t active = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (entries[i].active) {
+            active++;
+        }
+    }
+    return active;
+}
+
+bool OSCDestinationTable::hasFormatFilter() const {
+    for (uint8_t i = 0; i < count; i++) {
+        if (entries[i].active && entries[i].formats != OSC_FORMAT_ALL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool OSCDestinationTable::admit(uint8_t index, uint16_t cost, uint32_t now) {
+    OSCDestination& entry = entries[index];
+    if (entry.rate == 0) {
+        return true;
+    }
+    
+    // Remplissage en millièmes de message : rate msg/s = rate millièmes/ms.
+    // lastRefill n'avance que si un jeton a été crédité (pas de perte par troncature)
+    const uint32_t capacity = (uint32_t)entry.burst * 1000;
+    const uint64_t refill = (uint64_t)(now - entry.lastRefill) * entry.rate / 1000;
+    if (refill > 0) {
+        entry.lastRefill = now;
+        entry.tokens = refill >= capacity - entry.tokens ? capacity : entry.tokens + (uint32_t)refill;
+    }
+    
+    // Un bundle plus gros que la rafale passe quand le seau est plein
+    const uint32_t need = (uint32_t)(cost < entry.burst ? cost : entry.burst) * 1000;
+    if (entry.tokens < need) {
+        return false;
+    }
+    entry.tokens -= need;
+    return true;
+}
+
+void OSCDestinationTable::resetStats() {
+    for (uint8_t i = 0; i < MAX_DESTINATIONS; i++) {
+        entries[i].sent = 0;
+        entries[i].failed = 0;
+        entries[i].limited = 0;
+        entries[i].bytes = 0;
+    }
+}
+
+uint8_t OSCDestinationTable::parseList(const char* text, OSCDestinationConfig* out, uint8_t max) {
+    uint8_t parsed = 0;
+    while (text && *text && parsed < max) {
+        // Entrée courante, bornée par ',' (copie locale modifiable)
+        const char* end = strchr(text, ',');
+        size_t len = end ? (size_t)(end - text) : strlen(text);
+        char entry[OSC_DEST_HOST_SIZE + 32];
+        if (len >= sizeof(entry)) {
+            len = sizeof(entry) - 1;
+        }
+        memcpy(entry, text, len);
+        entry[len] = '\0';
+        text = end ? end + 1 : nullptr;
+        
+        char* host = entry;
+        while (*host == ' ') host++;
+        
+        // Limite de débit : "@débit[/rafale]"
+        uint16_t rate = 0;
+        uint16_t burst = 0;
+        char* limit = strchr(host, '@');
+        if (limit) {
+            *limit++ = '\0';
+            rate = (uint16_t)atoi(limit);
+            char* slash = strchr(limit, '/');
+            burst = slash ? (uint16_t)atoi(slash + 1) : 0;
+            if (rate > 0 && burst == 0) {
+                burst = rate / 10 > 0 ? rate / 10 : 1; // 100 ms de rafale par défaut
+            }
+        }
+        
+        // "hôte:port[:format]"
+        char* colon = strchr(host, ':');
+        if (!colon) {
+            continue;
+        }
+        *colon++ = '\0';
+        const int port = atoi(colon);
+        const bool serial = strcmp(host, "serial") == 0;
+        if (serial ? (port < 0 || port > 1) : (port <= 0 || port > 65535 || *host == '\0')) {
+            continue;
+        }
+        uint8_t formats = OSC_FORMAT_ALL;
+        char* format = strchr(colon, ':');
+        if (format) {
+            format++;
+            if (strncmp(format, "float", 5) == 0) {
+                formats = OSC_FORMAT_FLOAT;
+            } else if (strncmp(format, "midi", 4) == 0) {
+                formats = OSC_FORMAT_MIDI;
+            }
+        }
+        
+        OSCDestinationConfig& config = out[parsed];
+        memset(&config, 0, sizeof(config));
+        config.port = (uint16_t)port;
+        config.formats = formats;
+        config.rate = rate;
+        config.burst = burst;
+        if (strcmp(host, "ap") == 0) {
+            config.kind = OSC_DEST_BROADCAST_AP;
+        } else if (strcmp(host, "sta") == 0) {
+            config.kind = OSC_DEST_BROADCAST_STA;
+        } else if (serial) {
+            config.kind = OSC_DEST_SERIAL;
+        } else {
+            const int firstOctet = atoi(host);
+            config.kind = (firstOctet >= 224 && firstOctet <= 239) ? OSC_DEST_MULTICAST : OSC_DEST_UNICAST;
+            strncpy(config.host, host, OSC_DEST_HOST_SIZE - 1);
+        }
+        parsed++;
+    }
+    return parsed;
+}
+
+void OSCDestinationTable::attachWiFiEvents() {
+    if (eventsAttached) {
+        return;
+    }
+    eventsAttached = true;
+
+    // Exécuté dans la tâche d'événements WiFi : on se contente d'invalider
+    WiFi.onEvent([](arduino_event_id_t event, arduino_event_info_t info) {
+        (void)info;
+        switch (event) {
+            case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+            case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            case ARDUINO_EVENT_WIFI_AP_START:
+            case ARDUINO_EVENT_WIFI_AP_STOP:
+                networkGeneration.fetch_add(1, std::memory_order_relaxed);
+                break;
+            default:
+                break;
+        }
+    });
+}
+
+uint8_t OSCDestinationTable::resolve() {
+    const uint32_t current = networkGeneration.load(std::memory_order_relaxed);
+    if (dirty || generation != current) {
+        // Changement de réseau : les noms sont à résoudre à nouveau
+        if (generation != current) {
+            lookupValid = 0;
+        }
+        generation = current;
+        rebuild();
+    }
+    return count;
+}
+
+void OSCDestinationTable::buildLegacyList() {
+    // Cible unique ou broadcast selon l'interface (BOTH : AP et STA)
+    OSCDestinationConfig list[2];
+    uint8_t listCount = 0;
+    memset(list, 0, sizeof(list));
+    if (broadcastEnabled) {
+        if (networkInterface == 0 || networkInterface == 2) { // AP ou BOTH
+            list[listCount].kind = OSC_DEST_BROADCAST_AP;
+            list[listCount].port = targetPort;
+            list[listCount++].formats = OSC_FORMAT_ALL;
+        }
+        if (networkInterface == 1 || networkInterface == 2) { // STA ou BOTH
+            list[listCount].kind = OSC_DEST_BROADCAST_STA;
+            list[listCount].port = targetPort;
+            list[listCount++].formats = OSC_FORMAT_ALL;
+        }
+    } else if (targetIP[0] != '\0') {
+        strncpy(list[0].host, targetIP, OSC_DEST_HOST_SIZE - 1);
+        list[0].kind = OSC_DEST_UNICAST;
+        list[0].port = targetPort;
+        list[listCount++].formats = OSC_FORMAT_ALL;
+    }
+    lookupValid &= ~assignList(configs, entries, count, list, listCount);
+}
+
+void OSCDestinationTable::completeLookup(uint8_t index, const char* host, const IPAddress& ip, bool found) {
+    if (index >= count || !(lookupPending & (1 << index)) ||
+        strncmp(configs[index].host, host, OSC_DEST_HOST_SIZE) != 0) {
+        return;
+    }
+    // Échec : entrée inactive jusqu'à la prochaine reconstruction (une tentative par reconstruction)
+    lookupPending &= ~(1 << index);
+    if (found) {
+        lookupIPs[index] = ip;
+        lookupValid |= 1 << index;
+        entries[index].ip = ip;
+        entries[index].active = true;
+    }
+}
+
+void OSCDestinationTable::rebuild() {
+    dirty = false;
+    lookupPending = 0;
+    staConnected = (WiFi.status() == WL_CONNECTED);
+    if (!explicitList) {
+        buildLegacyList();
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        const OSCDestinationConfig& config = configs[i];
+        OSCDestination& entry = entries[i];
+        entry.port = config.port;
+        entry.kind = config.kind;
+        entry.formats = config.formats;
+        entry.active = false;
+
+        switch (config.kind) {
+            case OSC_DEST_BROADCAST_AP:
+                entry.ip = AP_BROADCAST_IP;
+                entry.active = true;
+                break;
+            case OSC_DEST_BROADCAST_STA:
+                if (staConnected) {
+                    IPAddress ip = WiFi.localIP();
+                    IPAddress subnet = WiFi.subnetMask();
+                    entry.ip = IPAddress(ip[0] | (~subnet[0]),
+                                         ip[1] | (~subnet[1]),
+                                         ip[2] | (~subnet[2]),
+                                         ip[3] | (~subnet[3]));
+                    entry.active = true;
+                }
+                break;
+            case OSC_DEST_SERIAL:
+                // Sans dépendance au WiFi (port ouvert par OSCTransport)
+                entry.ip = IPAddress();
+                entry.active = true;
+                break;
+            default: {
+                // Configuration historique : cible injoignable si l'interface STA est tombée
+                if (!explicitList && networkInterface != 0 && !staConnected) {
+                    break;
+                }
+                // IP littérale, sinon adresse déjà résolue ; à défaut la résolution
+                // DNS/mDNS est demandée au propriétaire (hors du chemin d'envoi)
+                IPAddress ip;
+                if (ip.fromString(config.host)) {
+                    entry.ip = ip;
+                    entry.active = true;
+                } else if (lookupValid & (1 << i)) {
+                    entry.ip = lookupIPs[i];
+                    entry.active = true;
+                } else if (staConnected) {
+                    lookupPending |= 1 << i;
+                }
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <atomic>
+
+// Type de destination résolue
+enum OSCDestinationKind : uint8_t {
+    OSC_DEST_UNICAST = 0,
+    OSC_DEST_BROADCAST_AP = 1,
+    OSC_DEST_BROADCAST_STA = 2,
+    OSC_DEST_MULTICAST = 3,
+    OSC_DEST_SERIAL = 4,      // Trames SLIP sur un port série (port = numéro d'UART)
+    OSC_DEST_KIND_COUNT = 5
+};
+
+// Formats acceptés par une destination (bit = 1 << OSCMessageItem::messageType)
+enum OSCDestinationFormat : uint8_t {
+    OSC_FORMAT_FLOAT = 0x01,
+    OSC_FORMAT_MIDI = 0x02,
+    OSC_FORMAT_ALL = 0x03
+};
+
+static constexpr uint8_t OSC_DEST_HOST_SIZE = 64;
+
+// Destination configurée (copiable par valeur, sans allocation)
+struct OSCDestinationConfig {
+    char host[OSC_DEST_HOST_SIZE]; // IP, nom DNS/mDNS ou groupe multicast (vide pour un broadcast ou le série)
+    uint16_t port;    // Port UDP, ou numéro d'UART pour OSC_DEST_SERIAL
+    uint8_t kind;     // OSCDestinationKind
+    uint8_t formats;  // OSCDestinationFormat
+    uint16_t rate;    // Messages/s (0 = illimité)
+    uint16_t burst;   // Capacité du seau à jetons (messages)
+};
+
+// Entrée résolue : envoi direct par udp.beginPacket(ip, port)
+struct OSCDestination {
+    IPAddress ip;
+    uint16_t port;
+    uint8_t kind;     // OSCDestinationKind
+    uint8_t formats;  // OSCDestinationFormat
+    bool active;      // Résolue et interface disponible
+
+    // Seau à jetons (millièmes de message) ; état conservé entre reconstructions
+    uint16_t rate;
+    uint16_t burst;
+    uint32_t tokens;
+    uint32_t lastRefill;
+
+    // Compteurs par destination (messages, sauf bytes)
+    uint32_t sent;
+    uint32_t failed;
+    uint32_t limited; // Écartés par la limite de débit
+    uint32_t bytes;
+
+    // A accusé (ack/NACK) dans la session de livraison fiable : seule à recevoir les
+    // retransmissions ; remis à zéro avec l'entrée quand sa configuration change
+    bool reliable;
+};
+
+/**
+ * @brief Table des destinations OSC résolues (IPAddress + port)
+ *
+ * Liste de destinations (unicast, broadcast par interface, groupe multicast, port série),
+ * chacune avec son port, ses formats acceptés et sa limite de débit.
+ * Sans liste explicite, la table dérive une liste de la configuration
+ * historique (cible unique + broadcast + interface).
+ *
+ * Évite sur le chemin d'envoi :
+ * - le parsing de la chaîne IP cible à chaque paquet
+ * - le recalcul de l'adresse broadcast STA (localIP | ~subnetMask)
+ *
+ * La table est reconstruite uniquement :
+ * - quand la configuration change (setDestinations / setTarget / setBroadcast / setInterface)
+ * - après un événement WiFi (IP obtenue/perdue, AP démarré/arrêté)
+ *
+ * Les événements WiFi incrémentent un compteur de génération global ;
+ * resolve() compare ce compteur et ne reconstruit que s'il a bougé.
+ *
+ * resolve() ne fait jamais de résolution DNS/mDNS (bloquante) : un nom non
+ * encore résolu laisse l'entrée inactive et lève son bit dans pendingLookups() ;
+ * le propriétaire résout hors de tout verrou puis appelle completeLookup().
+ */
+class OSCDestinationTable {
+public:
+    static constexpr uint8_t MAX_DESTINATIONS = 8;
+
+    OSCDestinationTable();
+
+    // Liste explicite (count = 0 : retour à la configuration historique)
+    void setDestinations(const OSCDestinationConfig* list, uint8_t count);
+
+    // Configuration historique (invalide la table, reconstruite au prochain resolve())
+    void setTarget(const char* target_ip, uint16_t target_port);
+    void setBroadcast(bool enable);
+    void setInterface(uint8_t interface);
+
+    // Chemin d'envoi : reconstruit si nécessaire puis retourne le nombre d'entrées
+    // (entrées inactives comprises, cf. OSCDestination::active)
+    uint8_t resolve();
+    OSCDestination& operator[](uint8_t index) { return entries[index]; }
+    const OSCDestination& operator[](uint8_t index) const { return entries[index]; }
+    uint8_t size() const { return count; }
+    uint8_t activeCount() const;
+
+    // Une destination active n'accepte-t-elle qu'une partie des formats ?
+    // (les bundles doivent alors rester homogènes)
+    bool hasFormatFilter() const;
+
+    // Seau à jetons : retire cost messages si disponibles
+    bool admit(uint8_t index, uint16_t cost, uint32_t now);
+
+    // Entrées nommées en attente de résolution (bit = index)
+    uint8_t pendingLookups() const { return lookupPending; }
+    // Résultat d'une résolution faite hors verrou ; ignoré si l'hôte de l'entrée a changé entre-temps
+    void completeLookup(uint8_t index, const char* host, const IPAddress& ip, bool found);
+
+    // Configuration de l'entrée index (hôte, limite de débit)
+    const OSCDestinationConfig& getConfig(uint8_t index) const { return configs[index]; }
+    void resetStats();
+
+    // État STA mémorisé lors de la dernière reconstruction
+    bool isStaConnected() const { return staConnected; }
+    uint8_t getInterface() const { return networkInterface; }
+
+    // Liste texte "hôte:port[:float|midi][@débit[/rafale]]" séparée par des virgules.
+    // hôte = IP, nom, groupe 224.0.0.0/4, "ap" ou "sta" (broadcast de l'interface),
+    // "serial" (port = UART : 0 console/USB, 1 broches TX/RX).
+    // Retourne le nombre d'entrées valides écrites dans out.
+    static uint8_t parseList(const char* text, OSCDestinationConfig* out, uint8_t max);
+
+    // Abonnement unique aux événements WiFi (idempotent)
+    static void attachWiFiEvents();
+
+private:
+    void rebuild();
+    void buildLegacyList();
+
+    OSCDestinationConfig configs[MAX_DESTINATIONS];
+    OSCDestination entries[MAX_DESTINATIONS];
+    uint8_t count;
+    bool explicitList; // Liste fournie par setDestinations()
+    bool dirty;
+    bool staConnected;
+    uint32_t generation; // Génération réseau de la dernière reconstruction
+
+    // Résolutions DNS/mDNS (bit = index) : en attente, et adresse en cache valide
+    IPAddress lookupIPs[MAX_DESTINATIONS];
+    uint8_t lookupPending;
+    uint8_t lookupValid;
+
+    // Configuration historique
+    char targetIP[OSC_DEST_HOST_SIZE];
+    uint16_t targetPort;
+    bool broadcastEnabled;
+    uint8_t networkInterface; // 0=AP, 1=STA, 2=BOTH
+
+    static std::atomic<uint32_t> networkGeneration;
+    static bool eventsAttached;
+};
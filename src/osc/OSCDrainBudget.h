@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Taille d'une tranche de vidage de la file OSC (datagrammes)
+ *
+ * Autant de datagrammes que le budget de boucle en permet au coût mesuré,
+ * doublé quand la file dépasse les 3/4 de capacity pour absorber une rafale ;
+ * au moins 1 (toujours progresser), au plus depth. 0 si la file est vide.
+ */
+inline uint16_t oscDrainBudget(uint32_t depth, uint32_t capacity, uint32_t budgetUs, uint32_t costUs) {
+    if (depth == 0) {
+        return 0;
+    }
+    uint32_t budget = budgetUs / (costUs > 0 ? costUs : 1);
+    if (depth * 4 >= capacity * 3) {
+        budget *= 2;
+    }
+    if (budget < 1) budget = 1;
+    if (budget > depth) budget = depth;
+    return (uint16_t)budget;
+}
+
+// Moyenne glissante (1/8) du coût d'un datagramme, base du budget de vidage
+inline uint32_t oscUpdateSendCost(uint32_t costUs, int32_t sampleUs) {
+    return (uint32_t)((int32_t)costUs + (sampleUs - (int32_t)costUs) / 8);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/**
+ * @brief Dernière valeur par source (composant), sans verrou
+ *
+ * Une case par index de composant (N <= 32) protégée par un seqlock,
+ * plus un masque atomique des cases en attente d'envoi :
+ * - store() côté producteur : écrase la valeur en attente (O(1) par index)
+ * - takePending() + read() côté consommateur : récupère et efface le masque, puis lit
+ *   chaque case marquée (remise en attente si le producteur écrivait)
+ *
+ * La profondeur est bornée par le nombre de sources actives, et non par
+ * la vitesse à laquelle les valeurs changent.
+ */
+template <typename T, uint8_t N>
+class OSCLatest {
+    static_assert(N >= 1 && N <= 32, "OSCLatest: 32 sources maximum (masque 32 bits)");
+
+public:
+    OSCLatest() : pending(0) {
+        for (uint8_t i = 0; i < N; i++) {
+            slots[i].seq.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Producteur : retourne true si une valeur en attente a été remplacée
+    bool store(uint8_t source, const T& item) {
+        if (source >= N) {
+            return false;
+        }
+        Slot& slot = slots[source];
+        const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed); // impair : écriture en cours
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.item = item;
+        slot.seq.store(seq + 2, std::memory_order_release);
+        const uint32_t bit = 1UL << source;
+        return (pending.fetch_or(bit, std::memory_order_acq_rel) & bit) != 0;
+    }
+
+    // Consommateur : retire atomiquement l'ensemble des sources en attente
+    uint32_t takePending() {
+        return pending.exchange(0, std::memory_order_acq_rel);
+    }
+
+    // Consommateur : lecture cohérente d'une case (après takePending).
+    // Retourne false si le producteur écrivait : ne jamais boucler ici, le
+    // producteur peut être préempté par le consommateur (ESP32-C3 mono-cœur).
+    bool read(uint8_t source, T& item) const {
+        const Slot& slot = slots[source];
+        const uint32_t before = slot.seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        item = slot.item;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.seq.load(std::memory_order_relaxed) == before;
+    }
+
+    // Producteur : une valeur de cette source attend-elle déjà ?
+    bool isPending(uint8_t source) const {
+        return source < N && (pending.load(std::memory_order_acquire) & (1UL << source)) != 0;
+    }
+
+    // Consommateur : remet une source en attente (envoi reporté)
+    void restore(uint8_t source) {
+        if (source < N) {
+            pending.fetch_or(1UL << source, std::memory_order_acq_rel);
+        }
+    }
+
+    uint8_t size() const {
+        return (uint8_t)__builtin_popcount(pending.load(std::memory_order_acquire));
+    }
+
+    void clear() {
+        pending.store(0, std::memory_order_release);
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        T item;
+    };
+
+    Slot slots[N];
+    std::atomic<uint32_t> pending;
+};
@@ -0,0 +1,481 @@
+#include "OSCQuery.h"
+
+// Instance globale
+OSCQueryServer g_oscQuery;
+
+// Chaîne JSON échappée (adresses et descriptions viennent de la config NVS)
+static void appendJsonString(String& json, const char* text) {
+    json += '"';
+    for (const char* p = text; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            json += '\\';
+            json += *p;
+        } else if ((uint8_t)*p >= 0x20) {
+            json += *p;
+        }
+    }
+    json += '"';
+}
+
+// Valeur d'un champ chaîne ("KEY":"valeur") dans une commande JSON courte
+static bool readJsonStringField(const char* text, const char* key, char* out, size_t outSize) {
+    char pattern[16];
+    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+    const char* p = strstr(text, pattern);
+    if (!p) {
+        return false;
+    }
+    p += strlen(pattern);
+    while (*p == ' ' || *p == ':') {
+        p++;
+    }
+    if (*p != '"') {
+        return false;
+    }
+    p++;
+    size_t n = 0;
+    while (*p && *p != '"' && n + 1 < outSize) {
+        out[n++] = *p++;
+    }
+    out[n] = '\0';
+    return *p == '"';
+}
+
+OSCQueryServer::OSCQueryServer()
+    : socket("/"), handler(*this), lock(nullptr), valueLock(portMUX_INITIALIZER_UNLOCKED),
+      nodeCount(0), published(false), listenMask(0), oscPort(OSC_LOCAL_PORT) {
+    lock = xSemaphoreCreateMutex();
+    strncpy(name, "esp32server", sizeof(name));
+    memset(listeners, 0, sizeof(listeners));
+    publish(nullptr, 0);
+}
+
+void OSCQueryServer::attach(AsyncWebServer& server) {
+    // Handler HTTP avant la route "/" de l'UI : les handlers sont essayés dans l'ordre d'ajout
+    server.addHandler(&handler);
+
+    // WebSocket sur "/" : ne répond qu'aux demandes d'upgrade, la page HTML reste servie
+    socket.onEvent([this](AsyncWebSocket* ws, AsyncWebSocketClient* client, AwsEventType type,
+                          void* arg, uint8_t* data, size_t len) {
+        onSocketEvent(client, type, arg, data, len);
+    });
+    server.addHandler(&socket);
+}
+
+void OSCQueryServer::setName(const char* hostname) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    strncpy(name, hostname, sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    xSemaphoreGive(lock);
+}
+
+void OSCQueryServer::publish(const OSCQueryEntry* entries, uint8_t count) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+
+    // Racine "/"
+    Node& root = nodes[0];
+    memset(&root, 0, sizeof(root));
+    strcpy(root.path, "/");
+    root.nameOffset = 1;
+    root.parent = NONE;
+    root.firstChild = NONE;
+    root.nextSibling = NONE;
+    root.entry = NONE;
+    nodeCount = 1;
+    memset(nodeOf, NONE, sizeof(nodeOf));
+
+    for (uint8_t e = 0; e < count; e++) {
+        const OSCQueryEntry& entry = entries[e];
+        const uint8_t node = entry.index < 32 ? addPath(entry.address) : NONE;
+        if (node == NONE) {
+            Serial.printf("[OSCQuery] Adresse ignorée: %s\n", entry.address);
+            continue;
+        }
+        // Plusieurs composants peuvent partager une adresse : type de la première entrée
+        Node& target = nodes[node];
+        if (target.entry == NONE) {
+            target.entry = e;
+            target.messageType = entry.messageType;
+        }
+        target.access |= entry.access;
+        nodeOf[entry.index] = node;
+        for (uint8_t n = node; n != NONE; n = nodes[n].parent) {
+            nodes[n].components |= 1UL << entry.index;
+        }
+    }
+
+    json = "";
+    json.reserve(128 + nodeCount * 160);
+    writeNode(json, 0, entries);
+    refreshListenMasks();
+
+    const bool notifyClients = published;
+    published = true;
+    xSemaphoreGive(lock);
+
+    // Les clients rechargent l'arbre (extension PATH_CHANGED)
+    if (notifyClients && getListenerCount() > 0) {
+        socket.textAll("{\"COMMAND\":\"PATH_CHANGED\",\"DATA\":\"/\"}");
+    }
+}
+
+uint8_t OSCQueryServer::addPath(const char* address) {
+    if (!address || address[0] != '/' || address[1] == '\0') {
+        return NONE;
+    }
+    uint8_t node = 0;
+    const char* p = address + 1;
+    while (*p) {
+        const char* end = strchr(p, '/');
+        const size_t len = end ? (size_t)(end - p) : strlen(p);
+        const size_t pathLength = (size_t)(p - address) + len;
+        if (len == 0 || pathLength >= OSC_TEMPLATE_ADDRESS_SIZE) {
+            return NONE;
+        }
+
+        uint8_t last = NONE;
+        uint8_t child = nodes[node].firstChild;
+        while (child != NONE) {
+            if (strncmp(nodes[child].path, address, pathLength) == 0 && nodes[child].path[pathLength] == '\0') {
+                break;
+            }
+            last = child;
+            child = nodes[child].nextSibling;
+        }
+        if (child == NONE) {
+            if (nodeCount >= MAX_NODES) {
+                return NONE;
+            }
+            child = nodeCount++;
+            Node& created = nodes[child];
+            memset(&created, 0, sizeof(created));
+            memcpy(created.path, address, pathLength);
+            created.path[pathLength] = '\0';
+            created.nameOffset = (uint8_t)(p - address);
+            created.parent = node;
+            created.firstChild = NONE;
+            created.nextSibling = NONE;
+            created.entry = NONE;
+            if (last == NONE) {
+                nodes[node].firstChild = child;
+            } else {
+                nodes[last].nextSibling = child;
+            }
+        }
+        node = child;
+        p += len;
+        if (*p == '/') {
+            p++;
+        }
+    }
+    return node;
+}
+
+uint8_t OSCQueryServer::findNode(const char* path) const {
+    if (strcmp(path, "/") == 0) {
+        return 0;
+    }
+    // Tolère un '/' final ("/mixer/")
+    size_t length = strlen(path);
+    if (length > 1 && path[length - 1] == '/') {
+        length--;
+    }
+    for (uint8_t n = 1; n < nodeCount; n++) {
+        if (strncmp(nodes[n].path, path, length) == 0 && nodes[n].path[length] == '\0') {
+            return n;
+        }
+    }
+    return NONE;
+}
+
+void OSCQueryServer::writeNode(String& out, uint8_t node, const OSCQueryEntry* entries) {
+    Node& n = nodes[node];
+    n.jsonStart = (uint16_t)out.length();
+
+    out += "{\"FULL_PATH\":";
+    appendJsonString(out, n.path);
+    if (n.entry != NONE) {
+        out += n.messageType == 0 ? ",\"TYPE\":\"f\"" : ",\"TYPE\":\"iii\"";
+        out += ",\"ACCESS\":";
+        out += String(n.access);
+        out += n.messageType == 0
+            ? ",\"RANGE\":[{\"MIN\":0.0,\"MAX\":1.0}]"
+            : ",\"RANGE\":[{\"MIN\":0,\"MAX\":127},{\"MIN\":0,\"MAX\":127},{\"MIN\":1,\"MAX\":16}]";
+        const char* description = entries[n.entry].description;
+        if (description && description[0] != '\0') {
+            out += ",\"DESCRIPTION\":";
+            appendJsonString(out, description);
+        }
+    } else {
+        out += ",\"ACCESS\":0";
+        if (node == 0) {
+            out += ",\"DESCRIPTION\":";
+            appendJsonString(out, name);
+        }
+    }
+
+    if (n.firstChild != NONE) {
+        out += ",\"CONTENTS\":{";
+        for (uint8_t child = n.firstChild; child != NONE; child = nodes[child].nextSibling) {
+            if (child != n.firstChild) {
+                out += ',';
+            }
+            appendJsonString(out, nodes[child].path + nodes[child].nameOffset);
+            out += ':';
+            writeNode(out, child, entries);
+        }
+        out += '}';
+    }
+    out += '}';
+    n.jsonEnd = (uint16_t)out.length();
+}
+
+void OSCQueryServer::notify(uint8_t index, const OSCPacketTemplate& packet, const uint32_t* args) {
+    if (index >= 32) {
+        return;
+    }
+    const uint8_t node = nodeOf[index];
+    if (node == NONE) {
+        return;
+    }
+    const uint8_t argCount = packet.argCount();
+
+    // Dernière valeur (?VALUE) et clients abonnés à ce composant
+    uint32_t targets[MAX_LISTENERS];
+    uint8_t targetCount = 0;
+    portENTER_CRITICAL(&valueLock);
+    memcpy(nodes[node].value, args, argCount * sizeof(uint32_t));
+    nodes[node].hasValue = true;
+    if (listenMask & (1UL << index)) {
+        for (uint8_t l = 0; l < MAX_LISTENERS; l++) {
+            if (listeners[l].clientId != 0 && (listeners[l].mask & (1UL << index))) {
+                targets[targetCount++] = listeners[l].clientId;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&valueLock);
+    if (targetCount == 0) {
+        return;
+    }
+
+    // Même message que sur UDP, en trame binaire WebSocket
+    uint8_t packetBuffer[OSC_TEMPLATE_HEADER_SIZE + 12];
+    OSCWriter writer(packetBuffer, sizeof(packetBuffer));
+    writer.bytes(packet.header, packet.headerLength);
+    for (uint8_t a = 0; a < argCount; a++) {
+        writer.uint32(args[a]);
+    }
+    if (!writer.ok()) {
+        return;
+    }
+    for (uint8_t t = 0; t < targetCount; t++) {
+        // File du client pleine : valeur écartée, la suivante la remplace
+        if (socket.availableForWrite(targets[t])) {
+            socket.binary(targets[t], packetBuffer, writer.length());
+        }
+    }
+}
+
+void OSCQueryServer::update() {
+    socket.cleanupClients();
+}
+
+uint8_t OSCQueryServer::getListenerCount() const {
+    uint8_t count = 0;
+    for (uint8_t l = 0; l < MAX_LISTENERS; l++) {
+        if (listeners[l].clientId != 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool OSCQueryServer::RequestHandler::canHandle(AsyncWebServerRequest* request) {
+    if (request->method() != HTTP_GET || request->isExpectedRequestedConnType(RCT_WS)) {
+        return false;
+    }
+    const String& url = request->url();
+    if (url == "/") {
+        // Un navigateur demande text/html : la racine reste l'UI
+        if (request->hasParam("HOST_INFO")) {
+            return true;
+        }
+        auto* accept = request->getHeader("Accept");
+        return !(accept && accept->value().indexOf("text/html") >= 0);
+    }
+    if (url.startsWith("/api/")) {
+        return false;
+    }
+    xSemaphoreTake(owner.lock, portMAX_DELAY);
+    const bool found = owner.findNode(url.c_str()) != NONE;
+    xSemaphoreGive(owner.lock);
+    return found;
+}
+
+void OSCQueryServer::RequestHandler::handleRequest(AsyncWebServerRequest* request) {
+    owner.handleRequest(request);
+}
+
+void OSCQueryServer::handleRequest(AsyncWebServerRequest* request) {
+    if (request->hasParam("HOST_INFO")) {
+        String info = "{\"NAME\":";
+        xSemaphoreTake(lock, portMAX_DELAY);
+        appendJsonString(info, name);
+        xSemaphoreGive(lock);
+        info += ",\"OSC_PORT\":" + String(oscPort);
+        info += ",\"OSC_TRANSPORT\":\"UDP\"";
+        info += ",\"EXTENSIONS\":{\"TYPE\":true,\"ACCESS\":true,\"VALUE\":true,\"RANGE\":true,"
+                "\"DESCRIPTION\":true,\"LISTEN\":true,\"PATH_CHANGED\":true}}";
+        request->send(200, "application/json", info);
+        return;
+    }
+
+    String body;
+    xSemaphoreTake(lock, portMAX_DELAY);
+    const uint8_t node = findNode(request->url().c_str());
+    if (node == NONE) {
+        xSemaphoreGive(lock);
+        request->send(404, "application/json", "{\"error\":\"path not found\"}");
+        return;
+    }
+
+    if (request->hasParam("VALUE")) {
+        const Node& n = nodes[node];
+        uint32_t value[3];
+        portENTER_CRITICAL(&valueLock);
+        const bool hasValue = n.hasValue;
+        memcpy(value, n.value, sizeof(value));
+        portEXIT_CRITICAL(&valueLock);
+        if (n.entry == NONE || !hasValue) {
+            xSemaphoreGive(lock);
+            request->send(204);
+            return;
+        }
+        body = "{\"VALUE\":[";
+        if (n.messageType == 0) {
+            float f;
+            memcpy(&f, &value[0], sizeof(f));
+            body += String(f, 4);
+        } else {
+            body += String(value[0]) + "," + String(value[1]) + "," + String(value[2]);
+        }
+        body += "]}";
+    } else {
+        // Sous-arbre servi depuis le cache (plage mémorisée à la construction)
+        body = json.substring(nodes[node].jsonStart, nodes[node].jsonEnd);
+    }
+    xSemaphoreGive(lock);
+    request->send(200, "application/json", body);
+}
+
+void OSCQueryServer::onSocketEvent(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len) {
+    if (type == WS_EVT_DISCONNECT) {
+        xSemaphoreTake(lock, portMAX_DELAY);
+        for (uint8_t l = 0; l < MAX_LISTENERS; l++) {
+            if (listeners[l].clientId == client->id()) {
+                portENTER_CRITICAL(&valueLock);
+                listeners[l].clientId = 0;
+                portEXIT_CRITICAL(&valueLock);
+                listeners[l].pathCount = 0;
+            }
+        }
+        refreshListenMasks();
+        xSemaphoreGive(lock);
+    } else if (type == WS_EVT_DATA) {
+        // Commandes JSON courtes, en une seule trame texte
+        AwsFrameInfo* info = (AwsFrameInfo*)arg;
+        if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
+            char text[128];
+            if (len >= sizeof(text)) {
+                return;
+            }
+            memcpy(text, data, len);
+            text[len] = '\0';
+            handleCommand(client->id(), text, len);
+        }
+    }
+}
+
+void OSCQueryServer::handleCommand(uint32_t clientId, const char* text, size_t len) {
+    char command[16];
+    char path[OSC_TEMPLATE_ADDRESS_SIZE];
+    if (!readJsonStringField(text, "COMMAND", command, sizeof(command)) ||
+        !readJsonStringField(text, "DATA", path, sizeof(path)) || path[0] != '/') {
+        return;
+    }
+    const bool listen = strcmp(command, "LISTEN") == 0;
+    if (!listen && strcmp(command, "IGNORE") != 0) {
+        return;
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    Listener* listener = nullptr;
+    Listener* freeSlot = nullptr;
+    for (uint8_t l = 0; l < MAX_LISTENERS; l++) {
+        if (listeners[l].clientId == clientId) {
+            listener = &listeners[l];
+        } else if (listeners[l].clientId == 0 && !freeSlot) {
+            freeSlot = &listeners[l];
+        }
+    }
+
+    if (listen) {
+        if (!listener && freeSlot) {
+            listener = freeSlot;
+            listener->pathCount = 0;
+            portENTER_CRITICAL(&valueLock);
+            listener->clientId = clientId;
+            portEXIT_CRITICAL(&valueLock);
+        }
+        if (!listener) {
+            Serial.println("[OSCQuery] LISTEN refusé: trop de clients");
+        } else {
+            bool known = false;
+            for (uint8_t p = 0; p < listener->pathCount; p++) {
+                known |= strcmp(listener->paths[p], path) == 0;
+            }
+            if (!known && listener->pathCount < MAX_LISTEN_PATHS) {
+                strcpy(listener->paths[listener->pathCount++], path);
+            }
+        }
+    } else if (listener) {
+        for (uint8_t p = 0; p < listener->pathCount; p++) {
+            if (strcmp(listener->paths[p], path) == 0) {
+                listener->pathCount--;
+                if (p != listener->pathCount) {
+                    strcpy(listener->paths[p], listener->paths[listener->pathCount]);
+                }
+                break;
+            }
+        }
+        if (listener->pathCount == 0) {
+            portENTER_CRITICAL(&valueLock);
+            listener->clientId = 0;
+            portEXIT_CRITICAL(&valueLock);
+        }
+    }
+    refreshListenMasks();
+    xSemaphoreGive(lock);
+}
+
+void OSCQueryServer::refreshListenMasks() {
+    // Chemins -> composants (un chemin de conteneur couvre tout son sous-arbre)
+    uint32_t masks[MAX_LISTENERS];
+    uint32_t all = 0;
+    for (uint8_t l = 0; l < MAX_LISTENERS; l++) {
+        masks[l] = 0;
+        for (uint8_t p = 0; listeners[l].clientId != 0 && p < listeners[l].pathCount; p++) {
+            const uint8_t node = findNode(listeners[l].paths[p]);
+            if (node != NONE) {
+                masks[l] |= nodes[node].components;
+            }
+        }
+        all |= masks[l];
+    }
+    portENTER_CRITICAL(&valueLock);
+    for (uint8_t l = 0; l < MAX_LISTENERS; l++) {
+        listeners[l].mask = masks[l];
+    }
+    listenMask = all;
+    portEXIT_CRITICAL(&valueLock);
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <AsyncWebSocket.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "OSCCodec.h"
+#include "OSCTransport.h"
+
+// Accès OSCQuery d'un noeud (spécification OSCQuery : 0 aucun, 1 lecture, 2 écriture, 3 les deux)
+enum OSCQueryAccess : uint8_t {
+    OSCQUERY_ACCESS_NONE = 0,
+    OSCQUERY_ACCESS_READ = 1,
+    OSCQUERY_ACCESS_WRITE = 2,
+    OSCQUERY_ACCESS_READ_WRITE = 3
+};
+
+// Adresse exposée par un composant (fournie par ComponentManager au chargement)
+struct OSCQueryEntry {
+    const char* address;     // Adresse effective (en-tête du OSCPacketTemplate)
+    const char* description; // Texte libre (ex: "GPIO4 potentiometer")
+    uint8_t index;           // Index du composant (0-31)
+    uint8_t messageType;     // 0 = ",f", 1 = ",iii" (cf. OSCPacketTemplate)
+    uint8_t access;          // OSCQueryAccess
+};
+
+/**
+ * @brief Serveur OSCQuery sur le serveur HTTP existant (port 80)
+ *
+ * Expose l'espace de noms OSC des composants pour que Pd, Max, TouchOSC...
+ * le découvrent au lieu d'être configurés à la main (mDNS _oscjson._tcp) :
+ * - GET /            arbre JSON (clients sans Accept: text/html, le navigateur garde l'UI)
+ * - GET /a/b         sous-arbre du noeud /a/b
+ * - GET /?HOST_INFO  nom, port et transport OSC, extensions supportées
+ * - GET /a/b?VALUE   dernière valeur émise sur /a/b
+ * - WebSocket /      commandes LISTEN / IGNORE ; les valeurs écoutées arrivent
+ *                    en trames binaires OSC, seulement pour les adresses demandées
+ *
+ * L'arbre JSON est construit une seule fois par publish() (appelé depuis loop()
+ * après un rechargement de configuration), puis servi depuis le cache ; chaque
+ * noeud y mémorise sa plage [début, fin) pour servir un sous-arbre sans reconstruction.
+ * notify() (chemin d'émission) ne coûte qu'un test de masque sans abonné.
+ */
+class OSCQueryServer {
+public:
+    static constexpr uint8_t MAX_NODES = 64;
+    static constexpr uint8_t MAX_LISTENERS = 4;
+    static constexpr uint8_t MAX_LISTEN_PATHS = 8;
+
+    OSCQueryServer();
+
+    // Enregistre le handler HTTP et le WebSocket : avant la route "/" de l'UI
+    void attach(AsyncWebServer& server);
+    void setName(const char* name);
+    void setOscPort(uint16_t port) { oscPort = port; }
+
+    // loop() : nouvelle table des adresses, arbre JSON reconstruit ici
+    void publish(const OSCQueryEntry* entries, uint8_t count);
+
+    // loop() : valeur émise par le composant index (en-tête pré-encodé + arguments)
+    void notifyFloat(uint8_t index, const OSCPacketTemplate& packet, float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        notify(index, packet, &bits);
+    }
+    void notifyMidi(uint8_t index, const OSCPacketTemplate& packet, uint8_t data1, uint8_t data2, uint8_t channel) {
+        const uint32_t args[3] = { data1, data2, channel };
+        notify(index, packet, args);
+    }
+
+    // loop() : libère les clients WebSocket fermés
+    void update();
+
+    uint8_t getListenerCount() const;
+    uint16_t getNodeCount() const { return nodeCount; }
+
+private:
+    static constexpr uint8_t NONE = 0xFF;
+
+    struct Node {
+        char path[OSC_TEMPLATE_ADDRESS_SIZE]; // Chemin complet ("/" pour la racine)
+        uint8_t nameOffset;   // Début du dernier segment dans path
+        uint8_t parent;
+        uint8_t firstChild;
+        uint8_t nextSibling;
+        uint8_t entry;        // Première entrée se terminant ici (NONE : conteneur)
+        uint8_t messageType;
+        uint8_t access;
+        bool hasValue;
+        uint32_t components;  // Composants de ce noeud et de ses descendants
+        uint32_t value[3];    // Derniers arguments émis (bits bruts)
+        uint16_t jsonStart;   // Plage du noeud dans le cache JSON
+        uint16_t jsonEnd;
+    };
+
+    struct Listener {
+        uint32_t clientId;    // 0 : emplacement libre
+        uint32_t mask;        // Composants écoutés (résolu depuis paths)
+        uint8_t pathCount;
+        char paths[MAX_LISTEN_PATHS][OSC_TEMPLATE_ADDRESS_SIZE];
+    };
+
+    class RequestHandler : public AsyncWebHandler {
+    public:
+        explicit RequestHandler(OSCQueryServer& owner) : owner(owner) {}
+        bool canHandle(AsyncWebServerRequest* request) override;
+        void handleRequest(AsyncWebServerRequest* request) override;
+    private:
+        OSCQueryServer& owner;
+    };
+
+    void notify(uint8_t index, const OSCPacketTemplate& packet, const uint32_t* args);
+
+    uint8_t addPath(const char* address);
+    uint8_t findNode(const char* path) const;
+    void writeNode(String& json, uint8_t node, const OSCQueryEntry* entries);
+    void handleRequest(AsyncWebServerRequest* request);
+    void onSocketEvent(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
+    void handleCommand(uint32_t clientId, const char* text, size_t len);
+    void refreshListenMasks(); // Sous lock
+
+    AsyncWebSocket socket;
+    RequestHandler handler;
+    SemaphoreHandle_t lock;   // Arbre, cache JSON, chemins écoutés (loop et tâche async_tcp)
+    portMUX_TYPE valueLock;   // Valeurs et masques d'écoute (lus par notify())
+
+    Node nodes[MAX_NODES];
+    uint8_t nodeCount;
+    uint8_t nodeOf[32];       // Composant -> noeud de son adresse
+    String json;              // Arbre complet mis en cache
+    bool published;
+
+    Listener listeners[MAX_LISTENERS];
+    uint32_t listenMask;      // OU des masques des clients
+
+    char name[32];
+    uint16_t oscPort;
+};
+
+// Instance globale (routes enregistrées par setupWebAPI, table publiée par ComponentManager)
+extern OSCQueryServer g_oscQuery;
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "OSCCodec.h"
+
+// Adresses du protocole de livraison fiable (événements discrets)
+//   /esp32/seq  ,ii session seq   premier élément du #bundle porteur de l'événement
+//   /esp32/ack  ,i... seq         accusés sélectifs (récepteur -> port 8001)
+//   /esp32/nack ,i... seq         trous détectés : retransmission immédiate
+static constexpr const char* OSC_RELIABLE_SEQ_ADDRESS = "/esp32/seq";
+static constexpr const char* OSC_RELIABLE_ACK_ADDRESS = "/esp32/ack";
+static constexpr const char* OSC_RELIABLE_NACK_ADDRESS = "/esp32/nack";
+
+// Datagramme porteur : bundle (16) + /esp32/seq (4 + 24) + événement (4 + en-tête + 12)
+static constexpr size_t OSC_RELIABLE_MAX_PACKET = 48 + OSC_TEMPLATE_HEADER_SIZE + 12;
+
+/**
+ * @brief Fenêtre d'émission des événements discrets en attente d'accusé
+ *
+ * Chaque événement (bouton, note) part dans un #bundle « immédiat » précédé
+ * de /esp32/seq : un récepteur qui ignore le protocole reçoit l'événement
+ * tel quel, un récepteur fiable déduplique par (session, seq) et accuse.
+ *
+ * - Retransmission sélective : sur NACK, ou faute d'accusé après rto()
+ *   (2 x RTT lissé, algorithme de Karn : seuls les accusés d'un envoi
+ *   unique mesurent le RTT), doublé à chaque retransmission de la case
+ *   jusqu'à MAX_RTO_US
+ * - Échéance : au-delà de deadline, l'événement est abandonné (une note
+ *   trop tardive ne vaut plus rien) ; fenêtre pleine : le plus ancien est
+ *   abandonné, l'émetteur ne bloque jamais
+ *
+ * Utilisée uniquement par la tâche d'envoi (pas de verrou).
+ */
+class OSCReliableWindow {
+public:
+    static constexpr uint8_t SIZE = 16;
+    static constexpr uint32_t MIN_RTO_US = 10000;
+    static constexpr uint32_t INITIAL_RTT_US = 20000;
+    static constexpr uint32_t MAX_RTO_US = 1000000;
+    static constexpr uint8_t MAX_BACKOFF_SHIFT = 6;
+
+    struct Slot {
+        uint32_t seq;
+        uint32_t firstSent; // micros() du premier envoi
+        uint32_t lastSent;
+        uint16_t length;
+        uint8_t formats;    // OSCDestinationFormat de l'événement
+        uint8_t retries;
+        bool used;
+        uint8_t data[OSC_RELIABLE_MAX_PACKET];
+    };
+
+    OSCReliableWindow() : session(0), nextSeq(1), deadlineUs(250000), srttUs(INITIAL_RTT_US) {
+        clear();
+    }
+
+    void clear() {
+        for (uint8_t i = 0; i < SIZE; i++) {
+            slots[i].used = false;
+        }
+    }
+
+    void setSession(uint32_t id) { session = id; }
+    uint32_t getSession() const { return session; }
+    void setDeadline(uint32_t microseconds) { deadlineUs = microseconds; }
+    uint32_t getDeadline() const { return deadlineUs; }
+    uint32_t getSmoothedRtt() const { return srttUs; }
+
+    uint32_t rto() const {
+        uint32_t value = srttUs * 2;
+        if (value < MIN_RTO_US) value = MIN_RTO_US;
+        if (value > deadlineUs / 2) value = deadlineUs / 2;
+        return value;
+    }
+
+    // Délai avant la retransmission suivante d'une case déjà retransmise retries fois
+    uint32_t rto(uint8_t retries) const {
+        const uint32_t base = rto();
+        const uint32_t value = base << (retries < MAX_BACKOFF_SHIFT ? retries : MAX_BACKOFF_SHIFT);
+        const uint32_t cap = base > MAX_RTO_US ? base : MAX_RTO_US;
+        return value < cap ? value : cap;
+    }
+
+    // Encode l'événement (octets déjà sérialisés) dans une case libre ; la case
+    // la plus ancienne est réutilisée si la fenêtre est pleine (evicted = true)
+    Slot* open(const uint8_t* message, size_t length, uint8_t formats, uint32_t now, bool& evicted) {
+        evicted = false;
+        Slot* slot = nullptr;
+        for (uint8_t i = 0; i < SIZE && !slot; i++) {
+            if (!slots[i].used) {
+                slot = &slots[i];
+            }
+        }
+        if (!slot) {
+            slot = &slots[0];
+            for (uint8_t i = 1; i < SIZE; i++) {
+                if ((int32_t)(slots[i].seq - slot->seq) < 0) {
+                    slot = &slots[i];
+                }
+            }
+            evicted = true;
+        }
+
+        OSCWriter writer(slot->data, sizeof(slot->data));
+        writer.beginBundle(OSC_TIMETAG_IMMEDIATE);
+        size_t mark = writer.beginElement();
+        writer.address(OSC_RELIABLE_SEQ_ADDRESS);
+        writer.typeTags(",ii");
+        writer.int32((int32_t)session);
+        writer.int32((int32_t)nextSeq);
+        writer.endElement(mark);
+        mark = writer.beginElement();
+        writer.bytes(message, length);
+        writer.endElement(mark);
+        if (!writer.ok()) {
+            slot->used = false;
+            return nullptr;
+        }
+
+        slot->seq = nextSeq++;
+        slot->firstSent = now;
+        slot->lastSent = now;
+        slot->length = (uint16_t)writer.length();
+        slot->formats = formats;
+        slot->retries = 0;
+        slot->used = true;
+        return slot;
+    }
+
+    // Accusé : libère la case ; retourne false si seq n'est plus en attente
+    bool ack(uint32_t seq, uint32_t now) {
+        Slot* slot = find(seq);
+        if (!slot) {
+            return false;
+        }
+        if (slot->retries == 0) {
+            // RTT mesurable (Karn) : moyenne glissante 1/8
+            const uint32_t sample = now - slot->firstSent;
+            srttUs = srttUs - (srttUs >> 3) + (sample >> 3);
+        }
+        slot->used = false;
+        return true;
+    }
+
+    Slot* find(uint32_t seq) {
+        for (uint8_t i = 0; i < SIZE; i++) {
+            if (slots[i].used && slots[i].seq == seq) {
+                return &slots[i];
+            }
+        }
+        return nullptr;
+    }
+
+    // Case index (parcours par la tâche d'envoi : échéances et retransmissions)
+    Slot* slot(uint8_t index) { return slots[index].used ? &slots[index] : nullptr; }
+
+    bool expired(const Slot& slot, uint32_t now) const {
+        return (uint32_t)(now - slot.firstSent) >= deadlineUs;
+    }
+    bool due(const Slot& slot, uint32_t now) const {
+        return (uint32_t)(now - slot.lastSent) >= rto(slot.retries);
+    }
+
+    uint8_t pending() const {
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < SIZE; i++) {
+            count += slots[i].used ? 1 : 0;
+        }
+        return count;
+    }
+
+private:
+    Slot slots[SIZE];
+    uint32_t session;
+    uint32_t nextSeq;
+    uint32_t deadlineUs;
+    uint32_t srttUs;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/**
+ * @brief File circulaire SPSC (un producteur, un consommateur) sans verrou
+ *
+ * Remplace la queue FreeRTOS pour les messages OSC sortants :
+ * - Stockage inline de N enregistrements POD (aucune allocation)
+ * - push() côté producteur (boucle de scan des composants)
+ * - pop() côté consommateur (tâche d'envoi réseau)
+ * - Indices libres 16 bits masqués par N (N puissance de 2)
+ *
+ * pushOverwrite() permet au producteur d'écarter le plus ancien élément
+ * quand la file est pleine (politique drop-oldest) : le producteur avance
+ * alors tail par CAS, et le consommateur valide chaque lecture par CAS
+ * sur tail (une lecture concurrente d'une case écrasée est rejouée).
+ *
+ * T doit être copiable par memcpy (pas de String ni de pointeur possédant).
+ */
+template <typename T, uint16_t N>
+class OSCRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "OSCRing: N doit être une puissance de 2");
+    static_assert(N <= 0x8000, "OSCRing: N trop grand pour des indices 16 bits");
+
+public:
+    OSCRing() : head(0), tail(0) {}
+
+    // Producteur : retourne false si la file est pleine (rien n'est écrit)
+    bool push(const T& item) {
+        const uint16_t h = head.load(std::memory_order_relaxed);
+        const uint16_t t = tail.load(std::memory_order_acquire);
+        if ((uint16_t)(h - t) >= N) {
+            return false;
+        }
+        slots[h & MASK] = item;
+        head.store((uint16_t)(h + 1), std::memory_order_release);
+        return true;
+    }
+
+    // Producteur : si la file est pleine, écarte l'élément le plus ancien.
+    // Retourne false si un élément a été écarté (l'élément fourni est toujours écrit).
+    bool pushOverwrite(const T& item) {
+        const uint16_t h = head.load(std::memory_order_relaxed);
+        uint16_t t = tail.load(std::memory_order_acquire);
+        bool evicted = false;
+        while ((uint16_t)(h - t) >= N) {
+            // Prendre la place du plus ancien ; en cas d'échec le consommateur
+            // vient de libérer une case (t est rechargé par le CAS)
+            if (tail.compare_exchange_weak(t, (uint16_t)(t + 1),
+                                           std::memory_order_acq_rel, std::memory_order_acquire)) {
+                evicted = true;
+                break;
+            }
+        }
+        slots[h & MASK] = item;
+        head.store((uint16_t)(h + 1), std::memory_order_release);
+        return !evicted;
+    }
+
+    // Consommateur : retourne false si la file est vide
+    bool pop(T& item) {
+        uint16_t t = tail.load(std::memory_order_acquire);
+        for (;;) {
+            const uint16_t h = head.load(std::memory_order_acquire);
+            if (h == t) {
+                return false;
+            }
+            item = slots[t & MASK];
+            // Si le producteur a écarté cet élément pendant la copie, rejouer
+            if (tail.compare_exchange_strong(t, (uint16_t)(t + 1),
+                                             std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return true;
+            }
+        }
+    }
+
+    // Consommateur : vide la file sans lire les éléments
+    void clear() {
+        uint16_t t = tail.load(std::memory_order_acquire);
+        while (!tail.compare_exchange_weak(t, head.load(std::memory_order_acquire),
+                                           std::memory_order_acq_rel, std::memory_order_acquire)) {
+        }
+    }
+
+    uint16_t size() const {
+        return (uint16_t)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+    }
+
+    bool empty() const { return size() == 0; }
+    bool full() const { return size() >= N; }
+    static constexpr uint16_t capacity() { return N; }
+
+private:
+    static constexpr uint16_t MASK = N - 1;
+
+    T slots[N];
+    std::atomic<uint16_t> head; // écrit uniquement par le producteur
+    std::atomic<uint16_t> tail; // avancé par le consommateur (et par pushOverwrite)
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "OSCCodec.h"
+
+// Octets spéciaux SLIP (RFC 1055)
+static constexpr uint8_t OSC_SLIP_END = 0xC0;
+static constexpr uint8_t OSC_SLIP_ESC = 0xDB;
+static constexpr uint8_t OSC_SLIP_ESC_END = 0xDC;
+static constexpr uint8_t OSC_SLIP_ESC_ESC = 0xDD;
+
+// Pire cas : chaque octet échappé, plus les END d'ouverture et de fermeture
+static constexpr size_t OSC_SLIP_MAX_ENCODED = 2 * OSC_MAX_PACKET_SIZE + 2;
+
+/**
+ * @brief Encode un paquet OSC déjà sérialisé en trame SLIP (OSC 1.1)
+ *
+ * Double END (avant et après) : l'END d'ouverture termine les octets
+ * parasites reçus avant la trame (logs sur le même port, connexion en
+ * cours de flux), que le récepteur rejette comme paquet OSC invalide.
+ * Les segments sans octet spécial sont copiés d'un bloc.
+ *
+ * Retourne la taille de la trame, 0 si out est trop petit.
+ */
+inline size_t oscSlipEncode(const uint8_t* data, size_t length, uint8_t* out, size_t capacity) {
+    size_t pos = 0;
+    if (capacity < length + 2) {
+        return 0;
+    }
+    out[pos++] = OSC_SLIP_END;
+    size_t i = 0;
+    while (i < length) {
+        // Segment littéral jusqu'au prochain octet à échapper
+        size_t run = i;
+        while (run < length && data[run] != OSC_SLIP_END && data[run] != OSC_SLIP_ESC) {
+            run++;
+        }
+        const size_t literal = run - i;
+        if (pos + literal + 1 > capacity) {
+            return 0;
+        }
+        memcpy(out + pos, data + i, literal);
+        pos += literal;
+        i = run;
+        if (i < length) {
+            if (pos + 3 > capacity) {
+                return 0;
+            }
+            out[pos++] = OSC_SLIP_ESC;
+            out[pos++] = data[i] == OSC_SLIP_END ? OSC_SLIP_ESC_END : OSC_SLIP_ESC_ESC;
+            i++;
+        }
+    }
+    out[pos++] = OSC_SLIP_END;
+    return pos;
+}
+
+/**
+ * @brief Décodeur SLIP incrémental (octet par octet, état conservé entre appels)
+ *
+ * feed() retourne true quand une trame complète est disponible dans
+ * data()/size() ; elle reste valide jusqu'au feed() suivant. Les trames
+ * vides (double END) sont ignorées, les trames trop grandes écartées.
+ */
+class OSCSlipDecoder {
+public:
+    OSCSlipDecoder() : length(0), escaped(false), overflow(false), ready(false), dropped(0) {}
+
+    bool feed(uint8_t byte) {
+        if (ready) {
+            ready = false;
+            length = 0;
+        }
+        if (byte == OSC_SLIP_END) {
+            const bool complete = length > 0 && !overflow;
+            if (overflow) {
+                dropped++;
+            }
+            escaped = false;
+            overflow = false;
+            if (complete) {
+                ready = true;
+                return true;
+            }
+            length = 0;
+            return false;
+        }
+        if (escaped) {
+            escaped = false;
+            if (byte == OSC_SLIP_ESC_END) {
+                byte = OSC_SLIP_END;
+            } else if (byte == OSC_SLIP_ESC_ESC) {
+                byte = OSC_SLIP_ESC;
+            } // Séquence invalide : octet conservé tel quel (RFC 1055)
+        } else if (byte == OSC_SLIP_ESC) {
+            escaped = true;
+            return false;
+        }
+        if (length >= sizeof(buffer)) {
+            overflow = true;
+            return false;
+        }
+        buffer[length++] = byte;
+        return false;
+    }
+
+    void reset() {
+        length = 0;
+        escaped = false;
+        overflow = false;
+        ready = false;
+    }
+
+    const uint8_t* data() const { return buffer; }
+    size_t size() const { return ready ? length : 0; }
+    uint32_t getDroppedFrames() const { return dropped; }
+
+private:
+    uint8_t buffer[OSC_MAX_PACKET_SIZE];
+    size_t length;
+    bool escaped;
+    bool overflow;
+    bool ready;
+    uint32_t dropped; // Trames trop grandes
+};
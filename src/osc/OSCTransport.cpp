@@ -0,0 +1,540 @@
+#include "OSCTransport.h"
+#include <WiFi.h>
+#include "../PinMapper.h"
+
+OSCTransport::OSCTransport()
+    : lock(nullptr), tableLock(nullptr), initialized(false), localPort(OSC_LOCAL_PORT), busySkips(0),
+      serialPorts(0), serialStarted(0), serialBaud(OSC_SERIAL_BAUD), lastSourcePort(SOURCE_UDP),
+      configLock(portMUX_INITIALIZER_UNLOCKED), configVersion(0), appliedConfigVersion(0) {
+    stagedConfig.targetIP[0] = '\0';
+    stagedConfig.targetPort = 8000;
+    stagedConfig.broadcast = false;
+    stagedConfig.interface = 0;
+    stagedConfig.destinationCount = 0;
+    stagedConfig.serialBaud = OSC_SERIAL_BAUD;
+}
+
+OSCTransport::~OSCTransport() {
+    end();
+    if (lock != nullptr) {
+        vSemaphoreDelete(lock);
+    }
+    if (tableLock != nullptr) {
+        vSemaphoreDelete(tableLock);
+    }
+}
+
+bool OSCTransport::begin(uint16_t local_port) {
+    if (initialized) {
+        return true;
+    }
+    if (lock == nullptr) {
+        lock = xSemaphoreCreateMutex();
+        tableLock = xSemaphoreCreateMutex();
+        if (lock == nullptr || tableLock == nullptr) {
+            Serial.println("[OSC] Erreur: mutex du transport indisponible");
+            return false;
+        }
+    }
+
+    localPort = local_port;
+    udp.setTimeout(1000); // Timeout 1s pour éviter les blocages
+    if (!udp.begin(localPort)) {
+        Serial.println("[OSC] Erreur: Impossible de démarrer UDP");
+        return false;
+    }
+
+    // Configuration WiFi optimisée pour la fiabilité
+    WiFi.setSleep(false); // Désactiver le sleep WiFi pour éviter les pertes
+    WiFi.setAutoReconnect(true); // Reconnexion automatique
+
+    // Reconstruire la table des destinations sur les événements WiFi
+    OSCDestinationTable::attachWiFiEvents();
+
+    initialized = true;
+    return true;
+}
+
+void OSCTransport::end() {
+    if (!initialized) {
+        return;
+    }
+    xSemaphoreTake(lock, portMAX_DELAY);
+    udp.stop();
+    initialized = false;
+    xSemaphoreGive(lock);
+}
+
+void OSCTransport::setTarget(const char* target_ip, uint16_t target_port) {
+    // Ne publier que les changements (la table ne se reconstruit pas pour rien)
+    bool changed = false;
+    portENTER_CRITICAL(&configLock);
+    if (stagedConfig.targetPort != target_port ||
+        strncmp(stagedConfig.targetIP, target_ip, TARGET_IP_SIZE) != 0) {
+        strncpy(stagedConfig.targetIP, target_ip, TARGET_IP_SIZE - 1);
+        stagedConfig.targetIP[TARGET_IP_SIZE - 1] = '\0';
+        stagedConfig.targetPort = target_port;
+        changed = true;
+    }
+    portEXIT_CRITICAL(&configLock);
+    if (changed) {
+        configVersion.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void OSCTransport::setBroadcast(bool enable) {
+    bool changed = false;
+    portENTER_CRITICAL(&configLock);
+    if (stagedConfig.broadcast != enable) {
+        stagedConfig.broadcast = enable;
+        changed = true;
+    }
+    portEXIT_CRITICAL(&configLock);
+    if (changed) {
+        configVersion.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void OSCTransport::setInterface(uint8_t interface) {
+    bool changed = false;
+    portENTER_CRITICAL(&configLock);
+    if (stagedConfig.interface != interface) {
+        stagedConfig.interface = interface;
+        changed = true;
+    }
+    portEXIT_CRITICAL(&configLock);
+    if (changed) {
+        configVersion.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void OSCTransport::setDestinations(const OSCDestinationConfig* list, uint8_t count) {
+    if (count > OSCDestinationTable::MAX_DESTINATIONS) {
+        count = OSCDestinationTable::MAX_DESTINATIONS;
+    }
+    portENTER_CRITICAL(&configLock);
+    memcpy(stagedConfig.destinations, list, count * sizeof(OSCDestinationConfig));
+    stagedConfig.destinationCount = count;
+    portEXIT_CRITICAL(&configLock);
+    configVersion.fetch_add(1, std::memory_order_release);
+}
+
+void OSCTransport::setSerialBaud(uint32_t baud) {
+    bool changed = false;
+    portENTER_CRITICAL(&configLock);
+    if (baud > 0 && stagedConfig.serialBaud != baud) {
+        stagedConfig.serialBaud = baud;
+        changed = true;
+    }
+    portEXIT_CRITICAL(&configLock);
+    if (changed) {
+        configVersion.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void OSCTransport::applyConfig() {
+    const uint32_t version = configVersion.load(std::memory_order_acquire);
+    if (version == appliedConfigVersion) {
+        return;
+    }
+
+    StagedConfig config;
+    portENTER_CRITICAL(&configLock);
+    config = stagedConfig;
+    portEXIT_CRITICAL(&configLock);
+    appliedConfigVersion = version;
+
+    destinations.setTarget(config.targetIP, config.targetPort);
+    destinations.setBroadcast(config.broadcast);
+    destinations.setInterface(config.interface);
+    destinations.setDestinations(config.destinations, config.destinationCount);
+
+    // Ports série utilisés par la liste ; UART 1 ouvert sur les broches TX/RX à la première utilisation.
+    // État série sous le verrou du socket (tenu le temps d'un datagramme au plus)
+    uint8_t ports = 0;
+    for (uint8_t d = 0; d < config.destinationCount; d++) {
+        if (config.destinations[d].kind == OSC_DEST_SERIAL && config.destinations[d].port < SERIAL_PORT_COUNT) {
+            ports |= 1 << config.destinations[d].port;
+        }
+    }
+    xSemaphoreTake(lock, portMAX_DELAY);
+    for (uint8_t p = 0; p < SERIAL_PORT_COUNT; p++) {
+        if (!(ports & (1 << p))) {
+            slipDecoders[p].reset();
+        }
+    }
+    serialPorts = ports;
+    if ((ports & 0x02) && !(serialStarted & 0x02)) {
+        Serial1.setTxBufferSize(OSC_SERIAL_TX_BUFFER);
+        Serial1.setRxBufferSize(OSC_SERIAL_RX_BUFFER);
+        Serial1.begin(config.serialBaud, SERIAL_8N1, PinMapper::labelToGpio("RX"), PinMapper::labelToGpio("TX"));
+        serialStarted |= 0x02;
+        serialBaud = config.serialBaud;
+    } else if ((serialStarted & 0x02) && serialBaud != config.serialBaud) {
+        Serial1.updateBaudRate(config.serialBaud);
+        serialBaud = config.serialBaud;
+    }
+    xSemaphoreGive(lock);
+}
+
+Stream* OSCTransport::serialStream(uint8_t index) {
+    if (index == 0) {
+        return &Serial;
+    }
+    if (index == 1 && (serialStarted & 0x02)) {
+        return &Serial1;
+    }
+    return nullptr;
+}
+
+bool OSCTransport::sendSerial(uint8_t index, const uint8_t* data, size_t length) {
+    Stream* stream = serialStream(index);
+    if (!stream) {
+        return false;
+    }
+    const size_t frame = oscSlipEncode(data, length, slipBuffer, sizeof(slipBuffer));
+    // Tampon TX plein : trame écartée plutôt que d'attendre l'UART
+    if (frame == 0 || stream->availableForWrite() < (int)frame) {
+        return false;
+    }
+    return stream->write(slipBuffer, frame) == frame;
+}
+
+int OSCTransport::receiveSerial(uint8_t* buffer, size_t capacity, size_t& length) {
+    for (uint8_t p = 0; p < SERIAL_PORT_COUNT; p++) {
+        if (!(serialPorts & (1 << p))) {
+            continue;
+        }
+        Stream* stream = serialStream(p);
+        if (!stream) {
+            continue;
+        }
+        // Octets déjà reçus seulement ; une trame partielle attend le cycle suivant
+        int available = stream->available();
+        while (available-- > 0) {
+            const int byte = stream->read();
+            if (byte < 0) {
+                break;
+            }
+            if (slipDecoders[p].feed((uint8_t)byte)) {
+                const size_t size = slipDecoders[p].size();
+                if (size <= capacity) {
+                    memcpy(buffer, slipDecoders[p].data(), size);
+                    length = size;
+                }
+                lastSourcePort = p;
+                return (int)size;
+            }
+        }
+    }
+    return 0;
+}
+
+OSCSendResult OSCTransport::send(const uint8_t* data, size_t length, uint8_t formats, uint16_t messages,
+                                 uint8_t maxRetries, bool fromTask, uint8_t* transports,
+                                 bool reliableOnly) {
+    uint8_t accepted = 0;
+    if (transports) {
+        *transports = 0;
+    }
+    if (!initialized) {
+        return OSC_SEND_NO_DESTINATION;
+    }
+
+    // Depuis loop() on n'attend jamais la tâche d'envoi : datagramme écarté si elle tient un verrou
+    const TickType_t wait = fromTask ? portMAX_DELAY : 0;
+    if (xSemaphoreTake(tableLock, wait) != pdTRUE) {
+        busySkips.fetch_add(1, std::memory_order_relaxed);
+        return OSC_SEND_BUSY;
+    }
+    applyConfig();
+
+    // Table résolue (reconstruite seulement sur changement de config ou événement WiFi) ;
+    // les destinations admises sont copiées pour émettre hors de ce verrou
+    struct Target {
+        IPAddress ip;
+        uint16_t port;
+        uint8_t kind;
+        uint8_t index;
+    };
+    Target targets[OSCDestinationTable::MAX_DESTINATIONS];
+    uint8_t targetCount = 0;
+    bool limited = false;
+    const uint8_t count = destinations.resolve();
+    const uint32_t now = micros();
+    for (uint8_t d = 0; d < count; d++) {
+        OSCDestination& dest = destinations[d];
+        if (!dest.active || (dest.formats & formats) != formats || (reliableOnly && !dest.reliable)) {
+            continue;
+        }
+        if (!destinations.admit(d, messages, now)) {
+            dest.limited += messages;
+            limited = true;
+            continue;
+        }
+        targets[targetCount++] = {dest.ip, dest.port, dest.kind, d};
+    }
+    xSemaphoreGive(tableLock);
+
+    // Le même datagramme part vers chaque destination (pas d'arrêt au premier succès) ;
+    // le socket n'est verrouillé que le temps des appels WiFiUDP
+    uint8_t sentMask = 0;
+    uint8_t busyCount = 0;
+    for (uint8_t t = 0; t < targetCount; t++) {
+        const Target& target = targets[t];
+        if (xSemaphoreTake(lock, wait) != pdTRUE) {
+            busyCount++;
+            continue;
+        }
+        bool sent = false;
+        if (target.kind == OSC_DEST_SERIAL) {
+            // Pas de nouvelle tentative : le tampon TX de l'UART ne se libère pas en 1 ms
+            sent = sendSerial((uint8_t)target.port, data, length);
+        } else {
+            uint8_t retryCount = 0;
+            while (retryCount <= maxRetries && !sent) {
+                if (udp.beginPacket(target.ip, target.port)) {
+                    udp.write(data, length);
+                    sent = udp.endPacket();
+                }
+                retryCount++;
+                if (!sent && retryCount <= maxRetries && fromTask) {
+                    // Tampons lwIP saturés : céder le cœur, socket libéré pour la réception
+                    xSemaphoreGive(lock);
+                    vTaskDelay(1);
+                    xSemaphoreTake(lock, portMAX_DELAY);
+                }
+            }
+        }
+        xSemaphoreGive(lock);
+        if (sent) {
+            sentMask |= 1 << t;
+            accepted |= 1 << target.kind;
+        }
+    }
+    if (busyCount > 0) {
+        busySkips.fetch_add(busyCount, std::memory_order_relaxed);
+    }
+
+    // Compteurs par destination : section courte sans E/S, attente bornée même depuis loop().
+    // Entrée reconstruite entre-temps (changement de config) : résultat non compté
+    if (targetCount > busyCount) {
+        xSemaphoreTake(tableLock, portMAX_DELAY);
+        for (uint8_t t = 0; t < targetCount; t++) {
+            const Target& target = targets[t];
+            if (target.index >= destinations.size()) {
+                continue;
+            }
+            OSCDestination& dest = destinations[target.index];
+            if (dest.port != target.port || dest.kind != target.kind || !(dest.ip == target.ip)) {
+                continue;
+            }
+            if (sentMask & (1 << t)) {
+                dest.sent += messages;
+                dest.bytes += length;
+            } else {
+                dest.failed += messages;
+            }
+        }
+        xSemaphoreGive(tableLock);
+    }
+
+    if (transports) {
+        *transports = accepted;
+    }
+    if (accepted != 0) {
+        return OSC_SEND_OK;
+    }
+    if (targetCount > busyCount) {
+        return OSC_SEND_ERROR;
+    }
+    if (busyCount > 0) {
+        return OSC_SEND_BUSY;
+    }
+    return limited ? OSC_SEND_RATE_LIMITED : OSC_SEND_NO_DESTINATION;
+}
+
+bool OSCTransport::hasFormatFilter() {
+    if (!initialized) {
+        return false;
+    }
+    // Aucune résolution DNS ni E/S sous tableLock : attente bornée
+    xSemaphoreTake(tableLock, portMAX_DELAY);
+    applyConfig();
+    destinations.resolve();
+    const bool filter = destinations.hasFormatFilter();
+    xSemaphoreGive(tableLock);
+    return filter;
+}
+
+void OSCTransport::resolvePending() {
+    if (!initialized) {
+        return;
+    }
+    // Une destination à la fois ; un échec n'est retenté qu'à la prochaine reconstruction
+    for (uint8_t attempt = 0; attempt < OSCDestinationTable::MAX_DESTINATIONS; attempt++) {
+        char host[OSC_DEST_HOST_SIZE];
+        uint8_t index = 0;
+        xSemaphoreTake(tableLock, portMAX_DELAY);
+        applyConfig();
+        destinations.resolve();
+        const uint8_t pending = destinations.pendingLookups();
+        if (pending != 0) {
+            while (!(pending & (1 << index))) {
+                index++;
+            }
+            strncpy(host, destinations.getConfig(index).host, OSC_DEST_HOST_SIZE - 1);
+            host[OSC_DEST_HOST_SIZE - 1] = '\0';
+        }
+        xSemaphoreGive(tableLock);
+        if (pending == 0) {
+            return;
+        }
+
+        // Requête DNS/mDNS bloquante : aucun verrou tenu, loop() continue d'envoyer et de recevoir
+        IPAddress ip;
+        const bool found = WiFi.hostByName(host, ip);
+
+        xSemaphoreTake(tableLock, portMAX_DELAY);
+        destinations.completeLookup(index, host, ip, found);
+        xSemaphoreGive(tableLock);
+    }
+}
+
+int OSCTransport::receive(uint8_t* buffer, size_t capacity, size_t& length) {
+    length = 0;
+    if (!initialized) {
+        return 0;
+    }
+    // Appelé depuis loop() : socket tenu par la tâche d'envoi, lecture au cycle suivant
+    if (xSemaphoreTake(lock, 0) != pdTRUE) {
+        return 0;
+    }
+    int packetSize = udp.parsePacket();
+    if (packetSize > 0) {
+        lastSourceIP = udp.remoteIP();
+        lastSourcePort = SOURCE_UDP;
+    }
+    if (packetSize > 0 && (size_t)packetSize <= capacity) {
+        const int len = udp.read(buffer, capacity);
+        length = len > 0 ? (size_t)len : 0;
+    }
+    // Trop grand : ignoré, le parsePacket suivant le libère
+    if (packetSize <= 0 && serialPorts != 0) {
+        packetSize = receiveSerial(buffer, capacity, length);
+    }
+    xSemaphoreGive(lock);
+    return packetSize > 0 ? packetSize : 0;
+}
+
+void OSCTransport::markReliableSource() {
+    if (tableLock == nullptr) {
+        return;
+    }
+    // Depuis loop() : section courte sans E/S, attente bornée
+    xSemaphoreTake(tableLock, portMAX_DELAY);
+    for (uint8_t d = 0; d < destinations.size(); d++) {
+        OSCDestination& dest = destinations[d];
+        switch (dest.kind) {
+            case OSC_DEST_SERIAL:
+                dest.reliable |= (dest.port == lastSourcePort);
+                break;
+            case OSC_DEST_UNICAST:
+                dest.reliable |= (lastSourcePort == SOURCE_UDP && dest.ip == lastSourceIP);
+                break;
+            default:
+                // Broadcast/multicast : l'accusé vient d'un membre, pas de l'adresse de groupe
+                dest.reliable |= (lastSourcePort == SOURCE_UDP);
+                break;
+        }
+    }
+    xSemaphoreGive(tableLock);
+}
+
+void OSCTransport::resetReliableSources() {
+    if (tableLock == nullptr) {
+        return;
+    }
+    xSemaphoreTake(tableLock, portMAX_DELAY);
+    for (uint8_t d = 0; d < OSCDestinationTable::MAX_DESTINATIONS; d++) {
+        destinations[d].reliable = false;
+    }
+    xSemaphoreGive(tableLock);
+}
+
+uint8_t OSCTransport::getDestinationCount() const {
+    if (tableLock == nullptr) {
+        return 0;
+    }
+    xSemaphoreTake(tableLock, portMAX_DELAY);
+    const uint8_t count = destinations.size();
+    xSemaphoreGive(tableLock);
+    return count;
+}
+
+bool OSCTransport::getDestination(uint8_t index, OSCDestination& dest, OSCDestinationConfig& config) const {
+    if (tableLock == nullptr) {
+        return false;
+    }
+    xSemaphoreTake(tableLock, portMAX_DELAY);
+    const bool found = index < destinations.size();
+    if (found) {
+        dest = destinations[index];
+        config = destinations.getConfig(index);
+    }
+    xSemaphoreGive(tableLock);
+    return found;
+}
+
+void OSCTransport::resetStats() {
+    if (tableLock == nullptr) {
+        return;
+    }
+    xSemaphoreTake(tableLock, portMAX_DELAY);
+    destinations.resetStats();
+    xSemaphoreGive(tableLock);
+}
+
+uint32_t OSCTransport::getSerialDroppedFrames() const {
+    uint32_t dropped = 0;
+    for (uint8_t p = 0; p < SERIAL_PORT_COUNT; p++) {
+        dropped += slipDecoders[p].getDroppedFrames();
+    }
+    return dropped;
+}
+
+void OSCTransport::printStatus() const {
+    static const char* kindNames[] = {"unicast", "broadcast-ap", "broadcast-sta", "multicast", "serial"};
+    Serial.println("=== OSC Transport Status ===");
+    Serial.printf("WiFi Status: %d (%s)\n", WiFi.status(),
+                  WiFi.status() == WL_CONNECTED ? "Connected" : "Disconnected");
+    if (WiFi.status() == WL_CONNECTED) {
+        Serial.printf("Local IP: %s\n", WiFi.localIP().toString().c_str());
+        Serial.printf("Subnet: %s\n", WiFi.subnetMask().toString().c_str());
+        Serial.printf("Gateway: %s\n", WiFi.gatewayIP().toString().c_str());
+        Serial.printf("RSSI: %d dBm\n", WiFi.RSSI());
+    }
+    Serial.printf("Local port: %d\n", localPort);
+    Serial.printf("Busy skips (loop): %lu\n", (unsigned long)getBusySkips());
+    if (serialPorts != 0) {
+        Serial.printf("Serial ports: 0x%02x (UART1 %lu baud), oversize frames dropped: %lu\n", serialPorts,
+                      (unsigned long)serialBaud, (unsigned long)getSerialDroppedFrames());
+    }
+    if (stagedConfig.destinationCount > 0) {
+        Serial.printf("Destinations: %d\n", stagedConfig.destinationCount);
+    } else {
+        Serial.printf("Target: %s:%d\n", stagedConfig.targetIP, stagedConfig.targetPort);
+        Serial.printf("Broadcast: %s\n", stagedConfig.broadcast ? "Enabled" : "Disabled");
+        Serial.printf("Interface: %d (0=AP, 1=STA, 2=BOTH)\n", stagedConfig.interface);
+    }
+    OSCDestination dest;
+    OSCDestinationConfig config;
+    for (uint8_t d = 0; getDestination(d, dest, config); d++) {
+        Serial.printf("Destination %d %s %s:%d (%s, %u msg/s): sent %lu, failed %lu, limited %lu, %lu bytes\n",
+                      d, kindNames[dest.kind], dest.ip.toString().c_str(), dest.port,
+                      dest.active ? "active" : "inactive", dest.rate,
+                      (unsigned long)dest.sent, (unsigned long)dest.failed,
+                      (unsigned long)dest.limited, (unsigned long)dest.bytes);
+    }
+    Serial.println("============================");
+}
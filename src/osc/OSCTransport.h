@@ -0,0 +1,168 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "OSCDestinations.h"
+#include "OSCSlip.h"
+
+// Port UDP local unique : réception OSC et port source des envois
+#ifndef OSC_LOCAL_PORT
+#define OSC_LOCAL_PORT 8001
+#endif
+
+// Destinations série (OSC_DEST_SERIAL) : débit de l'UART 1 (broches TX/RX de PinMapper)
+#ifndef OSC_SERIAL_BAUD
+#define OSC_SERIAL_BAUD 115200
+#endif
+
+// Tampons de l'UART 1 : une trame SLIP part sans attendre l'UART
+#ifndef OSC_SERIAL_TX_BUFFER
+#define OSC_SERIAL_TX_BUFFER 2048
+#endif
+#ifndef OSC_SERIAL_RX_BUFFER
+#define OSC_SERIAL_RX_BUFFER 1024
+#endif
+
+// Résultat d'un envoi
+enum OSCSendResult : uint8_t {
+    OSC_SEND_OK = 0,             // Au moins une destination a reçu le datagramme
+    OSC_SEND_NO_DESTINATION = 1, // WiFi déconnecté ou aucune destination pour ce format
+    OSC_SEND_RATE_LIMITED = 2,   // Toutes les destinations concernées au-delà de leur débit
+    OSC_SEND_ERROR = 3,          // beginPacket/endPacket en échec après les tentatives
+    OSC_SEND_BUSY = 4            // Verrou occupé (appel non bloquant depuis loop()) : rien envoyé
+};
+
+/**
+ * @brief Transport OSC partagé : un seul socket UDP pour l'émission et la réception
+ *
+ * Possède le socket, la table des destinations et leur configuration ;
+ * OSCManager (réception, envois directs) et OSCQueue (tâche d'envoi) y
+ * font référence au lieu d'ouvrir chacun leur socket et de dupliquer la cible.
+ *
+ * - Les setters publient la configuration sans attente (section critique courte),
+ *   appliquée à la table au prochain envoi
+ * - Le socket est protégé par un mutex tenu seulement autour des appels WiFiUDP
+ *   (non réentrant : parsePacket() écrase l'adresse distante utilisée par endPacket()) ;
+ *   la table des destinations a son propre mutex, jamais tenu pendant une E/S
+ * - Depuis loop(), les verrous sont pris sans attente : datagramme écarté
+ *   (OSC_SEND_BUSY) ou réception reportée au cycle suivant si la tâche d'envoi les tient
+ * - Les noms d'hôte sont résolus par resolvePending() (tâche d'envoi), hors verrou
+ * - Les destinations série reçoivent le même datagramme encodé en trame SLIP
+ *   (OSC 1.1) ; les trames SLIP reçues sur ces ports sortent par receive()
+ *   comme un datagramme UDP. UART 0 garde la configuration de la console.
+ */
+class OSCTransport {
+public:
+    OSCTransport();
+    ~OSCTransport();
+
+    bool begin(uint16_t localPort = OSC_LOCAL_PORT);
+    void end();
+    bool isInitialized() const { return initialized; }
+    uint16_t getLocalPort() const { return localPort; }
+
+    // Configuration historique : cible unique, broadcast, interface
+    void setTarget(const char* target_ip, uint16_t target_port);
+    void setBroadcast(bool enable);
+    void setInterface(uint8_t interface);
+    const char* getTargetIP() const { return stagedConfig.targetIP; }
+    uint16_t getTargetPort() const { return stagedConfig.targetPort; }
+    bool isBroadcastEnabled() const { return stagedConfig.broadcast; }
+    uint8_t getInterface() const { return stagedConfig.interface; }
+
+    // Liste de destinations (count = 0 : configuration historique)
+    void setDestinations(const OSCDestinationConfig* list, uint8_t count);
+    // Débit de l'UART 1 (appliqué au prochain envoi, port ouvert à la première utilisation)
+    void setSerialBaud(uint32_t baud);
+    uint32_t getSerialBaud() const { return stagedConfig.serialBaud; }
+
+    // Émission : le datagramme déjà encodé part vers chaque destination qui accepte
+    // formats (OSCDestinationFormat) et dont le seau à jetons couvre messages.
+    // fromTask : tâche dédiée (attend les verrous, cède le cœur entre deux tentatives) ;
+    // sinon (loop()) verrous pris sans attente, OSC_SEND_BUSY s'ils sont occupés.
+    // transports reçoit les bits OSCDestinationKind ayant accepté le datagramme.
+    // reliableOnly : seulement les destinations ayant accusé (retransmissions fiables).
+    OSCSendResult send(const uint8_t* data, size_t length, uint8_t formats, uint16_t messages,
+                       uint8_t maxRetries, bool fromTask, uint8_t* transports = nullptr,
+                       bool reliableOnly = false);
+
+    // Résolution DNS/mDNS des destinations nommées (bloquante, aucun verrou tenu
+    // pendant la requête) : tâche d'envoi, ou update() de la file en repli
+    void resolvePending();
+
+    // Une destination active filtre-t-elle par format ? (bundles homogènes)
+    bool hasFormatFilter();
+
+    // Réception (UDP, puis trames SLIP des ports série utilisés) : taille du datagramme
+    // en attente (0 si aucun ou socket occupé) ; length = octets copiés dans buffer
+    // (0 si le datagramme dépasse capacity, il est alors écarté)
+    int receive(uint8_t* buffer, size_t capacity, size_t& length);
+
+    // Livraison fiable : la source du dernier datagramme reçu (loop()) a accusé ;
+    // unicast : même IP, série : même port, broadcast/multicast : tout émetteur UDP
+    void markReliableSource();
+    // Nouvelle session : plus aucune destination n'a accusé
+    void resetReliableSources();
+
+    // Destinations résolues et compteurs par destination : copies prises sous tableLock
+    // (la tâche d'envoi reconstruit la table et met à jour les compteurs) ;
+    // false si index est hors de la table
+    uint8_t getDestinationCount() const;
+    bool getDestination(uint8_t index, OSCDestination& dest, OSCDestinationConfig& config) const;
+    void resetStats();
+    uint32_t getSerialDroppedFrames() const;
+    // Envois depuis loop() écartés car un verrou était occupé
+    uint32_t getBusySkips() const { return busySkips.load(std::memory_order_relaxed); }
+
+    void printStatus() const;
+
+private:
+    static constexpr uint8_t SERIAL_PORT_COUNT = 2;
+
+    void applyConfig(); // Sous tableLock
+    // Ports série (sous lock)
+    Stream* serialStream(uint8_t index);
+    bool sendSerial(uint8_t index, const uint8_t* data, size_t length);
+    int receiveSerial(uint8_t* buffer, size_t capacity, size_t& length);
+
+    static const uint8_t TARGET_IP_SIZE = OSC_DEST_HOST_SIZE;
+
+    WiFiUDP udp;
+    SemaphoreHandle_t lock;      // Socket et ports série
+    SemaphoreHandle_t tableLock; // Table des destinations (résolution, seaux, compteurs)
+    bool initialized;
+    uint16_t localPort;
+    OSCDestinationTable destinations; // Accédée uniquement sous tableLock
+    std::atomic<uint32_t> busySkips;
+
+    // Ports série des destinations (bit = numéro d'UART), sous verrou
+    uint8_t serialPorts;
+    uint8_t serialStarted;
+    uint32_t serialBaud;
+    uint8_t slipBuffer[OSC_SLIP_MAX_ENCODED];
+    OSCSlipDecoder slipDecoders[SERIAL_PORT_COUNT];
+
+    // Source du dernier datagramme reçu (loop() uniquement)
+    static constexpr uint8_t SOURCE_UDP = 0xFF;
+    IPAddress lastSourceIP;
+    uint8_t lastSourcePort; // Numéro d'UART, ou SOURCE_UDP
+
+    // Configuration écrite par loop() / l'API web, lue au prochain envoi
+    struct StagedConfig {
+        char targetIP[TARGET_IP_SIZE];
+        uint16_t targetPort;
+        bool broadcast;
+        uint8_t interface;
+        OSCDestinationConfig destinations[OSCDestinationTable::MAX_DESTINATIONS];
+        uint8_t destinationCount; // 0 : cible/broadcast ci-dessus
+        uint32_t serialBaud;
+    };
+    StagedConfig stagedConfig;
+    portMUX_TYPE configLock;
+    std::atomic<uint32_t> configVersion;
+    uint32_t appliedConfigVersion;
+};
@@ -0,0 +1,119 @@
+// Budget de vidage OSC (oscDrainBudget) : latence sous rafales synthétiques,
+// comparée à l'ancien vidage fixe de 3 messages par cycle (temps simulé)
+#include "host_test.h"
+#include "osc/OSCDrainBudget.h"
+#include <stdlib.h>
+#include <vector>
+#include <deque>
+#include <algorithm>
+
+static const uint32_t CAPACITY = 32;        // OSCQueue::QUEUE_SIZE
+static const uint32_t SCAN_US = 400;        // Scan des composants par cycle
+static const uint32_t SIMULATED_US = 10000000;
+
+struct Result {
+    double meanLatency;
+    uint32_t p99Latency;
+    uint32_t maxLatency;
+    uint32_t drops;
+    uint32_t maxDrainUs; // Temps de vidage maximal d'un cycle (pris au scan)
+    uint16_t maxSlice;   // Datagrammes maximum envoyés en un cycle
+    double meanCycleUs;
+};
+
+// Coût d'envoi d'un datagramme : 150-250 µs, pointe à 1500 µs une fois sur 50
+static uint32_t sendCost() {
+    return (rand() % 50 == 0) ? 1500 : 150 + rand() % 101;
+}
+
+// fixed > 0 : tranche fixe (ancien comportement) ; sinon budget adaptatif de budgetUs
+static Result simulate(uint16_t fixed, uint32_t budgetUs) {
+    srand(7);
+    std::deque<uint32_t> queue; // Horodatages d'enqueue
+    std::vector<uint32_t> latencies;
+    uint32_t now = 0;
+    uint32_t nextBurst = 0;
+    uint32_t nextSteady = 0;
+    uint32_t costUs = 200;
+    uint32_t cycles = 0;
+    Result r = {};
+
+    while (now < SIMULATED_US) {
+        // Scan : flux continu (1 message / 2 ms) et rafale toutes les 50 ms (24 messages)
+        const uint32_t scanEnd = now + SCAN_US;
+        auto enqueue = [&](uint32_t t) {
+            if (queue.size() >= CAPACITY) {
+                r.drops++;
+            } else {
+                queue.push_back(t);
+            }
+        };
+        while (nextSteady < scanEnd) {
+            enqueue(nextSteady);
+            nextSteady += 2000;
+        }
+        if (nextBurst < scanEnd) {
+            for (int i = 0; i < 24; i++) {
+                enqueue(nextBurst);
+            }
+            nextBurst += 50000;
+        }
+        now = scanEnd;
+
+        // Vidage
+        const uint16_t slice = fixed ? (uint16_t)std::min<size_t>(fixed, queue.size())
+                                     : oscDrainBudget((uint32_t)queue.size(), CAPACITY, budgetUs, costUs);
+        const uint32_t drainStart = now;
+        for (uint16_t i = 0; i < slice; i++) {
+            const uint32_t cost = sendCost();
+            now += cost;
+            costUs = oscUpdateSendCost(costUs, (int32_t)cost);
+            latencies.push_back(now - queue.front());
+            queue.pop_front();
+        }
+        r.maxDrainUs = std::max(r.maxDrainUs, now - drainStart);
+        r.maxSlice = std::max(r.maxSlice, slice);
+        cycles++;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (uint32_t l : latencies) {
+        total += l;
+    }
+    r.meanLatency = latencies.empty() ? 0 : total / latencies.size();
+    r.p99Latency = latencies.empty() ? 0 : latencies[latencies.size() * 99 / 100];
+    r.maxLatency = latencies.empty() ? 0 : latencies.back();
+    r.meanCycleUs = (double)SIMULATED_US / cycles;
+    return r;
+}
+
+static void print(const char* name, const Result& r) {
+    printf("%-22s latence moy %7.0f µs  p99 %6u µs  max %6u µs  pertes %5u  tranche max %2u (%5u µs)  cycle moy %5.0f µs\n",
+           name, r.meanLatency, r.p99Latency, r.maxLatency, r.drops, r.maxSlice, r.maxDrainUs, r.meanCycleUs);
+}
+
+int main() {
+    // Formule : bornes et doublement au-delà des 3/4
+    CHECK(oscDrainBudget(0, 32, 1000, 200) == 0);
+    CHECK(oscDrainBudget(10, 32, 1000, 200) == 5);
+    CHECK(oscDrainBudget(30, 32, 1000, 200) == 10);
+    CHECK(oscDrainBudget(3, 32, 1000, 200) == 3);
+    CHECK(oscDrainBudget(10, 32, 100, 5000) == 1);
+    CHECK(oscDrainBudget(10, 32, 1000, 0) == 10);
+
+    const Result fixed = simulate(3, 0);
+    const Result adaptive = simulate(0, 1000);
+    const Result tight = simulate(0, 500);
+    print("fixe 3/cycle", fixed);
+    print("adaptatif 1000 µs", adaptive);
+    print("adaptatif 500 µs", tight);
+
+    // Rafales absorbées plus vite, sans perte supplémentaire
+    CHECK(adaptive.p99Latency < fixed.p99Latency);
+    CHECK(adaptive.drops <= fixed.drops);
+    // Scan jamais privé : tranche bornée par 2 × budget au coût minimal (150 µs)
+    CHECK(adaptive.maxSlice <= 2 * 1000 / 150);
+    CHECK(tight.maxSlice <= 2 * 500 / 150);
+    return test_result("bench_osc_drain");
+}
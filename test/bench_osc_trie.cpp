@@ -0,0 +1,178 @@
+// OSCAddressTrie : motifs OSC 1.0 (*, ?, [], [!], {}), équivalence avec un
+// dispatch linéaire, débit sur des espaces de noms de plusieurs centaines d'adresses
+#include "host_test.h"
+#include "osc/OSCAddressTrie.h"
+#include <string>
+#include <vector>
+
+typedef OSCAddressTrie<1024, 8192> Trie;
+
+struct Entry {
+    std::string address;
+    uint8_t index;
+};
+
+// Découpe "/a/b/c" en segments
+static std::vector<std::string> split(const std::string& address) {
+    std::vector<std::string> parts;
+    size_t start = 1;
+    while (start <= address.size()) {
+        size_t end = address.find('/', start);
+        if (end == std::string::npos) end = address.size();
+        parts.push_back(address.substr(start, end - start));
+        start = end + 1;
+    }
+    return parts;
+}
+
+// Ancien dispatch : parcours de toutes les adresses configurées
+static uint32_t linearMatch(const std::vector<Entry>& entries, const char* pattern) {
+    const std::vector<std::string> p = split(pattern);
+    uint32_t mask = 0;
+    for (const Entry& e : entries) {
+        const std::vector<std::string> n = split(e.address);
+        if (n.size() != p.size()) continue;
+        bool hit = true;
+        for (size_t i = 0; i < n.size() && hit; i++) {
+            hit = Trie::matchSegment(p[i].data(), p[i].size(), n[i].data(), n[i].size());
+        }
+        if (hit) mask |= 1UL << e.index;
+    }
+    return mask;
+}
+
+// Ancien dispatch littéral : comparaison de chaînes adresse par adresse
+static uint32_t linearLiteral(const std::vector<Entry>& entries, const char* address) {
+    uint32_t mask = 0;
+    for (const Entry& e : entries) {
+        if (strcmp(e.address.c_str(), address) == 0) mask |= 1UL << e.index;
+    }
+    return mask;
+}
+
+static bool seg(const char* pattern, const char* name) {
+    return Trie::matchSegment(pattern, strlen(pattern), name, strlen(name));
+}
+
+static void testSegments() {
+    CHECK(seg("*", ""));
+    CHECK(seg("*", "fader"));
+    CHECK(seg("fa*", "fader"));
+    CHECK(seg("*der", "fader"));
+    CHECK(seg("f*d*r", "fader"));
+    CHECK(!seg("f*x", "fader"));
+    CHECK(seg("fad?r", "fader"));
+    CHECK(!seg("fad?", "fader"));
+    CHECK(!seg("?", ""));
+    CHECK(seg("ch[0-9]", "ch5"));
+    CHECK(!seg("ch[0-4]", "ch5"));
+    CHECK(seg("ch[157]", "ch5"));
+    CHECK(seg("[!a-z]1", "A1"));
+    CHECK(!seg("[!a-z]1", "b1"));
+    CHECK(seg("ch[!0-4]", "ch9"));
+    CHECK(!seg("ch[0-9", "ch5")); // Classe non fermée
+    CHECK(seg("{fader,pan}", "pan"));
+    CHECK(seg("{fader,pan}", "fader"));
+    CHECK(!seg("{fader,pan}", "mute"));
+    CHECK(seg("ch{1,2}*", "ch2x"));
+    CHECK(seg("{a,ab}c", "abc"));   // Retour arrière entre alternatives
+    CHECK(!seg("{a,b", "a"));       // Accolade non fermée
+    CHECK(seg("*[0-9]", "track12"));
+}
+
+static void testTrie() {
+    Trie trie;
+    CHECK(trie.add("/mixer/ch1/fader", 0));
+    CHECK(trie.add("/mixer/ch2/fader", 1));
+    CHECK(trie.add("/mixer/ch1/pan", 2));
+    CHECK(trie.add("/fx/reverb", 3));
+    CHECK(trie.add("/mixer/ch1/fader", 4)); // Deux composants, même adresse
+    CHECK(!trie.add("/", 5));
+    CHECK(!trie.add("mixer", 5));
+    CHECK(!trie.add("/a//b", 5));
+    CHECK(!trie.add("/a", 32));
+
+    CHECK(trie.match("/mixer/ch1/fader") == ((1u << 0) | (1u << 4)));
+    CHECK(trie.match("/mixer/ch3/fader") == 0);
+    CHECK(trie.match("/mixer/*/fader") == ((1u << 0) | (1u << 1) | (1u << 4)));
+    CHECK(trie.match("/mixer/ch?/pan") == (1u << 2));
+    CHECK(trie.match("/mixer/ch[!2]/*") == ((1u << 0) | (1u << 2) | (1u << 4)));
+    CHECK(trie.match("/{mixer,fx}/*") == (1u << 3)); // mixer/ch1, mixer/ch2 : noeuds intermédiaires
+    CHECK(trie.match("/{mixer,fx}/reverb") == (1u << 3));
+    CHECK(trie.match("/mixer/ch1") == 0); // Noeud intermédiaire
+    CHECK(trie.match("/") == 0);
+    CHECK(trie.match("") == 0);
+
+    // Table pleine
+    OSCAddressTrie<3, 64> tiny;
+    CHECK(tiny.add("/a/b", 0));
+    CHECK(!tiny.add("/c", 1));
+}
+
+// Espace de noms : /bankB/chC/param (8 × 16 × 4 = 512 adresses), index = i % 32
+static std::vector<Entry> buildNamespace(Trie& trie) {
+    static const char* params[] = { "fader", "pan", "mute", "send" };
+    std::vector<Entry> entries;
+    char address[64];
+    uint32_t i = 0;
+    for (int bank = 0; bank < 8; bank++) {
+        for (int ch = 0; ch < 16; ch++) {
+            for (const char* param : params) {
+                snprintf(address, sizeof(address), "/bank%d/ch%d/%s", bank, ch, param);
+                entries.push_back({ address, (uint8_t)(i % 32) });
+                trie.add(address, (uint8_t)(i % 32));
+                i++;
+            }
+        }
+    }
+    return entries;
+}
+
+static void testEquivalence(const Trie& trie, const std::vector<Entry>& entries) {
+    static const char* patterns[] = {
+        "/bank3/ch7/pan", "/bank9/ch1/pan", "/bank*/ch1/fader", "/bank?/ch1?/mute",
+        "/bank[0-3]/ch[!0-4]/send", "/bank[!a-z]/ch2/{fader,pan}", "/*/*/*", "/*/*",
+        "/bank{1,5}/ch{10,2}/*", "/bank1/*1*/send", "/bank1/ch1/fader/extra",
+    };
+    for (const char* p : patterns) {
+        CHECK(trie.match(p) == linearMatch(entries, p));
+    }
+    for (const Entry& e : entries) {
+        CHECK(trie.match(e.address.c_str()) == (1u << e.index));
+    }
+}
+
+template <typename F>
+static double nsPerCall(F f, int iterations) {
+    const uint64_t start = bench_now_ns();
+    volatile uint32_t sink = 0;
+    for (int i = 0; i < iterations; i++) {
+        sink = sink + f(i);
+    }
+    return (bench_now_ns() - start) / (double)iterations;
+}
+
+static void bench(const Trie& trie, const std::vector<Entry>& entries) {
+    const int N = 200000;
+    const size_t count = entries.size();
+    const double trieLiteral = nsPerCall([&](int i) { return trie.match(entries[i % count].address.c_str()); }, N);
+    const double linearLit = nsPerCall([&](int i) { return linearLiteral(entries, entries[i % count].address.c_str()); }, N);
+    const char* pattern = "/bank[0-3]/ch1?/{fader,pan}";
+    const double triePattern = nsPerCall([&](int) { return trie.match(pattern); }, N / 10);
+    const double linearPattern = nsPerCall([&](int) { return linearMatch(entries, pattern); }, N / 100);
+    printf("%zu adresses, %u noeuds\n", count, trie.nodeCount());
+    printf("  adresse littérale : trie %7.0f ns, linéaire strcmp %8.0f ns (x%.0f)\n",
+           trieLiteral, linearLit, linearLit / trieLiteral);
+    printf("  motif %s : trie %7.0f ns, linéaire %8.0f ns (x%.0f)\n",
+           pattern, triePattern, linearPattern, linearPattern / triePattern);
+}
+
+int main() {
+    testSegments();
+    testTrie();
+    static Trie trie;
+    const std::vector<Entry> entries = buildNamespace(trie);
+    testEquivalence(trie, entries);
+    bench(trie, entries);
+    return test_result("bench_osc_trie");
+}
@@ -0,0 +1,345 @@
+// RTP-MIDI vers un pair UDP local (socket de loopback qui décode les listes reçues) :
+// paquets/s contre événements/s, temps simulé, envois réels.
+// - par événement : un paquet RTP par message
+// - par cycle (session AppleMIDI) : octets bruts des messages d'un loop() (statut
+//   complet, sans delta time) envoyés pendant MIDI.read(), ou dès que les 64 octets
+//   du tampon de sortie sont pleins
+// - RtpMidiBatch : liste RFC 6295 (delta times, running status), une par cycle
+//   (fenêtre nulle) ou une par RTP_MIDI_FLUSH_US
+#include "host_test.h"
+#include "midi/RtpMidiBatch.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <vector>
+#include <deque>
+#include <algorithm>
+
+static const uint32_t SIMULATED_US = 10000000;
+static const size_t APPLEMIDI_BUFFER = 64;
+static const size_t RTP_HEADER = 12;
+
+struct Result {
+    uint32_t queued;     // Événements remis à la stratégie
+    uint32_t delivered;  // Événements décodés par le pair, dans l'ordre
+    uint32_t mismatched; // Événement inattendu ou paquet illisible
+    uint32_t lost;       // Écartés avant envoi (file pleine)
+    uint32_t packets;
+    uint64_t bytes;      // Charge UDP (en-tête RTP compris)
+    uint64_t latencySum; // Envoi - horodatage de l'événement (µs)
+    uint32_t maxLatency;
+    uint32_t maxSpreadError; // Écart reconstruit (deltas) contre écart réel dans un paquet (µs)
+    uint64_t sendNs;         // Temps passé dans sendto()
+};
+
+// Pair local : sockets d'émission et de réception sur 127.0.0.1, réception non bloquante
+class Link {
+public:
+    Result r;
+
+    Link(bool withDeltas) : deltas(withDeltas), sequence(0), tx(-1), rx(-1), packetStart(0) {
+        memset(&r, 0, sizeof(r));
+        memset(&addr, 0, sizeof(addr));
+        tx = socket(AF_INET, SOCK_DGRAM, 0);
+        rx = socket(AF_INET, SOCK_DGRAM, 0);
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(addr);
+        const int buffer = 1 << 20;
+        setsockopt(rx, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+        if (bind(rx, (sockaddr*)&addr, sizeof(addr)) != 0 || getsockname(rx, (sockaddr*)&addr, &length) != 0) {
+            ::close(rx);
+            rx = -1;
+        }
+        fcntl(rx, F_SETFL, O_NONBLOCK);
+    }
+    ~Link() {
+        ::close(tx);
+        ::close(rx);
+    }
+    bool ok() const { return tx >= 0 && rx >= 0; }
+
+    void expect(const MidiEvent& event) {
+        expected.push_back(event);
+        r.queued++;
+    }
+
+    // En-tête RTP (12 octets) + en-tête de section MIDI (1 ou 2 octets) + liste
+    void send(const uint8_t* list, size_t length, uint32_t now) {
+        uint8_t packet[RTP_HEADER + 2 + 256];
+        const uint32_t timestamp = now / (1000000 / RTP_MIDI_CLOCK_HZ);
+        const uint8_t header[RTP_HEADER] = {
+            0x80, 0x61, (uint8_t)(sequence >> 8), (uint8_t)sequence,
+            (uint8_t)(timestamp >> 24), (uint8_t)(timestamp >> 16), (uint8_t)(timestamp >> 8), (uint8_t)timestamp,
+            0x12, 0x34, 0x56, 0x78
+        };
+        sequence++;
+        memcpy(packet, header, RTP_HEADER);
+        size_t pos = RTP_HEADER;
+        if (length > 15) {
+            packet[pos++] = (uint8_t)(0x80 | (length >> 8));
+            packet[pos++] = (uint8_t)length;
+        } else {
+            packet[pos++] = (uint8_t)length;
+        }
+        memcpy(packet + pos, list, length);
+        pos += length;
+
+        const uint64_t start = bench_now_ns();
+        sendto(tx, packet, pos, 0, (const sockaddr*)&addr, sizeof(addr));
+        r.sendNs += bench_now_ns() - start;
+        r.packets++;
+        r.bytes += pos;
+        receive(now);
+    }
+
+private:
+    void receive(uint32_t now) {
+        uint8_t packet[512];
+        ssize_t length;
+        while ((length = recv(rx, packet, sizeof(packet), 0)) > 0) {
+            decode(packet, (size_t)length, now);
+        }
+    }
+
+    // Décodage côté pair : delta time avant chaque commande sauf la première (si deltas),
+    // running status, messages temps réel sans données
+    void decode(const uint8_t* packet, size_t length, uint32_t now) {
+        if (length <= RTP_HEADER) {
+            r.mismatched++;
+            return;
+        }
+        size_t pos = RTP_HEADER;
+        size_t listLength = packet[pos] & 0x0F;
+        if (packet[pos] & 0x80) {
+            listLength = ((size_t)(packet[pos] & 0x0F) << 8) | packet[pos + 1];
+            pos++;
+        }
+        pos++;
+        const size_t end = pos + listLength;
+        if (end > length) {
+            r.mismatched++;
+            return;
+        }
+        uint32_t ticks = 0;
+        uint8_t running = 0;
+        bool first = true;
+        while (pos < end) {
+            if (!first && deltas) {
+                uint32_t delta = 0;
+                uint8_t byte;
+                do {
+                    byte = packet[pos++];
+                    delta = (delta << 7) | (byte & 0x7F);
+                } while ((byte & 0x80) && pos < end);
+                ticks += delta;
+            }
+            uint8_t status = running;
+            if (pos < end && (packet[pos] & 0x80)) {
+                status = packet[pos++];
+            }
+            MidiEvent got = { status, 0, 0, 0, 0 };
+            if (status < 0xF8) {
+                running = status;
+                got.data1 = pos < end ? packet[pos++] : 0;
+                if (RtpMidiBatch::dataLength(status) > 1) {
+                    got.data2 = pos < end ? packet[pos++] : 0;
+                }
+            }
+            match(got, ticks * (1000000 / RTP_MIDI_CLOCK_HZ), first, now);
+            first = false;
+        }
+    }
+
+    void match(const MidiEvent& got, uint32_t offset, bool first, uint32_t now) {
+        if (expected.empty() || !expected.front().sameMessage(got)) {
+            r.mismatched++;
+            return;
+        }
+        const MidiEvent event = expected.front();
+        expected.pop_front();
+        r.delivered++;
+        const uint32_t latency = now - event.timestamp;
+        r.latencySum += latency;
+        r.maxLatency = std::max(r.maxLatency, latency);
+        if (first) {
+            packetStart = event.timestamp;
+        }
+        const int32_t actual = (int32_t)(event.timestamp - packetStart);
+        const uint32_t error = (uint32_t)abs((int32_t)offset - actual);
+        r.maxSpreadError = std::max(r.maxSpreadError, error);
+    }
+
+    bool deltas;
+    uint16_t sequence;
+    int tx;
+    int rx;
+    sockaddr_in addr;
+    std::deque<MidiEvent> expected;
+    uint32_t packetStart;
+};
+
+static MidiEvent at(MidiEvent event, uint32_t timestamp) {
+    event.timestamp = timestamp;
+    return event;
+}
+
+// 8 potentiomètres (CC, un changement toutes les 1,5 ms en moyenne chacun), une note
+// toutes les 25 ms, horloge à 120 BPM, et un rappel de preset (32 CC d'un coup) toutes les 500 ms
+static std::vector<MidiEvent> traffic() {
+    srand(3);
+    std::vector<MidiEvent> events;
+    for (uint8_t pot = 0; pot < 8; pot++) {
+        for (uint32_t t = rand() % 1000; t < SIMULATED_US; t += 1000 + rand() % 1000) {
+            events.push_back(at(MidiEvent::controlChange(1, (uint8_t)(1 + pot), (uint8_t)(rand() % 128)), t));
+        }
+    }
+    for (uint32_t t = 0; t < SIMULATED_US; t += 25000) {
+        events.push_back(at(MidiEvent::noteOn(1, (uint8_t)(36 + (t / 25000) % 24), 100), t + 300));
+        events.push_back(at(MidiEvent::noteOff(1, (uint8_t)(36 + (t / 25000) % 24), 0), t + 10300));
+    }
+    for (uint32_t t = 0; t < SIMULATED_US; t += 20833) {
+        events.push_back(at(MidiEvent::realtime(0xF8), t));
+    }
+    for (uint32_t t = 250000; t < SIMULATED_US; t += 500000) {
+        for (uint8_t cc = 0; cc < 32; cc++) {
+            events.push_back(at(MidiEvent::controlChange(2, cc, 64), t));
+        }
+    }
+    std::stable_sort(events.begin(), events.end(),
+                     [](const MidiEvent& a, const MidiEvent& b) { return a.timestamp < b.timestamp; });
+    return events;
+}
+
+// Message complet (statut toujours présent, comme la bibliothèque MIDI sans running status)
+static size_t rawMessage(const MidiEvent& event, uint8_t* out) {
+    out[0] = event.status;
+    if (event.isRealtime()) {
+        return 1;
+    }
+    out[1] = event.data1;
+    if (RtpMidiBatch::dataLength(event.status) == 1) {
+        return 2;
+    }
+    out[2] = event.data2;
+    return 3;
+}
+
+static Result perEvent(const std::vector<MidiEvent>& events) {
+    Link link(false);
+    CHECK(link.ok());
+    for (const MidiEvent& event : events) {
+        uint8_t message[3];
+        link.expect(event);
+        link.send(message, rawMessage(event, message), event.timestamp);
+    }
+    return link.r;
+}
+
+static Result perLoopSession(const std::vector<MidiEvent>& events, uint32_t loopUs) {
+    Link link(false);
+    CHECK(link.ok());
+    uint8_t buffer[APPLEMIDI_BUFFER];
+    size_t length = 0;
+    size_t next = 0;
+    for (uint32_t now = loopUs; now <= SIMULATED_US + loopUs; now += loopUs) {
+        // Scan du cycle : messages écrits dans le tampon de la session
+        while (next < events.size() && events[next].timestamp < now) {
+            const MidiEvent& event = events[next++];
+            uint8_t message[3];
+            const size_t size = rawMessage(event, message);
+            if (length + size > sizeof(buffer)) {
+                link.send(buffer, length, event.timestamp);
+                length = 0;
+            }
+            memcpy(buffer + length, message, size);
+            length += size;
+            link.expect(event);
+        }
+        // MIDI.read() : tout ce qui a été écrit part en un paquet
+        if (length > 0) {
+            link.send(buffer, length, now);
+            length = 0;
+        }
+    }
+    return link.r;
+}
+
+static Result batched(const std::vector<MidiEvent>& events, uint32_t loopUs, uint32_t windowUs) {
+    Link link(true);
+    CHECK(link.ok());
+    RtpMidiBatch batch;
+    size_t next = 0;
+    for (uint32_t now = loopUs; now <= SIMULATED_US + 2 * windowUs + 10 * loopUs; now += loopUs) {
+        while (next < events.size() && events[next].timestamp < now) {
+            const MidiEvent& event = events[next++];
+            if (batch.add(event)) {
+                link.expect(event);
+            } else {
+                link.r.lost++;
+            }
+        }
+        // RtpMidi::update() : une liste au plus par cycle
+        if (batch.ready(now, windowUs)) {
+            uint8_t list[RTP_MIDI_BATCH_BYTES];
+            uint16_t commands = 0;
+            const size_t length = batch.take(list, sizeof(list), commands);
+            if (length > 0) {
+                link.send(list, length, now);
+            }
+        }
+    }
+    CHECK(batch.empty());
+    return link.r;
+}
+
+static void print(const char* name, const Result& r) {
+    const double seconds = SIMULATED_US / 1e6;
+    printf("  %-26s %7.0f paquets/s %7.0f évén./s %5.1f évén./paquet %6.1f ko/s  latence moy %5.0f max %6u µs"
+           "  écart intra-paquet max %5u µs  sendto %5.1f ms/s\n",
+           name, r.packets / seconds, r.delivered / seconds, r.packets ? (double)r.delivered / r.packets : 0.0,
+           r.bytes / seconds / 1000.0, r.delivered ? (double)r.latencySum / r.delivered : 0.0, r.maxLatency,
+           r.maxSpreadError, r.sendNs / seconds / 1e6);
+}
+
+static void checkComplete(const Result& r) {
+    CHECK(r.mismatched == 0);
+    CHECK(r.lost == 0);
+    CHECK(r.delivered == r.queued);
+}
+
+int main() {
+    const std::vector<MidiEvent> events = traffic();
+    printf("%zu événements sur %.0f s\n", events.size(), SIMULATED_US / 1e6);
+
+    const Result single = perEvent(events);
+    checkComplete(single);
+    print("par événement", single);
+
+    const uint32_t loops[2] = { 250, 1000 };
+    for (uint32_t loopUs : loops) {
+        printf("loop() toutes les %u µs\n", loopUs);
+        const Result session = perLoopSession(events, loopUs);
+        const Result perLoop = batched(events, loopUs, 0);
+        const Result window = batched(events, loopUs, RTP_MIDI_FLUSH_US);
+        checkComplete(session);
+        checkComplete(perLoop);
+        checkComplete(window);
+        print("par cycle (AppleMIDI)", session);
+        print("RtpMidiBatch par cycle", perLoop);
+        print("RtpMidiBatch fenêtre", window);
+
+        // Chronologie conservée par les deltas (au tick de 100 µs près), perdue sans eux
+        CHECK(perLoop.maxSpreadError < 1000000 / RTP_MIDI_CLOCK_HZ);
+        CHECK(window.maxSpreadError < 1000000 / RTP_MIDI_CLOCK_HZ);
+        CHECK(session.maxSpreadError >= loopUs / 2);
+        // Fenêtre : une liste par RTP_MIDI_FLUSH_US (hors rafales) même quand loop() est rapide
+        CHECK(window.packets <= session.packets);
+        CHECK(window.packets < 2 * (SIMULATED_US / RTP_MIDI_FLUSH_US));
+        CHECK(window.maxLatency <= RTP_MIDI_FLUSH_US + 2 * loopUs + 3000);
+    }
+    return test_result("bench_rtp_midi");
+}
@@ -0,0 +1,26 @@
+// Mini-cadre de test hôte : CHECK() compte les échecs, main() retourne test_result()
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+
+static int g_testFailures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        g_testFailures++; \
+    } \
+} while (0)
+
+static inline int test_result(const char* name) {
+    printf("%s: %s\n", name, g_testFailures ? "ÉCHEC" : "OK");
+    return g_testFailures ? 1 : 0;
+}
+
+// Horloge des bancs d'essai (ns)
+static inline uint64_t bench_now_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
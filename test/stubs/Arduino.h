@@ -0,0 +1,18 @@
+// Arduino.h minimal pour les tests hôte (en-têtes de src/ sans dépendance matérielle)
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <chrono>
+
+typedef uint8_t byte;
+
+inline unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline unsigned long millis() {
+    return micros() / 1000;
+}
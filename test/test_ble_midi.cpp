@@ -0,0 +1,278 @@
+// BLE-MIDI : encodeur (running status, horodatages omis, écart de 128 ms, capacité)
+// et décodeur (SysEx sur plusieurs paquets, temps réel intercalés, horodatages, paquets malformés)
+#include "host_test.h"
+#include "midi/BleMidi.h"
+#include <stdlib.h>
+#include <vector>
+
+// Puits du décodeur : événements reçus dans l'ordre
+struct Received {
+    std::vector<MidiEvent> events;
+    void operator()(const MidiEvent& event) { events.push_back(event); }
+};
+
+static bool packetEquals(const BleMidiEncoder& encoder, const uint8_t* expected, size_t length) {
+    return encoder.size() == length && memcmp(encoder.data(), expected, length) == 0;
+}
+
+static void testEncoderRunningStatus() {
+    BleMidiEncoder encoder;
+    encoder.setCapacity(BLE_MIDI_MAX_PACKET);
+    CHECK(encoder.add(MidiEvent::noteOn(1, 60, 100), 100));
+    CHECK(encoder.add(MidiEvent::noteOn(1, 61, 100), 100)); // Même statut, même ms : données seules
+    CHECK(encoder.add(MidiEvent::noteOn(1, 62, 100), 101)); // Même statut, nouvelle ms : horodatage + données
+    CHECK(encoder.add(MidiEvent::controlChange(1, 7, 64), 101)); // Nouveau statut : horodatage répété
+    CHECK(encoder.add(MidiEvent::realtime(0xF8), 101));         // Temps réel : toujours complet
+    CHECK(encoder.add(MidiEvent::controlChange(1, 7, 65), 101)); // Running status rompu par F8
+    CHECK(encoder.add(MidiEvent::programChange(1, 5), 101));    // Un seul octet de données
+    const uint8_t expected[] = {
+        0x80,                   // En-tête : 6 bits hauts de 100 ms
+        0xE4, 0x90, 60, 100,
+        61, 100,
+        0xE5, 62, 100,
+        0xE5, 0xB0, 7, 64,
+        0xE5, 0xF8,
+        0xE5, 0xB0, 7, 65,
+        0xE5, 0xC0, 5
+    };
+    CHECK(packetEquals(encoder, expected, sizeof(expected)));
+
+    // Potentiomètres lus dans le même cycle : 8 CC en 19 octets (5 + 7 × 2)
+    encoder.reset();
+    for (uint8_t pot = 0; pot < 8; pot++) {
+        CHECK(encoder.add(MidiEvent::controlChange(1, (uint8_t)(20 + pot), 64), 300));
+    }
+    CHECK(encoder.size() == 19);
+    CHECK(encoder.data()[0] == (0x80 | (300 >> 7)) && encoder.data()[1] == (0x80 | (300 & 0x7F)));
+
+    // reset() oublie le running status : le paquet suivant repart avec un statut complet
+    encoder.reset();
+    CHECK(encoder.empty());
+    CHECK(encoder.add(MidiEvent::controlChange(1, 20, 1), 300));
+    const uint8_t fresh[] = { 0x82, 0xAC, 0xB0, 20, 1 };
+    CHECK(packetEquals(encoder, fresh, sizeof(fresh)));
+}
+
+static void testEncoderGap() {
+    BleMidiEncoder encoder;
+    encoder.setCapacity(BLE_MIDI_MAX_PACKET);
+    CHECK(encoder.add(MidiEvent::noteOn(1, 60, 100), 0));
+    CHECK(encoder.add(MidiEvent::noteOn(1, 61, 100), 127)); // 127 ms : encore comptable sur 7 bits
+    const size_t size = encoder.size();
+    CHECK(!encoder.add(MidiEvent::noteOn(1, 62, 100), 255)); // 128 ms : paquet à envoyer d'abord
+    CHECK(encoder.size() == size);
+    encoder.reset();
+    CHECK(encoder.add(MidiEvent::noteOn(1, 62, 100), 255));
+
+    // Passage de 8191 à 0 ms (horodatage 13 bits) : écart de 32 ms accepté
+    encoder.reset();
+    CHECK(encoder.add(MidiEvent::controlChange(1, 1, 1), 0x1FF0));
+    CHECK(encoder.add(MidiEvent::controlChange(1, 1, 2), 0x2010));
+    const uint8_t wrapped[] = { 0xBF, 0xF0, 0xB0, 1, 1, 0x90, 1, 2 };
+    CHECK(packetEquals(encoder, wrapped, sizeof(wrapped)));
+
+    // Horodatage antérieur (événement publié par un autre cœur) : aligné sur le précédent
+    encoder.reset();
+    CHECK(encoder.add(MidiEvent::controlChange(1, 1, 1), 500));
+    CHECK(encoder.add(MidiEvent::controlChange(1, 1, 2), 499));
+    const uint8_t aligned[] = { 0x83, 0xF4, 0xB0, 1, 1, 1, 2 };
+    CHECK(packetEquals(encoder, aligned, sizeof(aligned)));
+}
+
+static void testEncoderCapacity() {
+    BleMidiEncoder encoder;
+    // MTU par défaut (23) : 20 octets utiles
+    CHECK(encoder.getCapacity() == BLE_MIDI_DEFAULT_MTU - 3);
+    encoder.setCapacity(2);
+    CHECK(encoder.getCapacity() == 5); // Au moins un message complet
+    encoder.setCapacity(1000);
+    CHECK(encoder.getCapacity() == BLE_MIDI_MAX_PACKET);
+
+    // 20 octets : en-tête + 4 messages complets (4 × 4 octets) ; le suivant ne tient pas
+    encoder.setCapacity(20);
+    for (uint8_t channel = 1; channel <= 4; channel++) {
+        CHECK(encoder.add(MidiEvent::noteOn(channel, 60, 100), 10));
+    }
+    CHECK(encoder.size() == 17);
+    CHECK(!encoder.add(MidiEvent::noteOn(5, 60, 100), 10));
+    CHECK(encoder.size() == 17);
+    // Running status (2 octets) et temps réel (2 octets) tiennent encore, puis plus rien
+    CHECK(encoder.add(MidiEvent::noteOn(4, 61, 100), 10));
+    CHECK(!encoder.add(MidiEvent::realtime(0xF8), 10));
+    CHECK(encoder.size() == 19);
+    CHECK(!encoder.add(MidiEvent::noteOn(4, 62, 100), 10));
+    CHECK(encoder.size() == 19);
+}
+
+static void testDecoderRunningStatus() {
+    BleMidiDecoder decoder;
+    Received rx;
+    // Complet à 1 ms, running status sans horodatage, puis avec un nouvel horodatage (3 ms)
+    const uint8_t packet[] = { 0x80, 0x81, 0x90, 60, 100, 61, 101, 0x83, 62, 102, 0x84, 0xF8 };
+    decoder.decode(packet, sizeof(packet), 1000, MIDI_SOURCE_BLE, rx);
+    CHECK(rx.events.size() == 4);
+    if (rx.events.size() == 4) {
+        CHECK(rx.events[0].status == 0x90 && rx.events[0].data1 == 60 && rx.events[0].timestamp == 1000);
+        CHECK(rx.events[1].status == 0x90 && rx.events[1].data1 == 61 && rx.events[1].data2 == 101);
+        CHECK(rx.events[1].timestamp == 1000);
+        CHECK(rx.events[2].status == 0x90 && rx.events[2].data1 == 62 && rx.events[2].timestamp == 3000);
+        CHECK(rx.events[3].status == 0xF8 && rx.events[3].timestamp == 4000);
+        CHECK(rx.events[0].origin() == MIDI_SOURCE_BLE);
+    }
+
+    // Le running status survit d'un paquet à l'autre (flux continu)
+    const uint8_t next[] = { 0x80, 0x85, 63, 103 };
+    decoder.decode(next, sizeof(next), 9000, MIDI_SOURCE_BLE, rx);
+    CHECK(rx.events.size() == 5 && rx.events.back().status == 0x90 && rx.events.back().data1 == 63);
+    CHECK(rx.events.back().timestamp == 9000);
+    CHECK(decoder.getMessageCount() == 5);
+    CHECK(decoder.getMalformedCount() == 0);
+
+    // Nouvelle connexion : plus de running status, la donnée seule est malformée
+    decoder.reset();
+    decoder.decode(next, sizeof(next), 0, MIDI_SOURCE_BLE, rx);
+    CHECK(rx.events.size() == 5);
+    CHECK(decoder.getMalformedCount() > 0);
+}
+
+static void testDecoderTimestampWrap() {
+    BleMidiDecoder decoder;
+    Received rx;
+    // 7 bits bas : 126 puis 1 → +128 ms sur les bits hauts, soit 3 ms plus tard
+    const uint8_t packet[] = { 0x80, 0xFE, 0xB0, 1, 2, 0x81, 0xB0, 1, 3 };
+    decoder.decode(packet, sizeof(packet), 500, MIDI_SOURCE_BLE, rx);
+    CHECK(rx.events.size() == 2);
+    if (rx.events.size() == 2) {
+        CHECK(rx.events[0].timestamp == 500);
+        CHECK(rx.events[1].timestamp == 500 + 3000);
+    }
+
+    // En-tête à 63 (bits hauts) et retour des bits bas : l'horodatage 13 bits repasse par 0
+    rx.events.clear();
+    const uint8_t wrap[] = { 0xBF, 0xFF, 0xF8, 0x80, 0xF8 };
+    decoder.decode(wrap, sizeof(wrap), 0, MIDI_SOURCE_BLE, rx);
+    CHECK(rx.events.size() == 2 && rx.events[1].timestamp == 1000);
+    CHECK(decoder.getMalformedCount() == 0);
+}
+
+static void testDecoderSysEx() {
+    BleMidiDecoder decoder;
+    Received rx;
+    // SysEx ouvert dans le premier paquet, horloge intercalée, suite et F7 dans le second
+    const uint8_t first[] = { 0x80, 0x80, 0xF0, 0x7E, 0x00, 0x06, 0x80, 0xF8, 0x01 };
+    const uint8_t second[] = { 0x80, 0x02, 0x03, 0x81, 0xF8, 0x04, 0x81, 0xF7, 0x81, 0x90, 60, 100 };
+    decoder.decode(first, sizeof(first), 0, MIDI_SOURCE_BLE, rx);
+    CHECK(decoder.getSysExCount() == 0);
+    decoder.decode(second, sizeof(second), 0, MIDI_SOURCE_BLE, rx);
+    CHECK(rx.events.size() == 3);
+    if (rx.events.size() == 3) {
+        CHECK(rx.events[0].status == 0xF8);
+        CHECK(rx.events[1].status == 0xF8);
+        CHECK(rx.events[2].status == 0x90 && rx.events[2].data1 == 60);
+    }
+    CHECK(decoder.getSysExCount() == 1);
+    CHECK(decoder.getMalformedCount() == 0);
+
+    // SysEx interrompu par un autre statut : compté malformé, le message suivant passe
+    rx.events.clear();
+    const uint8_t broken[] = { 0x80, 0x80, 0xF0, 0x01, 0x02, 0x80, 0xB0, 7, 64 };
+    decoder.decode(broken, sizeof(broken), 0, MIDI_SOURCE_BLE, rx);
+    CHECK(rx.events.size() == 1 && rx.events[0].status == 0xB0);
+    CHECK(decoder.getSysExCount() == 1);
+    CHECK(decoder.getMalformedCount() == 1);
+}
+
+static void testDecoderMalformed() {
+    BleMidiDecoder decoder;
+    Received rx;
+    // Horodatage final orphelin : le message valide est conservé
+    const uint8_t orphan[] = { 0x80, 0x80, 0xC0, 5, 0x80 };
+    decoder.decode(orphan, sizeof(orphan), 0, MIDI_SOURCE_BLE, rx);
+    CHECK(rx.events.size() == 1 && rx.events[0].status == 0xC0 && rx.events[0].data1 == 5);
+    CHECK(decoder.getMalformedCount() == 1);
+
+    const uint8_t badHeader[] = { 0x40, 0x80, 0x90, 1, 2 };   // Bit haut absent
+    const uint8_t noTimestamp[] = { 0x80, 0x01, 0x02 };        // Donnée juste après l'en-tête
+    const uint8_t truncated[] = { 0x80, 0x80, 0x90, 1 };       // Message coupé en fin de paquet
+    const uint8_t strayEnd[] = { 0x80, 0x80, 0xF7 };           // F7 hors SysEx
+    const uint8_t headerOnly[] = { 0x80 };
+    decoder.decode(badHeader, sizeof(badHeader), 0, MIDI_SOURCE_BLE, rx);
+    decoder.decode(noTimestamp, sizeof(noTimestamp), 0, MIDI_SOURCE_BLE, rx);
+    decoder.decode(truncated, sizeof(truncated), 0, MIDI_SOURCE_BLE, rx);
+    decoder.decode(strayEnd, sizeof(strayEnd), 0, MIDI_SOURCE_BLE, rx);
+    decoder.decode(headerOnly, sizeof(headerOnly), 0, MIDI_SOURCE_BLE, rx);
+    CHECK(rx.events.size() == 1);
+    CHECK(decoder.getMalformedCount() == 6);
+
+    // Système commun (F2) : analysé puis ignoré, pas de running status après lui
+    BleMidiDecoder common;
+    const uint8_t songPosition[] = { 0x80, 0x80, 0xF2, 1, 2, 3 };
+    common.decode(songPosition, sizeof(songPosition), 0, MIDI_SOURCE_BLE, rx);
+    CHECK(rx.events.size() == 1);
+    CHECK(common.getMalformedCount() == 1);
+
+    decoder.resetStats();
+    CHECK(decoder.getMessageCount() == 0 && decoder.getMalformedCount() == 0 && decoder.getSysExCount() == 0);
+}
+
+// Encodeur → décodeur sur un flux aléatoire : mêmes messages, dans l'ordre, sans erreur
+static void testRoundTrip() {
+    srand(1);
+    static const uint8_t types[] = { 0x80, 0x90, 0xA0, 0xB0, 0xC0, 0xD0, 0xE0 };
+    BleMidiEncoder encoder;
+    BleMidiDecoder decoder;
+    Received rx;
+    std::vector<MidiEvent> sent;
+    encoder.setCapacity(100);
+    uint16_t timeMs = 0;
+    for (int i = 0; i < 50000; i++) {
+        MidiEvent event;
+        if (rand() % 10 == 0) {
+            event = MidiEvent::realtime(0xF8);
+        } else {
+            const uint8_t type = types[rand() % 7];
+            const bool single = type == 0xC0 || type == 0xD0;
+            event = MidiEvent::make((uint8_t)(type | (rand() % 2)), (uint8_t)(rand() % 128),
+                                    (uint8_t)(single ? 0 : rand() % 128), 0);
+        }
+        timeMs = (uint16_t)(timeMs + rand() % 3);
+        if (!encoder.add(event, timeMs)) {
+            decoder.decode(encoder.data(), encoder.size(), 0, MIDI_SOURCE_BLE, rx);
+            encoder.reset();
+            CHECK(encoder.add(event, timeMs));
+        }
+        sent.push_back(event);
+    }
+    decoder.decode(encoder.data(), encoder.size(), 0, MIDI_SOURCE_BLE, rx);
+    CHECK(rx.events.size() == sent.size());
+    bool same = rx.events.size() == sent.size();
+    for (size_t i = 0; same && i < sent.size(); i++) {
+        same = sent[i].sameMessage(rx.events[i]);
+    }
+    CHECK(same);
+    CHECK(decoder.getMalformedCount() == 0);
+
+    // Octets aléatoires : aucun accès hors paquet (exécuté sous -fsanitize au besoin)
+    BleMidiDecoder fuzz;
+    for (int i = 0; i < 20000; i++) {
+        uint8_t packet[40];
+        const size_t length = rand() % sizeof(packet);
+        for (size_t k = 0; k < length; k++) {
+            packet[k] = (uint8_t)rand();
+        }
+        fuzz.decode(packet, length, 0, MIDI_SOURCE_BLE, rx);
+    }
+    CHECK(fuzz.getMalformedCount() > 0);
+}
+
+int main() {
+    testEncoderRunningStatus();
+    testEncoderGap();
+    testEncoderCapacity();
+    testDecoderRunningStatus();
+    testDecoderTimestampWrap();
+    testDecoderSysEx();
+    testDecoderMalformed();
+    testRoundTrip();
+    return test_result("test_ble_midi");
+}
@@ -0,0 +1,168 @@
+// OSCWriter / OSCMessageView / OSCBundleView : aller-retour, paquets tronqués ou malformés
+#include "host_test.h"
+#include "osc/OSCCodec.h"
+
+static void testMessageRoundTrip() {
+    uint8_t buf[128];
+    const uint8_t blob[5] = { 1, 2, 3, 4, 5 };
+    OSCWriter w(buf, sizeof(buf));
+    w.address("/mixer/ch1");
+    w.typeTags(",ifsb");
+    w.int32(-42);
+    w.float32(0.25f);
+    w.string("abc");
+    w.blob(blob, sizeof(blob));
+    CHECK(w.ok());
+    CHECK((w.length() & 3) == 0);
+
+    OSCMessageView msg;
+    CHECK(msg.parse(buf, w.length()));
+    CHECK(strcmp(msg.address(), "/mixer/ch1") == 0);
+    CHECK(strcmp(msg.typeTags(), "ifsb") == 0);
+    CHECK(msg.size() == 4);
+
+    OSCArgument arg;
+    CHECK(msg.next(arg) && arg.type == 'i' && arg.asInt32() == -42);
+    CHECK(msg.next(arg) && arg.type == 'f' && arg.asFloat() == 0.25f);
+    CHECK(msg.next(arg) && arg.asString() && strcmp(arg.asString(), "abc") == 0 && arg.size == 3);
+    CHECK(msg.next(arg) && arg.type == 'b' && arg.size == 5 && memcmp(arg.data, blob, 5) == 0);
+    CHECK(!msg.next(arg));
+
+    CHECK(msg.argument(1, arg) && arg.asFloat() == 0.25f);
+
+    // Tampon trop petit : ok() passe à false, length() reste au dernier octet valide
+    uint8_t small[16];
+    OSCWriter tiny(small, sizeof(small));
+    tiny.address("/abc");
+    const size_t valid = tiny.length();
+    CHECK(!tiny.typeTags(",iiiiiiiiiiiiiii"));
+    CHECK(!tiny.ok() && tiny.length() == valid);
+}
+
+static void testBundleRoundTrip() {
+    uint8_t buf[128];
+    OSCWriter w(buf, sizeof(buf));
+    CHECK(w.beginBundle(OSC_TIMETAG_IMMEDIATE));
+    for (int i = 0; i < 3; i++) {
+        const size_t mark = w.beginElement();
+        w.address("/a");
+        w.typeTags(",i");
+        w.int32(i);
+        w.endElement(mark);
+    }
+    CHECK(w.ok());
+
+    OSCBundleView bundle;
+    CHECK(bundle.parse(buf, w.length()));
+    CHECK(bundle.timetag() == OSC_TIMETAG_IMMEDIATE);
+    const uint8_t* element;
+    size_t length;
+    int count = 0;
+    while (bundle.next(element, length)) {
+        OSCMessageView msg;
+        OSCArgument arg;
+        CHECK(msg.parse(element, length));
+        CHECK(msg.next(arg) && arg.asInt32() == count);
+        count++;
+    }
+    CHECK(count == 3);
+
+    // Élément annonçant plus d'octets que le bundle n'en contient
+    OSCWriter::putBE32(buf + 16, 0xFFFFFFF0u);
+    CHECK(bundle.parse(buf, w.length()));
+    CHECK(!bundle.next(element, length));
+}
+
+static size_t blobMessage(uint8_t* buf, size_t cap, uint32_t announced) {
+    OSCWriter w(buf, cap);
+    w.address("/b");
+    w.typeTags(",b");
+    w.uint32(announced);
+    w.uint32(0xDEADBEEF);
+    return w.length();
+}
+
+static void testMalformed() {
+    uint8_t buf[64];
+    OSCMessageView msg;
+    OSCArgument arg;
+
+    // Blob de taille proche de UINT32_MAX : l'arrondi à 4 déborderait
+    const uint32_t sizes[] = { 0xFFFFFFFFu, 0xFFFFFFFDu, 0xFFFFFFFCu, 0x80000000u, 5u, 8u };
+    for (uint32_t size : sizes) {
+        const size_t len = blobMessage(buf, sizeof(buf), size);
+        CHECK(msg.parse(buf, len));
+        CHECK(!msg.next(arg));
+    }
+    // Blob exactement contenu dans le paquet
+    const size_t len = blobMessage(buf, sizeof(buf), 4);
+    CHECK(msg.parse(buf, len));
+    CHECK(msg.next(arg) && arg.size == 4 && arg.data + 4 <= buf + len);
+
+    // Arguments tronqués
+    OSCWriter w(buf, sizeof(buf));
+    w.address("/t");
+    w.typeTags(",ii");
+    w.int32(1);
+    CHECK(msg.parse(buf, w.length()));
+    CHECK(msg.next(arg));
+    CHECK(!msg.next(arg));
+
+    // Chaîne sans '\0' final, type inconnu, adresse invalide, longueur non alignée
+    OSCWriter s(buf, sizeof(buf));
+    s.address("/s");
+    s.typeTags(",s");
+    s.bytes("abcd", 4);
+    CHECK(msg.parse(buf, s.length()));
+    CHECK(!msg.next(arg));
+
+    OSCWriter u(buf, sizeof(buf));
+    u.address("/u");
+    u.typeTags(",x");
+    u.int32(0);
+    CHECK(msg.parse(buf, u.length()));
+    CHECK(!msg.next(arg));
+
+    const uint8_t noSlash[8] = { 'a', 'b', 0, 0, ',', 0, 0, 0 };
+    CHECK(!msg.parse(noSlash, sizeof(noSlash)));
+    CHECK(!msg.parse(buf, 6));
+    const uint8_t unterminated[4] = { '/', 'a', 'b', 'c' };
+    CHECK(!msg.parse(unterminated, sizeof(unterminated)));
+}
+
+// Débit de l'encodage/décodage d'un message de composant (/adresse ,f)
+static void bench() {
+    const int N = 2000000;
+    uint8_t buf[64];
+    size_t len = 0;
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < N; i++) {
+        OSCWriter w(buf, sizeof(buf));
+        w.address("/esp32/pot/1");
+        w.typeTags(",f");
+        w.float32((float)i);
+        len = w.length();
+    }
+    const uint64_t encodeNs = bench_now_ns() - start;
+
+    volatile float sink = 0;
+    start = bench_now_ns();
+    for (int i = 0; i < N; i++) {
+        OSCMessageView msg;
+        OSCArgument arg;
+        if (msg.parse(buf, len) && msg.next(arg)) {
+            sink = sink + arg.asFloat();
+        }
+    }
+    const uint64_t decodeNs = bench_now_ns() - start;
+    printf("encodage %.1f ns/message, décodage %.1f ns/message (%zu octets, aucune allocation)\n",
+           encodeNs / (double)N, decodeNs / (double)N, len);
+}
+
+int main() {
+    testMessageRoundTrip();
+    testBundleRoundTrip();
+    testMalformed();
+    bench();
+    return test_result("test_osc_codec");
+}
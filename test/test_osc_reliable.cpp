@@ -0,0 +1,73 @@
+// OSCReliableWindow : délai de retransmission doublé par case, plafonné, échéance inchangée
+#include "host_test.h"
+#include "osc/OSCReliable.h"
+
+static OSCReliableWindow::Slot* openEvent(OSCReliableWindow& window, uint32_t now) {
+    const uint8_t message[8] = { '/', 'b', 0, 0, ',', 0, 0, 0 };
+    bool evicted = false;
+    return window.open(message, sizeof(message), 0x01, now, evicted);
+}
+
+// Retransmissions faute d'accusé, comme OSCQueue::serviceReliable() (pas de 1 ms)
+static uint32_t countRetransmits(OSCReliableWindow& window, uint32_t deadlineUs) {
+    window.clear();
+    window.setDeadline(deadlineUs);
+    OSCReliableWindow::Slot* slot = openEvent(window, 0);
+    CHECK(slot != nullptr);
+    uint32_t retransmits = 0;
+    for (uint32_t now = 0; slot->used; now += 1000) {
+        if (window.expired(*slot, now)) {
+            slot->used = false;
+        } else if (window.due(*slot, now)) {
+            slot->retries++;
+            slot->lastSent = now;
+            retransmits++;
+        }
+    }
+    return retransmits;
+}
+
+static void testBackoff() {
+    OSCReliableWindow window;
+    // RTT initial 20 ms : RTO de base 40 ms, puis 80, 160... jusqu'à MAX_RTO_US
+    CHECK(window.rto() == 40000);
+    CHECK(window.rto(0) == 40000);
+    CHECK(window.rto(1) == 80000);
+    CHECK(window.rto(3) == 320000);
+    CHECK(window.rto(5) == OSCReliableWindow::MAX_RTO_US);
+    CHECK(window.rto(200) == OSCReliableWindow::MAX_RTO_US);
+
+    // Échéance courte : RTO de base borné à la moitié de l'échéance, le plafond le suit
+    window.setDeadline(20000);
+    CHECK(window.rto() == OSCReliableWindow::MIN_RTO_US);
+    window.setDeadline(4000000);
+    CHECK(window.rto(6) == OSCReliableWindow::MAX_RTO_US);
+
+    // Récepteur qui n'accuse jamais : 40 + 80 ms avant 250 ms (au lieu de 6 copies),
+    // 40..640 ms puis une par seconde jusqu'à 5 s : 8 (au lieu de ~125)
+    CHECK(countRetransmits(window, 250000) == 2);
+    CHECK(countRetransmits(window, 5000000) == 8);
+}
+
+static void testAckKeepsRtt() {
+    OSCReliableWindow window;
+    OSCReliableWindow::Slot* slot = openEvent(window, 0);
+    CHECK(slot != nullptr);
+    const uint32_t seq = slot->seq;
+    // Accusé d'une case retransmise : ignoré pour le RTT (Karn)
+    slot->retries = 1;
+    CHECK(window.ack(seq, 100000));
+    CHECK(window.getSmoothedRtt() == OSCReliableWindow::INITIAL_RTT_US);
+    CHECK(!window.ack(seq, 100000));
+
+    slot = openEvent(window, 0);
+    CHECK(window.ack(slot->seq, 4000));
+    CHECK(window.getSmoothedRtt() == 20000 - 20000 / 8 + 4000 / 8);
+    CHECK(window.pending() == 0);
+}
+
+int main() {
+    testBackoff();
+    testAckKeepsRtt();
+    return test_result("test_osc_reliable");
+}
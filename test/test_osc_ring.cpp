@@ -0,0 +1,161 @@
+// OSCRing : enveloppe des indices 16 bits, politique drop-oldest, débit à deux threads
+#include "host_test.h"
+#include "osc/OSCRing.h"
+#include <thread>
+#include <atomic>
+
+struct Record {
+    uint32_t seq;
+    uint32_t check; // ~seq : détecte une lecture déchirée
+};
+
+static Record make(uint32_t seq) {
+    Record r = { seq, ~seq };
+    return r;
+}
+
+static void testSingleThread() {
+    OSCRing<Record, 8> ring;
+    Record r;
+    CHECK(ring.empty());
+    CHECK(!ring.pop(r));
+
+    // Pleine : push refusé, rien d'écrit
+    for (uint32_t i = 0; i < 8; i++) {
+        CHECK(ring.push(make(i)));
+    }
+    CHECK(ring.full());
+    CHECK(!ring.push(make(99)));
+    CHECK(ring.pop(r) && r.seq == 0);
+
+    // Drop-oldest : l'élément le plus ancien (1) est écarté
+    CHECK(ring.pushOverwrite(make(8)));   // Une case libre : rien d'écarté
+    CHECK(!ring.pushOverwrite(make(9)));  // Pleine : 1 écarté
+    CHECK(ring.size() == 8);
+    for (uint32_t expected = 2; expected <= 9; expected++) {
+        CHECK(ring.pop(r) && r.seq == expected);
+    }
+    CHECK(ring.empty());
+
+    // Enveloppe des indices 16 bits (plus de 65536 passages)
+    OSCRing<Record, 4> small;
+    uint32_t next = 0;
+    uint32_t expected = 0;
+    for (uint32_t round = 0; round < 70000; round++) {
+        CHECK(small.push(make(next++)));
+        if (round % 3 == 0) {
+            CHECK(small.push(make(next++)));
+        }
+        while (small.size() > 2) {
+            CHECK(small.pop(r) && r.seq == expected);
+            expected++;
+        }
+        if (g_testFailures > 0) {
+            break;
+        }
+    }
+    while (small.pop(r)) {
+        CHECK(r.seq == expected);
+        expected++;
+    }
+    CHECK(expected == next);
+
+    small.push(make(1));
+    small.clear();
+    CHECK(small.empty());
+}
+
+// Producteur push() / consommateur pop() : ordre et exhaustivité, débit
+static void testTwoThreads() {
+    static OSCRing<Record, 256> ring;
+    const uint32_t COUNT = 2000000;
+    std::atomic<bool> ok(true);
+
+    const uint64_t start = bench_now_ns();
+    std::thread consumer([&]() {
+        Record r;
+        uint32_t expected = 0;
+        while (expected < COUNT) {
+            if (ring.pop(r)) {
+                if (r.seq != expected || r.check != ~r.seq) {
+                    ok = false;
+                }
+                expected++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (uint32_t i = 0; i < COUNT; i++) {
+        while (!ring.push(make(i))) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    const uint64_t elapsed = bench_now_ns() - start;
+
+    CHECK(ok);
+    CHECK(ring.empty());
+    printf("push/pop : %u éléments en %.1f ms (%.1f M/s)\n", COUNT, elapsed / 1e6,
+           COUNT * 1e3 / (double)elapsed);
+}
+
+// pushOverwrite() en concurrence avec pop() : chaque élément est soit lu
+// une seule fois, dans l'ordre, soit écarté ; jamais déchiré ni dupliqué
+static void testOverwriteRace() {
+    static OSCRing<Record, 16> ring;
+    const uint32_t COUNT = 1000000;
+    std::atomic<bool> done(false);
+    std::atomic<bool> ok(true);
+    std::atomic<uint32_t> popped(0);
+    uint32_t evicted = 0;
+
+    std::thread consumer([&]() {
+        Record r;
+        int64_t last = -1;
+        uint32_t count = 0;
+        for (;;) {
+            if (ring.pop(r)) {
+                if (r.check != ~r.seq || (int64_t)r.seq <= last) {
+                    ok = false;
+                }
+                last = r.seq;
+                count++;
+            } else if (done.load()) {
+                if (!ring.pop(r)) {
+                    break;
+                }
+                if (r.check != ~r.seq || (int64_t)r.seq <= last) {
+                    ok = false;
+                }
+                last = r.seq;
+                count++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        popped = count;
+    });
+    for (uint32_t i = 0; i < COUNT; i++) {
+        if (!ring.pushOverwrite(make(i))) {
+            evicted++;
+        }
+        // Mono-cœur : céder régulièrement pour entrelacer les deux threads
+        if ((i & 31) == 0) {
+            std::this_thread::yield();
+        }
+    }
+    done = true;
+    consumer.join();
+
+    CHECK(ok);
+    CHECK(popped + evicted == COUNT);
+    printf("pushOverwrite/pop : %u lus, %u écartés\n", popped.load(), evicted);
+}
+
+int main() {
+    testSingleThread();
+    testTwoThreads();
+    testOverwriteRace();
+    return test_result("test_osc_ring");
+}
@@ -0,0 +1,160 @@
+// oscSlipEncode / OSCSlipDecoder : aller-retour avec octets END/ESC, trames découpées entre lectures
+#include "host_test.h"
+#include "osc/OSCSlip.h"
+
+// Décode un flux par lectures de chunk octets (comme receiveSerial() sur available())
+// et vérifie que chaque trame ressort intacte, dans l'ordre
+static size_t decodeStream(OSCSlipDecoder& decoder, const uint8_t* stream, size_t length, size_t chunk,
+                           const uint8_t* const* expected, const size_t* expectedSizes, size_t expectedCount) {
+    size_t frames = 0;
+    for (size_t pos = 0; pos < length; pos += chunk) {
+        const size_t end = pos + chunk < length ? pos + chunk : length;
+        for (size_t i = pos; i < end; i++) {
+            if (decoder.feed(stream[i])) {
+                CHECK(frames < expectedCount);
+                if (frames < expectedCount) {
+                    CHECK(decoder.size() == expectedSizes[frames]);
+                    CHECK(memcmp(decoder.data(), expected[frames], expectedSizes[frames]) == 0);
+                }
+                frames++;
+            }
+        }
+    }
+    return frames;
+}
+
+static void testSpecialBytes() {
+    // Message OSC dont le blob contient END, ESC et les séquences ESC_END/ESC_ESC en clair
+    uint8_t packet[64];
+    const uint8_t blob[8] = { OSC_SLIP_END, OSC_SLIP_ESC, OSC_SLIP_ESC_END, OSC_SLIP_ESC_ESC,
+                              OSC_SLIP_ESC, OSC_SLIP_END, OSC_SLIP_END, 0x00 };
+    OSCWriter w(packet, sizeof(packet));
+    w.address("/slip");
+    w.typeTags(",b");
+    w.blob(blob, sizeof(blob));
+    CHECK(w.ok());
+
+    uint8_t frame[OSC_SLIP_MAX_ENCODED];
+    const size_t size = oscSlipEncode(packet, w.length(), frame, sizeof(frame));
+    // END d'ouverture et de fermeture, 5 octets END/ESC échappés (ESC_END/ESC_ESC seuls restent littéraux)
+    CHECK(size == w.length() + 2 + 5);
+    CHECK(frame[0] == OSC_SLIP_END && frame[size - 1] == OSC_SLIP_END);
+    for (size_t i = 1; i < size - 1; i++) {
+        CHECK(frame[i] != OSC_SLIP_END);
+    }
+
+    OSCSlipDecoder decoder;
+    const uint8_t* expected[1] = { packet };
+    const size_t sizes[1] = { w.length() };
+    CHECK(decodeStream(decoder, frame, size, size, expected, sizes, 1) == 1);
+
+    // Le paquet décodé reste un message OSC valide
+    OSCMessageView msg;
+    OSCArgument arg;
+    CHECK(msg.parse(decoder.data(), decoder.size()));
+    CHECK(msg.next(arg) && arg.type == 'b' && arg.size == sizeof(blob) && memcmp(arg.data, blob, sizeof(blob)) == 0);
+
+    // Tampon de sortie trop petit : 0, y compris quand seul l'échappement déborde
+    CHECK(oscSlipEncode(packet, w.length(), frame, w.length() + 1) == 0);
+    CHECK(oscSlipEncode(packet, w.length(), frame, size - 1) == 0);
+}
+
+static void testSplitReads() {
+    // Trois trames consécutives, dont une faite uniquement d'octets spéciaux
+    uint8_t a[32], b[32], c[16];
+    for (size_t i = 0; i < sizeof(a); i++) a[i] = (uint8_t)(0xC0 + i);
+    for (size_t i = 0; i < sizeof(b); i++) b[i] = (uint8_t)(i * 37);
+    for (size_t i = 0; i < sizeof(c); i++) c[i] = (i & 1) ? OSC_SLIP_ESC : OSC_SLIP_END;
+
+    uint8_t stream[3 * (2 * 32 + 2) + 8];
+    size_t length = 0;
+    // Octets parasites avant la première trame (log sur le même port) : terminés par l'END
+    // d'ouverture, ils sortent comme une trame que le parseur OSC rejette
+    const uint8_t noise[3] = { 'l', 'o', 'g' };
+    memcpy(stream, noise, sizeof(noise));
+    length += sizeof(noise);
+    length += oscSlipEncode(a, sizeof(a), stream + length, sizeof(stream) - length);
+    length += oscSlipEncode(b, sizeof(b), stream + length, sizeof(stream) - length);
+    length += oscSlipEncode(c, sizeof(c), stream + length, sizeof(stream) - length);
+
+    const uint8_t* expected[4] = { noise, a, b, c };
+    const size_t sizes[4] = { sizeof(noise), sizeof(a), sizeof(b), sizeof(c) };
+    // Toutes les tailles de lecture, y compris une coupure entre ESC et ESC_END/ESC_ESC
+    for (size_t chunk = 1; chunk <= length; chunk++) {
+        OSCSlipDecoder decoder;
+        CHECK(decodeStream(decoder, stream, length, chunk, expected, sizes, 4) == 4);
+        CHECK(decoder.getDroppedFrames() == 0);
+    }
+}
+
+static void testOversize() {
+    // Trame plus grande que OSC_MAX_PACKET_SIZE : écartée et comptée, la suivante passe
+    static uint8_t big[OSC_MAX_PACKET_SIZE + 1];
+    static uint8_t stream[2 * OSC_SLIP_MAX_ENCODED + 64];
+    memset(big, 0x55, sizeof(big));
+    size_t length = 0;
+    stream[length++] = OSC_SLIP_END;
+    memcpy(stream + length, big, sizeof(big));
+    length += sizeof(big);
+    stream[length++] = OSC_SLIP_END;
+    const uint8_t small[4] = { 1, OSC_SLIP_END, 2, OSC_SLIP_ESC };
+    length += oscSlipEncode(small, sizeof(small), stream + length, sizeof(stream) - length);
+
+    OSCSlipDecoder decoder;
+    const uint8_t* expected[1] = { small };
+    const size_t sizes[1] = { sizeof(small) };
+    CHECK(decodeStream(decoder, stream, length, 64, expected, sizes, 1) == 1);
+    CHECK(decoder.getDroppedFrames() == 1);
+}
+
+// Débit de la mise en trame : paquet de composant typique et paquet plein d'octets spéciaux
+static void benchFraming(const char* name, const uint8_t* packet, size_t length, int iterations) {
+    static uint8_t frame[OSC_SLIP_MAX_ENCODED];
+    size_t size = 0;
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < iterations; i++) {
+        size = oscSlipEncode(packet, length, frame, sizeof(frame));
+    }
+    const uint64_t encodeNs = bench_now_ns() - start;
+
+    OSCSlipDecoder decoder;
+    size_t frames = 0;
+    start = bench_now_ns();
+    for (int i = 0; i < iterations; i++) {
+        for (size_t b = 0; b < size; b++) {
+            frames += decoder.feed(frame[b]);
+        }
+    }
+    const uint64_t decodeNs = bench_now_ns() - start;
+    CHECK(frames == (size_t)iterations);
+
+    const double payload = (double)length * iterations;
+    printf("%s (%zu -> %zu octets) : encodage %.1f ns/trame (%.0f Mo/s), décodage %.1f ns/trame (%.0f Mo/s)\n",
+           name, length, size, encodeNs / (double)iterations, payload * 1000.0 / encodeNs,
+           decodeNs / (double)iterations, payload * 1000.0 / decodeNs);
+}
+
+static void bench() {
+    uint8_t component[64];
+    OSCWriter w(component, sizeof(component));
+    w.address("/esp32/pot/1");
+    w.typeTags(",f");
+    w.float32(0.5f);
+    benchFraming("message de composant", component, w.length(), 2000000);
+
+    static uint8_t mixed[OSC_MAX_PACKET_SIZE];
+    for (size_t i = 0; i < sizeof(mixed); i++) {
+        mixed[i] = (i % 16 == 0) ? OSC_SLIP_END : (uint8_t)i;
+    }
+    benchFraming("datagramme plein, 1/16 échappé", mixed, sizeof(mixed), 20000);
+
+    // Débit de l'UART à 115200 bauds : ~11,5 ko/s, la mise en trame n'est pas le goulot
+}
+
+int main() {
+    testSpecialBytes();
+    testSplitReads();
+    testOversize();
+    bench();
+    return test_result("test_osc_slip");
+}
@@ -0,0 +1,146 @@
+// RtpMidiBatch : delta times, running status, événements restants quand la liste est pleine
+#include "host_test.h"
+#include "midi/RtpMidiBatch.h"
+
+static MidiEvent at(MidiEvent event, uint32_t timestamp) {
+    event.timestamp = timestamp;
+    return event;
+}
+
+static bool listEquals(const uint8_t* list, size_t length, const uint8_t* expected, size_t expectedLength) {
+    return length == expectedLength && memcmp(list, expected, length) == 0;
+}
+
+static void testEncodeDelta() {
+    uint8_t out[4];
+    CHECK(RtpMidiBatch::encodeDelta(0, out) == 1 && out[0] == 0x00);
+    CHECK(RtpMidiBatch::encodeDelta(127, out) == 1 && out[0] == 0x7F);
+    CHECK(RtpMidiBatch::encodeDelta(128, out) == 2 && out[0] == 0x81 && out[1] == 0x00);
+    CHECK(RtpMidiBatch::encodeDelta(0x3FFF, out) == 2 && out[0] == 0xFF && out[1] == 0x7F);
+    CHECK(RtpMidiBatch::encodeDelta(0x4000, out) == 3 && out[0] == 0x81 && out[1] == 0x80 && out[2] == 0x00);
+    const uint8_t max[4] = { 0xFF, 0xFF, 0xFF, 0x7F };
+    CHECK(RtpMidiBatch::encodeDelta(0x0FFFFFFF, out) == 4 && memcmp(out, max, 4) == 0);
+    // Au-delà de 28 bits : saturé
+    CHECK(RtpMidiBatch::encodeDelta(0xFFFFFFFF, out) == 4 && memcmp(out, max, 4) == 0);
+}
+
+static void testDeltaAndRunningStatus() {
+    RtpMidiBatch batch;
+    uint8_t list[RTP_MIDI_BATCH_BYTES];
+    uint16_t commands = 0;
+
+    // 100 µs = 1 tick à 10 kHz ; 20 ms = 200 ticks (2 octets)
+    CHECK(batch.add(at(MidiEvent::noteOn(1, 60, 100), 1000)));
+    CHECK(batch.add(at(MidiEvent::noteOn(1, 61, 100), 1100)));
+    CHECK(batch.add(at(MidiEvent::controlChange(1, 7, 127), 21100)));
+    CHECK(batch.add(at(MidiEvent::programChange(2, 5), 21100)));
+    const uint8_t expected[] = {
+        0x90, 60, 100,           // Première commande : pas de delta, statut complet
+        0x01, 61, 100,           // Delta 1 tick, statut omis (running status)
+        0x81, 0x48, 0xB0, 7, 127, // Delta 200 ticks, nouveau statut
+        0x00, 0xC1, 5            // Program change : un seul octet de données
+    };
+    size_t length = batch.take(list, sizeof(list), commands);
+    CHECK(commands == 4);
+    CHECK(listEquals(list, length, expected, sizeof(expected)));
+    CHECK(batch.empty());
+
+    // Temps réel : ne rompt pas le running status ; horodatage antérieur : delta 0
+    batch.add(at(MidiEvent::noteOn(1, 60, 100), 5000));
+    batch.add(at(MidiEvent::realtime(0xF8), 5000));
+    batch.add(at(MidiEvent::noteOn(1, 62, 90), 4000));
+    const uint8_t realtime[] = { 0x90, 60, 100, 0x00, 0xF8, 0x00, 62, 90 };
+    length = batch.take(list, sizeof(list), commands);
+    CHECK(commands == 3);
+    CHECK(listEquals(list, length, realtime, sizeof(realtime)));
+
+    // Écarts de 150 µs : deltas comptés depuis l'instant encodé (1, 2, 1 ticks), sans dérive
+    batch.add(at(MidiEvent::controlChange(1, 1, 1), 0));
+    batch.add(at(MidiEvent::controlChange(1, 1, 2), 150));
+    batch.add(at(MidiEvent::controlChange(1, 1, 3), 300));
+    batch.add(at(MidiEvent::controlChange(1, 1, 4), 450));
+    const uint8_t spaced[] = { 0xB0, 1, 1, 0x01, 1, 2, 0x02, 1, 3, 0x01, 1, 4 };
+    length = batch.take(list, sizeof(list), commands);
+    CHECK(listEquals(list, length, spaced, sizeof(spaced)));
+
+    // Horloge seule en tête : la première commande canal porte toujours son statut
+    batch.add(at(MidiEvent::realtime(0xF8), 0));
+    batch.add(at(MidiEvent::controlChange(16, 1, 64), 0));
+    const uint8_t leading[] = { 0xF8, 0x00, 0xBF, 1, 64 };
+    length = batch.take(list, sizeof(list), commands);
+    CHECK(listEquals(list, length, leading, sizeof(leading)));
+}
+
+static void testLeftover() {
+    RtpMidiBatch batch;
+    uint8_t list[RTP_MIDI_BATCH_BYTES];
+    uint16_t commands = 0;
+    batch.add(at(MidiEvent::noteOn(1, 60, 100), 0));
+    batch.add(at(MidiEvent::noteOn(1, 61, 100), 0));
+    batch.add(at(MidiEvent::noteOn(1, 62, 100), 300));
+
+    // Tampon trop petit pour une commande : rien n'est retiré
+    CHECK(batch.take(list, 2, commands) == 0 && commands == 0);
+    CHECK(batch.size() == 3);
+
+    // 7 octets : deux commandes (6 octets), la troisième attend la liste suivante
+    size_t length = batch.take(list, 7, commands);
+    const uint8_t first[] = { 0x90, 60, 100, 0x00, 61, 100 };
+    CHECK(commands == 2);
+    CHECK(listEquals(list, length, first, sizeof(first)));
+    CHECK(batch.size() == 1);
+
+    // Nouvelle liste : sans delta, statut répété (le running status ne traverse pas les paquets)
+    length = batch.take(list, sizeof(list), commands);
+    const uint8_t second[] = { 0x90, 62, 100 };
+    CHECK(commands == 1);
+    CHECK(listEquals(list, length, second, sizeof(second)));
+    CHECK(batch.empty());
+
+    // Liste pleine en un cycle : 60 octets tiennent 20 commandes de 3 octets, le reste suit
+    for (int i = 0; i < 30; i++) {
+        batch.add(at(MidiEvent::controlChange(1 + (i & 1), (uint8_t)i, 64), 0));
+    }
+    uint16_t total = 0;
+    int lists = 0;
+    while (!batch.empty()) {
+        length = batch.take(list, sizeof(list), commands);
+        CHECK(length <= sizeof(list) && commands > 0);
+        total += commands;
+        lists++;
+    }
+    CHECK(total == 30 && lists == 2);
+
+    // File pleine : l'événement est écarté et compté
+    for (int i = 0; i < RTP_MIDI_BATCH_EVENTS; i++) {
+        CHECK(batch.add(at(MidiEvent::noteOn(1, 60, 1), 0)));
+    }
+    CHECK(!batch.add(at(MidiEvent::noteOn(1, 60, 1), 0)));
+    CHECK(batch.getOverflowCount() == 1);
+    batch.clear();
+    CHECK(batch.empty() && batch.getOverflowCount() == 1);
+}
+
+static void testReady() {
+    RtpMidiBatch batch;
+    CHECK(!batch.ready(0, 0));
+    batch.add(at(MidiEvent::noteOn(1, 60, 100), 1000));
+    CHECK(batch.ready(1000, 0));           // Fenêtre nulle : à chaque cycle
+    CHECK(!batch.ready(1999, 1000));
+    CHECK(batch.ready(2000, 1000));
+    CHECK(batch.ready(500, 1000));         // Événement daté après now : émis sans attendre
+
+    // Une liste pleine n'attend pas la fin de la fenêtre
+    for (int i = 1; i < RTP_MIDI_BATCH_BYTES / 3; i++) {
+        batch.add(at(MidiEvent::noteOn(1, 60, 100), 1000));
+    }
+    CHECK(batch.ready(1000, 1000));
+}
+
+int main() {
+    testEncodeDelta();
+    testDeltaAndRunningStatus();
+    testLeftover();
+    testReady();
+    return test_result("test_rtp_batch");
+}